@@ -0,0 +1,363 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: AudioEngine.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the audio engine, including the .wav decoder and the mixer thread
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "AudioEngine.h"
+// Includes
+#include <stdio.h>
+#include <string.h>
+
+AudioEngine::~AudioEngine()
+{
+	Shutdown();
+}
+
+void AudioEngine::Initialise(AudioSink* outputSink)
+{
+	sink = outputSink;
+
+	// If the sink cant be opened then the sound is thrown away instead, the game carries on either way
+	if (!sink->Open(SAMPLE_RATE))
+	{
+		delete sink;
+		sink = new NullAudioSink();
+		sink->Open(SAMPLE_RATE);
+	}
+
+	running.store(true);
+	mixer = std::thread(&AudioEngine::MixerLoop, this);
+}
+
+void AudioEngine::Shutdown()
+{
+	if (mixer.joinable())
+	{
+		running.store(false);
+		mixer.join();
+	}
+	if (sink)
+	{
+		sink->Close();
+		delete sink;
+		sink = nullptr;
+	}
+}
+
+int AudioEngine::LoadSound(const char* fileName)
+{
+	int sound = soundCount.load(std::memory_order_relaxed);
+	if (sound == MAX_SOUNDS || !DecodeWav(fileName, sounds[sound]))
+	{
+		return INVALID_AUDIO_ID;
+	}
+
+	// Release makes sure the samples are all there before the mixer can see the sound
+	soundCount.store(sound + 1, std::memory_order_release);
+	return sound;
+}
+
+int AudioEngine::Play(int sound, bool loop, float gain)
+{
+	if (sound == INVALID_AUDIO_ID)
+	{
+		return INVALID_AUDIO_ID;
+	}
+
+	AudioCommand command;
+	command.type = COMMAND_PLAY;
+	command.voice = nextVoiceId++;
+	command.sound = sound;
+	command.gain = gain;
+	command.loop = loop;
+	SendCommand(command);
+	return command.voice;
+}
+
+void AudioEngine::Stop(int voice)
+{
+	if (voice == INVALID_AUDIO_ID)
+	{
+		return;
+	}
+
+	AudioCommand command;
+	command.type = COMMAND_STOP;
+	command.voice = voice;
+	SendCommand(command);
+}
+
+void AudioEngine::SetGain(int voice, float gain)
+{
+	if (voice == INVALID_AUDIO_ID)
+	{
+		return;
+	}
+
+	AudioCommand command;
+	command.type = COMMAND_SET_GAIN;
+	command.voice = voice;
+	command.gain = gain;
+	SendCommand(command);
+}
+
+void AudioEngine::StopAll()
+{
+	AudioCommand command;
+	command.type = COMMAND_STOP_ALL;
+	SendCommand(command);
+}
+
+/// <summary>
+/// Puts a command in the queue for the mixer, this never waits so if the queue is full the command is dropped
+/// </summary>
+void AudioEngine::SendCommand(const AudioCommand& command)
+{
+	if (!commands.Push(command))
+	{
+		droppedCommands++;
+	}
+}
+
+/// <summary>
+/// This runs on the mixer thread, each time round it picks up any new commands, mixes a block and hands it to the sink.
+/// The sink waits until it is ready for more, which is what stops this from running faster than the sound plays.
+/// </summary>
+void AudioEngine::MixerLoop()
+{
+	while (running.load(std::memory_order_relaxed))
+	{
+		AudioCommand command;
+		while (commands.Pop(command))
+		{
+			RunCommand(command);
+		}
+
+		MixBlock(outputBuffer);
+		sink->Write(outputBuffer, BLOCK_SIZE);
+		mixedSamples.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+	}
+}
+
+void AudioEngine::RunCommand(const AudioCommand& command)
+{
+	switch (command.type)
+	{
+		case COMMAND_PLAY:
+		{
+			// Use a free voice, if they are all busy then take over the one that was started first
+			Voice* voice = &voices[0];
+			for (int i = 0; i < MAX_VOICES; i++)
+			{
+				if (voices[i].id == INVALID_AUDIO_ID)
+				{
+					voice = &voices[i];
+					break;
+				}
+				if (voices[i].id < voice->id)
+				{
+					voice = &voices[i];
+				}
+			}
+			voice->id = command.voice;
+			voice->sound = command.sound;
+			voice->position = 0;
+			voice->gain = command.gain;
+			voice->loop = command.loop;
+			break;
+		}
+		case COMMAND_STOP:
+		case COMMAND_SET_GAIN:
+		{
+			for (int i = 0; i < MAX_VOICES; i++)
+			{
+				if (voices[i].id == command.voice)
+				{
+					if (command.type == COMMAND_STOP)
+					{
+						voices[i].id = INVALID_AUDIO_ID;
+					}
+					else
+					{
+						voices[i].gain = command.gain;
+					}
+					break;
+				}
+			}
+			break;
+		}
+		case COMMAND_STOP_ALL:
+		{
+			for (int i = 0; i < MAX_VOICES; i++)
+			{
+				voices[i].id = INVALID_AUDIO_ID;
+			}
+			break;
+		}
+	}
+}
+
+/// <summary>
+/// Adds up every voice that is playing in to one block of samples
+/// </summary>
+/// <param name="output"> Where the mixed samples are written, BLOCK_SIZE of them </param>
+void AudioEngine::MixBlock(short* output)
+{
+	memset(mixBuffer, 0, sizeof(mixBuffer));
+
+	int loadedSounds = soundCount.load(std::memory_order_acquire);
+	for (int i = 0; i < MAX_VOICES; i++)
+	{
+		Voice& voice = voices[i];
+		if (voice.id == INVALID_AUDIO_ID || voice.sound >= loadedSounds)
+		{
+			continue;
+		}
+
+		const std::vector<float>& samples = sounds[voice.sound];
+		const int length = (int)samples.size();
+		int written = 0;
+		while (written < BLOCK_SIZE)
+		{
+			if (voice.position >= length)
+			{
+				if (!voice.loop || length == 0)
+				{
+					voice.id = INVALID_AUDIO_ID;
+					break;
+				}
+				voice.position = 0;
+			}
+
+			// Copy as much as we can before either the block is full or the sound runs out
+			int count = length - voice.position < BLOCK_SIZE - written ? length - voice.position : BLOCK_SIZE - written;
+			const float* source = samples.data() + voice.position;
+			for (int j = 0; j < count; j++)
+			{
+				mixBuffer[written + j] += source[j] * voice.gain;
+			}
+			written += count;
+			voice.position += count;
+		}
+	}
+
+	// Turn the mix back in to 16 bit samples, anything too loud is clipped
+	for (int i = 0; i < BLOCK_SIZE; i++)
+	{
+		float sample = mixBuffer[i];
+		sample = sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+		output[i] = (short)(sample * 32767.0f);
+	}
+}
+
+/// <summary>
+/// Reads a .wav file and converts it to mono floats at the engine sample rate
+/// </summary>
+/// <param name="fileName"> The file to read </param>
+/// <param name="samples"> Filled in with the decoded sound </param>
+/// <returns> False if the file couldnt be read or is a format that isnt supported </returns>
+bool AudioEngine::DecodeWav(const char* fileName, std::vector<float>& samples)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		return false;
+	}
+	std::vector<unsigned char> bytes;
+	unsigned char chunk[4096];
+	size_t count;
+	while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+	{
+		bytes.insert(bytes.end(), chunk, chunk + count);
+	}
+	fclose(file);
+
+	auto read16 = [&bytes](size_t offset) { return (unsigned int)(bytes[offset] | (bytes[offset + 1] << 8)); };
+	auto read32 = [&bytes](size_t offset) { return (unsigned int)(bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) | ((unsigned int)bytes[offset + 3] << 24)); };
+
+	if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0)
+	{
+		return false;
+	}
+
+	// Walk the chunks looking for the format and the data, anything else is skipped
+	unsigned int format = 0, channels = 0, rate = 0, bits = 0;
+	size_t dataOffset = 0, dataSize = 0;
+	size_t offset = 12;
+	while (offset + 8 <= bytes.size())
+	{
+		unsigned int chunkSize = read32(offset + 4);
+		size_t body = offset + 8;
+		if (memcmp(bytes.data() + offset, "fmt ", 4) == 0 && chunkSize >= 16 && body + 16 <= bytes.size())
+		{
+			format = read16(body);
+			channels = read16(body + 2);
+			rate = read32(body + 4);
+			bits = read16(body + 14);
+		}
+		else if (memcmp(bytes.data() + offset, "data", 4) == 0)
+		{
+			dataOffset = body;
+			dataSize = chunkSize < bytes.size() - body ? chunkSize : bytes.size() - body;
+		}
+		// Chunks are padded to an even size
+		offset = body + chunkSize + (chunkSize & 1);
+	}
+
+	bool supported = (format == 1 && (bits == 8 || bits == 16)) || (format == 3 && bits == 32);
+	if (!supported || channels == 0 || rate == 0 || dataOffset == 0)
+	{
+		return false;
+	}
+
+	// Decode to mono floats at the files own rate, the channels are averaged
+	const unsigned int frameBytes = channels * (bits / 8);
+	const size_t frameCount = dataSize / frameBytes;
+	std::vector<float> decoded(frameCount);
+	for (size_t frame = 0; frame < frameCount; frame++)
+	{
+		float sum = 0.0f;
+		for (unsigned int channel = 0; channel < channels; channel++)
+		{
+			size_t position = dataOffset + frame * frameBytes + channel * (bits / 8);
+			if (bits == 8)
+			{
+				sum += ((float)bytes[position] - 128.0f) / 128.0f;
+			}
+			else if (bits == 16)
+			{
+				sum += (float)(short)read16(position) / 32768.0f;
+			}
+			else
+			{
+				unsigned int raw = read32(position);
+				float value;
+				memcpy(&value, &raw, sizeof(value));
+				sum += value;
+			}
+		}
+		decoded[frame] = sum / channels;
+	}
+
+	// Resample to the engine rate with straight lines between the samples, it is done here so the mixer only has to add
+	if (rate == (unsigned int)SAMPLE_RATE || frameCount < 2)
+	{
+		samples.swap(decoded);
+		return true;
+	}
+	const double step = (double)rate / SAMPLE_RATE;
+	const size_t outputCount = (size_t)((frameCount - 1) / step) + 1;
+	samples.resize(outputCount);
+	for (size_t i = 0; i < outputCount; i++)
+	{
+		double position = i * step;
+		size_t index = (size_t)position;
+		float fraction = (float)(position - index);
+		float next = index + 1 < frameCount ? decoded[index + 1] : decoded[index];
+		samples[i] = decoded[index] + (next - decoded[index]) * fraction;
+	}
+	return true;
+}
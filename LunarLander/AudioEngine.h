@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: AudioEngine.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the audio engine. Sounds are decoded in to memory when they are loaded, and the game talks to the
+// mixer thread through a queue of commands so that nothing it does with sound can make a frame wait
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+// Includes
+#include "AudioSink.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Returned when a sound couldnt be loaded or a voice couldnt be started, passing it back in to the engine does nothing
+const int INVALID_AUDIO_ID = -1;
+
+/// <summary>
+/// This class mixes the sounds that are playing and sends them to a sink on its own thread
+/// </summary>
+class AudioEngine
+{
+public:
+	// The format everything is mixed at, sounds are converted to this when they are loaded
+	static const int SAMPLE_RATE = 22050;
+	// How many samples are mixed at a time, this is about 12ms
+	static const int BLOCK_SIZE = 256;
+	static const int MAX_SOUNDS = 32;
+	static const int MAX_VOICES = 16;
+
+	~AudioEngine();
+
+	/// <summary>
+	/// Opens the sink and starts the mixer thread
+	/// </summary>
+	/// <param name="outputSink"> Where the mixed sound goes, the engine takes ownership of it </param>
+	void Initialise(AudioSink* outputSink);
+
+	/// <summary>
+	/// Stops the mixer thread and closes the sink, it is fine to call this more than once
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	/// Reads and decodes a .wav file in to memory, this does read from disk so it should be done while the game is loading
+	/// </summary>
+	/// <param name="fileName"> The .wav file, it has to be PCM (8 or 16 bit) or 32 bit float </param>
+	/// <returns> The id of the sound, or INVALID_AUDIO_ID if it couldnt be loaded </returns>
+	int LoadSound(const char* fileName);
+
+	/// <summary>
+	/// Starts playing a sound
+	/// </summary>
+	/// <param name="sound"> The id that LoadSound gave back </param>
+	/// <param name="loop"> If true the sound keeps playing from the start until it is stopped </param>
+	/// <param name="gain"> How loud to play it, 1 is the volume of the file </param>
+	/// <returns> The id of the voice playing the sound, used to stop it or change its volume </returns>
+	int Play(int sound, bool loop = false, float gain = 1.0f);
+
+	// Stops a voice, nothing happens if it has already finished
+	void Stop(int voice);
+	// Changes how loud a voice is
+	void SetGain(int voice, float gain);
+	// Stops everything that is playing
+	void StopAll();
+
+	/// <summary>
+	/// How many commands were thrown away because the mixer had fallen behind, the queue should never fill up normally
+	/// </summary>
+	int GetDroppedCommands() const { return droppedCommands; }
+
+	/// <summary>
+	/// How many samples the mixer has sent to the sink
+	/// </summary>
+	long long GetMixedSamples() const { return mixedSamples.load(std::memory_order_relaxed); }
+
+private:
+	enum AUDIO_COMMAND_TYPE
+	{
+		COMMAND_PLAY,
+		COMMAND_STOP,
+		COMMAND_SET_GAIN,
+		COMMAND_STOP_ALL,
+	};
+
+	struct AudioCommand
+	{
+		AUDIO_COMMAND_TYPE type = COMMAND_STOP;
+		int voice = INVALID_AUDIO_ID;
+		int sound = INVALID_AUDIO_ID;
+		float gain = 1.0f;
+		bool loop = false;
+	};
+
+	// A sound that is playing, these are only touched by the mixer thread
+	struct Voice
+	{
+		int id = INVALID_AUDIO_ID;
+		int sound = INVALID_AUDIO_ID;
+		int position = 0;
+		float gain = 1.0f;
+		bool loop = false;
+	};
+
+	void SendCommand(const AudioCommand& command);
+	void MixerLoop();
+	void RunCommand(const AudioCommand& command);
+	void MixBlock(short* output);
+	static bool DecodeWav(const char* fileName, std::vector<float>& samples);
+
+	AudioSink* sink = nullptr;
+	std::thread mixer;
+	std::atomic<bool> running{ false };
+	SpscQueue<AudioCommand, 256> commands;
+
+	// The decoded sounds, a sound is filled in before the count is increased so the mixer never sees a half loaded one
+	std::vector<float> sounds[MAX_SOUNDS];
+	std::atomic<int> soundCount{ 0 };
+
+	// Mixer thread only
+	Voice voices[MAX_VOICES];
+	float mixBuffer[BLOCK_SIZE];
+	short outputBuffer[BLOCK_SIZE];
+
+	// Game thread only
+	int nextVoiceId = 0;
+	int droppedCommands = 0;
+
+	std::atomic<long long> mixedSamples{ 0 };
+};
+
+#endif // !AUDIO_ENGINE_H
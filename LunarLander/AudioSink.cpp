@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: AudioSink.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the audio sinks that dont need a sound card
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "AudioSink.h"
+// Includes
+#include <string.h>
+#include <thread>
+
+void AudioPacer::Start(int sampleRate)
+{
+	secondsPerSample = 1.0 / (double)sampleRate;
+	nextBlockTime = std::chrono::steady_clock::now();
+}
+
+/// <summary>
+/// Sleeps until the previous block would have finished playing, then moves the deadline on by this block
+/// </summary>
+void AudioPacer::Wait(int sampleCount)
+{
+	std::this_thread::sleep_until(nextBlockTime);
+	nextBlockTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(sampleCount * secondsPerSample));
+
+	// If we have fallen a long way behind (the computer went to sleep for example) then dont try to catch up all at once
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (nextBlockTime < now - std::chrono::milliseconds(250))
+	{
+		nextBlockTime = now;
+	}
+}
+
+bool NullAudioSink::Open(int sampleRate)
+{
+	pacer.Start(sampleRate);
+	return true;
+}
+
+void NullAudioSink::Write(const short* samples, int sampleCount)
+{
+	(void)samples;
+	pacer.Wait(sampleCount);
+}
+
+void NullAudioSink::Close()
+{
+}
+
+WavFileAudioSink::WavFileAudioSink(const char* outputPath, bool runInRealTime)
+	: path(outputPath), realTime(runInRealTime)
+{
+}
+
+bool WavFileAudioSink::Open(int sampleRate)
+{
+	rate = sampleRate;
+	bytesWritten = 0;
+	pacer.Start(sampleRate);
+
+	file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	// The sizes arent known yet, they are filled in when the file is closed
+	WriteHeader(sampleRate, 0);
+	return true;
+}
+
+void WavFileAudioSink::Write(const short* samples, int sampleCount)
+{
+	if (file)
+	{
+		// .wav files are little endian, which is what every platform the game runs on uses
+		bytesWritten += (unsigned int)fwrite(samples, sizeof(short), sampleCount, file) * sizeof(short);
+	}
+	if (realTime)
+	{
+		pacer.Wait(sampleCount);
+	}
+}
+
+void WavFileAudioSink::Close()
+{
+	if (!file)
+	{
+		return;
+	}
+	fseek(file, 0, SEEK_SET);
+	WriteHeader(rate, bytesWritten);
+	fclose(file);
+	file = nullptr;
+}
+
+/// <summary>
+/// Writes the 44 byte header for a 16 bit mono PCM .wav file
+/// </summary>
+void WavFileAudioSink::WriteHeader(int sampleRate, unsigned int dataBytes)
+{
+	unsigned char header[44];
+	auto put32 = [&header](int offset, unsigned int value)
+	{
+		header[offset] = (unsigned char)value;
+		header[offset + 1] = (unsigned char)(value >> 8);
+		header[offset + 2] = (unsigned char)(value >> 16);
+		header[offset + 3] = (unsigned char)(value >> 24);
+	};
+	auto put16 = [&header](int offset, unsigned int value)
+	{
+		header[offset] = (unsigned char)value;
+		header[offset + 1] = (unsigned char)(value >> 8);
+	};
+
+	memcpy(header, "RIFF", 4);
+	put32(4, 36 + dataBytes);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	put32(16, 16);                      // size of the format chunk
+	put16(20, 1);                       // PCM
+	put16(22, 1);                       // mono
+	put32(24, (unsigned int)sampleRate);
+	put32(28, (unsigned int)sampleRate * 2); // bytes per second
+	put16(32, 2);                       // bytes per sample
+	put16(34, 16);                      // bits per sample
+	memcpy(header + 36, "data", 4);
+	put32(40, dataBytes);
+
+	fwrite(header, 1, sizeof(header), file);
+}
@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: AudioSink.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the interface that the audio mixer writes its output to, along with the sinks that work everywhere:
+// one that throws the sound away and one that saves it to a .wav file, these are useful when there is no sound card
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+// Includes
+#include <chrono>
+#include <stdio.h>
+
+/// <summary>
+/// Somewhere for mixed sound to go, the samples are 16 bit mono. Only the mixer thread uses a sink.
+/// </summary>
+class AudioSink
+{
+public:
+	virtual ~AudioSink() {}
+
+	/// <summary>
+	/// Gets the sink ready to take sound
+	/// </summary>
+	/// <param name="sampleRate"> How many samples there are per second </param>
+	/// <returns> False if the sink couldnt be opened, the mixer will still run but nothing is written </returns>
+	virtual bool Open(int sampleRate) = 0;
+
+	/// <summary>
+	/// Writes a block of samples, this waits until the sink is ready for them which is what keeps the mixer running in real time
+	/// </summary>
+	/// <param name="samples"> The samples to write </param>
+	/// <param name="sampleCount"> How many samples there are </param>
+	virtual void Write(const short* samples, int sampleCount) = 0;
+
+	/// <summary>
+	/// Finishes off and lets go of whatever the sink was writing to
+	/// </summary>
+	virtual void Close() = 0;
+};
+
+/// <summary>
+/// Keeps a sink that doesnt have a sound card behind it running at the speed the sound would play at
+/// </summary>
+class AudioPacer
+{
+public:
+	void Start(int sampleRate);
+	void Wait(int sampleCount);
+
+private:
+	std::chrono::steady_clock::time_point nextBlockTime;
+	double secondsPerSample = 0.0;
+};
+
+/// <summary>
+/// A sink that throws the sound away
+/// </summary>
+class NullAudioSink : public AudioSink
+{
+public:
+	bool Open(int sampleRate) override;
+	void Write(const short* samples, int sampleCount) override;
+	void Close() override;
+
+private:
+	AudioPacer pacer;
+};
+
+/// <summary>
+/// A sink that saves the sound to a .wav file
+/// </summary>
+class WavFileAudioSink : public AudioSink
+{
+public:
+	/// <param name="outputPath"> The file to write, it is not copied so it has to stay around until the sink is opened </param>
+	/// <param name="runInRealTime"> If false the mixer runs as fast as it can, which is useful for tests that dont need to wait </param>
+	WavFileAudioSink(const char* outputPath, bool runInRealTime = true);
+
+	bool Open(int sampleRate) override;
+	void Write(const short* samples, int sampleCount) override;
+	void Close() override;
+
+private:
+	void WriteHeader(int sampleRate, unsigned int dataBytes);
+
+	const char* path;
+	bool realTime;
+	FILE* file = nullptr;
+	int rate = 0;
+	unsigned int bytesWritten = 0;
+	AudioPacer pacer;
+};
+
+#endif // !AUDIO_SINK_H
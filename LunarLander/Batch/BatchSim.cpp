@@ -0,0 +1,394 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: BatchSim.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this is a standalone program that flies lots of landers at once with no screen, using the same physics as the game.
+// Each run is flown by a simple autopilot and the results are added up and written to a file, this is used for tuning the
+// physics constants and where the platforms are
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Includes
+#include "../Constants.h"
+#include "../EntityStore.h"
+#include "../GameObjects.h"
+#include "../LanderPhysics.h"
+#include "../Level.h"
+#include "../Random.h"
+#include "../TerrainIndex.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// How many runs a thread takes at a time, big enough that the threads arent fighting over the counter
+const int RUNS_PER_CHUNK = 256;
+
+// How many cells ahead the autopilot looks at the ground, and how far above it the autopilot tries to stay
+const int LOOK_AHEAD = 8;
+const int MIN_CLEARANCE = 6;
+
+/// <summary>
+/// The settings for a batch, these come from the command line
+/// </summary>
+struct BatchSettings
+{
+	long long runs = 100000;
+	int maxTicks = SIMULATION_RATE * 120;
+	int threads = 0;
+	uint64_t seed = 1;
+	// How often the autopilot gets it wrong, from 0 (perfect) to 1 (presses random keys)
+	float noise = 0.2f;
+	PhysicsTuning tuning;
+	const char* outputPath = "BatchResults.csv";
+	const char* perRunPath = nullptr;
+};
+
+/// <summary>
+/// How a single run ended
+/// </summary>
+struct RunResult
+{
+	float startX = 0.0f;
+	float fuel = 0.0f;
+	int ticks = 0;
+	int score = 0;
+	short landX = -1;
+	unsigned char outcome = LANDING_NONE;
+};
+
+/// <summary>
+/// A place a lander can land, the column is where the lander's x position has to be
+/// </summary>
+struct Pad
+{
+	int column;
+	int row;
+};
+
+/// <summary>
+/// Finds every column where the lander can land, by looking at what a lander dropped straight down each column would hit first
+/// </summary>
+static std::vector<Pad> FindPads(const TerrainIndex& terrain)
+{
+	std::vector<Pad> pads;
+	for (int column = 0; column < LEVEL_WIDTH - Player::WIDTH; column++)
+	{
+		// The lander starts with its legs on this row, so that is where the drop is measured from
+		int row = terrain.GetAltitude(column, 0);
+		if (row <= LEVEL_HEIGHT - Player::HEIGHT && terrain.CheckLanding(column, row, 0.0f) == LANDING_LANDED)
+		{
+			pads.push_back({ column, row });
+		}
+	}
+	return pads;
+}
+
+/// <summary>
+/// The highest ground the lander will pass over in the next few columns, one for going each way
+/// </summary>
+struct Skyline
+{
+	std::vector<int> left;
+	std::vector<int> right;
+};
+
+/// <summary>
+/// Works out the skyline for every column from the terrain index, so the autopilot only has to look up one value each tick
+/// </summary>
+static Skyline BuildSkyline(const TerrainIndex& terrain)
+{
+	Skyline skyline;
+	skyline.left.assign(LEVEL_WIDTH, LEVEL_HEIGHT);
+	skyline.right.assign(LEVEL_WIDTH, LEVEL_HEIGHT);
+	for (int column = 0; column < LEVEL_WIDTH - Player::WIDTH; column++)
+	{
+		// Everything under the lander as it is now and wherever it will be after moving LOOK_AHEAD cells
+		for (int offset = 0; offset < Player::WIDTH + LOOK_AHEAD; offset++)
+		{
+			int right = column + offset;
+			int left = column + Player::WIDTH - 1 - offset;
+			if (right < LEVEL_WIDTH && terrain.GetSurfaceHeight(right) < skyline.right[column])
+			{
+				skyline.right[column] = terrain.GetSurfaceHeight(right);
+			}
+			if (left >= 0 && terrain.GetSurfaceHeight(left) < skyline.left[column])
+			{
+				skyline.left[column] = terrain.GetSurfaceHeight(left);
+			}
+		}
+	}
+	return skyline;
+}
+
+/// <summary>
+/// Works out the controls for one lander for the next tick. The autopilot steers over the platform and keeps the descent slow,
+/// every so often it presses something random instead.
+/// </summary>
+/// <param name="random"> The lander's own random numbers </param>
+/// <param name="targetX"> The column to get over, the middle of the cell </param>
+/// <param name="targetY"> The height to hold until it is over the platform </param>
+/// <param name="noiseThreshold"> How often a random press is made, out of 2^32 </param>
+static inline PlayerInput Autopilot(Random& random, float xPos, float yPos, float velocityY, float targetX, float targetY, const Skyline& skyline,
+	uint32_t noiseThreshold)
+{
+	PlayerInput input;
+	if (random.Next() < noiseThreshold)
+	{
+		uint32_t keys = random.Next();
+		input.thrust = (keys & 1) != 0;
+		input.left = (keys & 2) != 0;
+		input.right = (keys & 4) != 0;
+		return input;
+	}
+
+	float distance = targetX - xPos;
+	input.left = distance < -0.5f;
+	input.right = distance > 0.5f;
+	// Hold height until over the platform, then come down gently. On the way there it also climbs whenever the ground coming
+	// up is getting close, the lander is slow to turn around so it has to start early
+	const std::vector<int>& ahead = input.left ? skyline.left : skyline.right;
+	bool groundClose = (int)yPos + Player::HEIGHT + MIN_CLEARANCE > ahead[(int)xPos];
+	bool overPad = !input.left && !input.right;
+	input.thrust = overPad ? velocityY < -0.1f : (yPos > targetY || groundClose);
+	return input;
+}
+
+/// <summary>
+/// Flies a chunk of runs together, every lander in the chunk is kept in an entity store and moved one tick at a time in the
+/// same pass, so the physics loop runs over columns of floats instead of jumping between players. Landers that finish are
+/// taken out of the store so the passes only ever look at the ones still flying.
+/// </summary>
+static void FlyChunk(uint64_t seed, long long firstRun, int count, const BatchSettings& settings, const TerrainIndex& terrain, const std::vector<Pad>& pads,
+	const Skyline& skyline, EntityStore& store, RunResult* results)
+{
+	// These line up with the lander columns in the store and are moved around with them
+	std::vector<int> runs((size_t)count);
+	std::vector<Random> random((size_t)count);
+	std::vector<float> targetX((size_t)count);
+	std::vector<float> targetY((size_t)count);
+
+	// The landers start where the game's player does, only across the screen is random
+	const Player start;
+	store.ClearLanders();
+	for (int i = 0; i < count; i++)
+	{
+		// Each run has its own stream, so the result of a run doesnt depend on which thread flew it or what else is in its chunk
+		runs[i] = i;
+		random[i].Seed(seed, (uint64_t)(firstRun + i));
+		float xPos = (float)random[i].NextInt(LEVEL_WIDTH - start.WIDTH);
+		store.AddLander(xPos, start.yPos, start.fuel, 0);
+
+		// Aim for a random platform
+		const Pad& target = pads[random[i].NextInt((int)pads.size())];
+		// The middle of the cell, so that being within half a cell of it always puts the lander in the right column
+		targetX[i] = (float)target.column + 0.5f;
+		targetY[i] = (float)(target.row - 4);
+		results[i] = RunResult();
+		results[i].startX = xPos;
+		results[i].ticks = settings.maxTicks;
+	}
+
+	LanderColumns& landers = store.landers;
+	const uint32_t noiseThreshold = (uint32_t)(settings.noise * 4294967295.0f);
+	for (int tick = 0; tick < settings.maxTicks && landers.Count() > 0; tick++)
+	{
+		// The controls go straight in to the store's columns, which the step then reads 4 landers at a time
+		const int flying = landers.Count();
+		for (int i = 0; i < flying; i++)
+		{
+			PlayerInput input = Autopilot(random[i], landers.xPos[i], landers.yPos[i], landers.velocityY[i], targetX[i], targetY[i], skyline, noiseThreshold);
+			landers.thrust[i] = input.thrust;
+			landers.left[i] = input.left;
+			landers.right[i] = input.right;
+		}
+
+		store.StepLanders(SIMULATION_STEP, settings.tuning);
+		if (store.CheckLandings(terrain) == 0)
+		{
+			continue;
+		}
+
+		// Write out the runs that just finished and take them out of the store, the last lander fills the gap so its
+		// other values have to move with it
+		for (int i = 0; i < landers.Count();)
+		{
+			if (landers.state[i] == LANDING_NONE)
+			{
+				i++;
+				continue;
+			}
+			RunResult& result = results[runs[i]];
+			result.outcome = landers.state[i];
+			result.ticks = tick + 1;
+			result.landX = (short)landers.xPos[i];
+			result.score = landers.score[i];
+			result.fuel = landers.fuel[i];
+
+			int last = landers.Count() - 1;
+			runs[i] = runs[last];
+			random[i] = random[last];
+			targetX[i] = targetX[last];
+			targetY[i] = targetY[last];
+			store.RemoveLander(i);
+		}
+	}
+
+	// Anything left ran out of time
+	for (int i = 0; i < landers.Count(); i++)
+	{
+		results[runs[i]].fuel = landers.fuel[i];
+	}
+}
+
+/// <summary>
+/// Reads the command line, anything that isnt recognised is ignored
+/// </summary>
+static void ReadSettings(int argc, char* argv[], BatchSettings& settings)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		const char* option = argv[i];
+		const char* value = argv[i + 1];
+		if (strcmp(option, "--runs") == 0) { settings.runs = atoll(value); }
+		else if (strcmp(option, "--ticks") == 0) { settings.maxTicks = atoi(value); }
+		else if (strcmp(option, "--threads") == 0) { settings.threads = atoi(value); }
+		else if (strcmp(option, "--seed") == 0) { settings.seed = strtoull(value, nullptr, 10); }
+		else if (strcmp(option, "--noise") == 0) { settings.noise = (float)atof(value); }
+		else if (strcmp(option, "--acceleration") == 0) { settings.tuning.accelerationRate = (float)atof(value); }
+		else if (strcmp(option, "--deceleration") == 0) { settings.tuning.decelerationRate = (float)atof(value); }
+		else if (strcmp(option, "--move-speed") == 0) { settings.tuning.moveSpeed = (float)atof(value); }
+		else if (strcmp(option, "--fuel-rate") == 0) { settings.tuning.fuelConsumptionRate = (float)atof(value); }
+		else if (strcmp(option, "--out") == 0) { settings.outputPath = value; }
+		else if (strcmp(option, "--per-run") == 0) { settings.perRunPath = value; }
+		else { continue; }
+		i++;
+	}
+	if (settings.threads <= 0)
+	{
+		settings.threads = (int)std::thread::hardware_concurrency();
+		settings.threads = settings.threads > 0 ? settings.threads : 1;
+	}
+	settings.noise = settings.noise < 0.0f ? 0.0f : (settings.noise > 1.0f ? 1.0f : settings.noise);
+}
+
+/// <summary>
+/// Runs the batch on every core and writes out the results
+/// </summary>
+/// <param name="argc"> Number of command line arguments </param>
+/// <param name="argv"> The command line arguments: --runs, --ticks, --threads, --seed, --noise, --acceleration, --deceleration,
+/// --move-speed and --fuel-rate each followed by a number, and --out and --per-run each followed by a file path </param>
+/// <returns> 0 if the results were written </returns>
+int main(int argc, char* argv[])
+{
+	BatchSettings settings;
+	ReadSettings(argc, argv, settings);
+
+	// The batch flies the built in level, the index is what the landers are checked against
+	Level level;
+	level.BuildFromAscii(Background::CHARACTERS);
+	TerrainIndex terrain;
+	terrain.Build(level);
+	std::vector<Pad> pads = FindPads(terrain);
+	Skyline skyline = BuildSkyline(terrain);
+	if (pads.empty() || settings.runs <= 0)
+	{
+		fprintf(stderr, "Nothing to fly\n");
+		return 1;
+	}
+
+	// Every run has its own slot, so the threads never write to the same place
+	std::vector<RunResult> results((size_t)settings.runs);
+	std::atomic<long long> nextRun{ 0 };
+
+	auto worker = [&]()
+	{
+		EntityStore store;
+		long long first;
+		while ((first = nextRun.fetch_add(RUNS_PER_CHUNK)) < settings.runs)
+		{
+			long long last = first + RUNS_PER_CHUNK < settings.runs ? first + RUNS_PER_CHUNK : settings.runs;
+			FlyChunk(settings.seed, first, (int)(last - first), settings, terrain, pads, skyline, store, &results[(size_t)first]);
+		}
+	};
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int i = 0; i < settings.threads; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Add everything up
+	long long outcomes[3] = {};
+	long long totalTicks = 0;
+	long long totalScore = 0;
+	double totalFuel = 0.0;
+	long long landedAt[LEVEL_WIDTH] = {};
+	long long crashedAt[LEVEL_WIDTH] = {};
+	for (const RunResult& result : results)
+	{
+		outcomes[result.outcome]++;
+		totalTicks += result.ticks;
+		totalScore += result.score;
+		totalFuel += result.fuel;
+		if (result.outcome == LANDING_LANDED)
+		{
+			landedAt[result.landX]++;
+		}
+		else if (result.outcome == LANDING_CRASHED)
+		{
+			crashedAt[result.landX]++;
+		}
+	}
+
+	FILE* output = fopen(settings.outputPath, "w");
+	if (!output)
+	{
+		fprintf(stderr, "Couldnt write %s\n", settings.outputPath);
+		return 1;
+	}
+	fprintf(output, "runs,%lld\nseed,%llu\nacceleration_rate,%g\ndeceleration_rate,%g\nmove_speed,%g\nfuel_consumption_rate,%g\nnoise,%g\n",
+		settings.runs, (unsigned long long)settings.seed, settings.tuning.accelerationRate, settings.tuning.decelerationRate,
+		settings.tuning.moveSpeed, settings.tuning.fuelConsumptionRate, settings.noise);
+	fprintf(output, "landed,%lld\ncrashed,%lld\ntimed_out,%lld\nmean_ticks,%.2f\nmean_score,%.2f\nmean_fuel_left,%.2f\n",
+		outcomes[LANDING_LANDED], outcomes[LANDING_CRASHED], outcomes[LANDING_NONE], (double)totalTicks / settings.runs,
+		(double)totalScore / settings.runs, totalFuel / settings.runs);
+	fprintf(output, "\ncolumn,landed,crashed\n");
+	for (int column = 0; column < LEVEL_WIDTH; column++)
+	{
+		if (landedAt[column] || crashedAt[column])
+		{
+			fprintf(output, "%d,%lld,%lld\n", column, landedAt[column], crashedAt[column]);
+		}
+	}
+	fclose(output);
+
+	// Every run on its own line, this can get big so it is only written if asked for
+	if (settings.perRunPath)
+	{
+		FILE* perRun = fopen(settings.perRunPath, "w");
+		if (perRun)
+		{
+			fprintf(perRun, "run,start_x,outcome,ticks,fuel_left,score,land_x\n");
+			for (size_t run = 0; run < results.size(); run++)
+			{
+				const RunResult& result = results[run];
+				fprintf(perRun, "%zu,%.3f,%d,%d,%.3f,%d,%d\n", run, result.startX, result.outcome, result.ticks, result.fuel, result.score, result.landX);
+			}
+			fclose(perRun);
+		}
+	}
+
+	printf("runs,%lld\nthreads,%d\nlanded,%lld\ncrashed,%lld\ntimed_out,%lld\nseconds,%.3f\nticks_per_second_per_thread,%.0f\n",
+		settings.runs, settings.threads, outcomes[LANDING_LANDED], outcomes[LANDING_CRASHED], outcomes[LANDING_NONE], seconds,
+		(double)totalTicks / seconds / settings.threads);
+	return 0;
+}
@@ -0,0 +1,927 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Benchmark.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this is a standalone program that times the render path, from the drawing functions in Utility.h up to composing a
+// whole play frame and turning it in to console output, at a few different screen sizes. It is used to check that changes to
+// the render path dont make it any slower, given the results from a previous run it fails if anything has got slower.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Includes
+#include "../CellKernels.h"
+#include "../ChunkWorld.h"
+#include "../Constants.h"
+#include "../Compositor.h"
+#include "../Game.h"
+#include "../GameObjects.h"
+#include "../HudText.h"
+#include "../ParticleSystem.h"
+#include "../Presenter.h"
+#include "../Random.h"
+#include "../Utility.h"
+#include "../Viewport.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// TYPEDEFS
+typedef std::chrono::steady_clock BenchClock;
+
+// The screen sizes everything that depends on the size of the buffer is timed at, the game's own size is in the middle
+struct FrameSize
+{
+	int width;
+	int height;
+};
+static const FrameSize FRAME_SIZES[] = { { 80, 25 }, { LEVEL_WIDTH, LEVEL_HEIGHT }, { 300, 90 } };
+
+// How many times each timing is repeated by default. The fastest one is what gets compared against a baseline as it is the one
+// with the least noise from the rest of the system, the median is printed as well to show how noisy the run was.
+const int DEFAULT_SAMPLE_COUNT = 15;
+static int sampleCount = DEFAULT_SAMPLE_COUNT;
+// Only benchmarks with this in their name are run, or all of them if it is null
+static const char* nameFilter = nullptr;
+
+// Stops the compiler from removing the work being timed as it cant see that nothing reads the buffer
+static volatile int benchmarkSink = 0;
+
+// Every heap allocation in the program goes through the operator new below, which counts them. The game has threads of its
+// own (the mixer and the settings writer) so this is counted from all of them.
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	void* memory = malloc(size ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+/// <summary>
+/// How long something took
+/// </summary>
+struct BenchmarkResult
+{
+	double bestNs = 0.0;
+	double medianNs = 0.0;
+	// Heap allocations per call, this should be 0 for anything the game does every frame
+	double allocations = 0.0;
+};
+
+/// <summary>
+/// One line of the results, these are kept so they can be compared against the baseline at the end
+/// </summary>
+struct ReportedResult
+{
+	std::string name;
+	int width;
+	int height;
+	double bestNs;
+	double allocations;
+};
+static std::vector<ReportedResult> reportedResults;
+
+// The bits of a key mask for the keys the allocation check presses, they are in the order Game::Initialise watches the keys
+const uint16_t KEY_MASK_ENTER = 1 << 1;
+const uint16_t KEY_MASK_W = 1 << 2;
+const uint16_t KEY_MASK_A = 1 << 3;
+const uint16_t KEY_MASK_D = 1 << 5;
+const uint16_t KEY_MASK_P = 1 << 6;
+// How long each frame of the allocation check is, and how many are played before and while the allocations are counted
+const float GAME_FRAME_TIME = 1.0f / 60.0f;
+const int GAME_WARM_UP_FRAMES = 60;
+const int GAME_COUNTED_FRAMES = 300;
+
+/// <summary>
+/// This is how WriteImageToBuffer worked before it clipped to the edge of the buffer, it is kept here to compare against
+/// </summary>
+static void WriteImageToBufferUnclipped(Cell* consoleBuffer, const char* charsToPrint, const uint8_t coloursToPrint[], const int ImageHeight, const int imageWidth, int imageXPos, int imageYPos)
+{
+	for (int y = 0; y < ImageHeight; y++)
+	{
+		for (int x = 0; x < imageWidth; x++)
+		{
+			consoleBuffer[(imageXPos + x) + LEVEL_WIDTH * (imageYPos + y)].glyph = charsToPrint[x + imageWidth * y];
+
+			if (coloursToPrint)
+			{
+				consoleBuffer[(imageXPos + x) + LEVEL_WIDTH * (imageYPos + y)].attributes = coloursToPrint[x + imageWidth * y];
+			}
+			else
+			{
+				consoleBuffer[(imageXPos + x) + LEVEL_WIDTH * (imageYPos + y)].attributes = 7;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// If a benchmark should be run, this lets a single one be picked out when working on it
+/// </summary>
+static bool ShouldRun(const char* name)
+{
+	return !nameFilter || strstr(name, nameFilter);
+}
+
+/// <summary>
+/// Runs a piece of code lots of times and works out how long each run took
+/// </summary>
+/// <param name="iterations"> How many times the code is run for each sample </param>
+/// <param name="work"> The code to time, it is given the iteration number </param>
+template <typename WORK>
+static BenchmarkResult Measure(int iterations, WORK work)
+{
+	// One run that isnt counted, so the caches are warm and anything that is set up on first use has been
+	for (int i = 0; i < iterations; i++)
+	{
+		work(i);
+	}
+
+	std::vector<double> samples;
+	samples.reserve(sampleCount);
+	long long allocationsBefore = allocationCount;
+	for (int sample = 0; sample < sampleCount; sample++)
+	{
+		BenchClock::time_point start = BenchClock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			work(i);
+		}
+		samples.push_back(std::chrono::duration<double>(BenchClock::now() - start).count() * 1e9 / iterations);
+	}
+	// The samples vector was reserved before counting started, so anything counted was done by the work
+	long long allocations = allocationCount - allocationsBefore;
+
+	std::sort(samples.begin(), samples.end());
+	BenchmarkResult result;
+	result.bestNs = samples.front();
+	result.medianNs = samples[samples.size() / 2];
+	result.allocations = (double)allocations / ((double)iterations * sampleCount);
+	return result;
+}
+
+/// <summary>
+/// Prints one line of the results
+/// </summary>
+/// <param name="name"> The name of the benchmark </param>
+/// <param name="width"> Width of the buffer it drew to, or 0 if it doesnt depend on one </param>
+/// <param name="height"> Height of the buffer it drew to </param>
+/// <param name="result"> The timings </param>
+/// <param name="bytesPerFrame"> How much console output each call made, or a negative number if it doesnt make any </param>
+static void Report(const char* name, int width, int height, const BenchmarkResult& result, double bytesPerFrame = -1.0)
+{
+	printf("%s,%d,%d,%.2f,%.2f,", name, width, height, result.bestNs, result.medianNs);
+	if (width > 0)
+	{
+		printf("%.4f", result.bestNs / ((double)width * height));
+	}
+	printf(",");
+	if (bytesPerFrame >= 0.0)
+	{
+		printf("%.0f", bytesPerFrame);
+	}
+	printf(",%.2f\n", result.allocations);
+	reportedResults.push_back({ name, width, height, result.bestNs, result.allocations });
+}
+
+/// <summary>
+/// Times a benchmark and prints the result, unless it has been filtered out
+/// </summary>
+template <typename WORK>
+static void RunBenchmark(const char* name, int width, int height, int iterations, WORK work)
+{
+	if (ShouldRun(name))
+	{
+		Report(name, width, height, Measure(iterations, work));
+	}
+}
+
+/// <summary>
+/// How many times to run something that has to touch every cell of the buffer, so that each sample takes about as long
+/// whatever the size of the buffer is
+/// </summary>
+static int IterationsForSize(int iterationsAtScreenSize, const FrameSize& size)
+{
+	int iterations = (int)((long long)iterationsAtScreenSize * LEVEL_WIDTH * LEVEL_HEIGHT / (size.width * size.height));
+	return iterations > 10 ? iterations : 10;
+}
+
+/// <summary>
+/// The level background repeated to fill a buffer of any size, so the bigger screens have as much on them as the game's does
+/// </summary>
+static std::string TileBackground(const FrameSize& size)
+{
+	std::string tiled(size.width * size.height, ' ');
+	for (int y = 0; y < size.height; y++)
+	{
+		for (int x = 0; x < size.width; x++)
+		{
+			tiled[x + size.width * y] = Background::CHARACTERS[(x % LEVEL_WIDTH) + LEVEL_WIDTH * (y % LEVEL_HEIGHT)];
+		}
+	}
+	return tiled;
+}
+
+/// <summary>
+/// Everything the game draws on a play frame, in the same order as Game::Draw: the background restore, a fuel pickup, some
+/// exhaust, the lander and the HUD. The level is fitted to the screen the same way the game does it, and the lander and the
+/// numbers change from frame to frame the same way they do when playing.
+/// </summary>
+struct PlayFrame
+{
+	void Initialise(const FrameSize& frameSize)
+	{
+		size = frameSize;
+		buffer.assign(size.width * size.height, Cell());
+		levelLayer.Build(Background::CHARACTERS, nullptr, LEVEL_HEIGHT, LEVEL_WIDTH);
+		view.Resize(size.width, size.height, LEVEL_WIDTH, LEVEL_HEIGHT, true);
+		view.MapLayer(levelLayer, backgroundLayer);
+		compositor.SetBackground(&backgroundLayer);
+
+		// A thruster's worth of exhaust, it isnt updated so it stays the same for every frame
+		particles.Initialise(ParticleSystem::DEFAULT_CAPACITY, size.width, size.height);
+		Random random;
+		random.Seed(1, RANDOM_STREAM_EFFECTS);
+		ParticleBurst exhaust;
+		exhaust.x = LEVEL_WIDTH * 0.5f;
+		exhaust.y = LEVEL_HEIGHT * 0.5f;
+		exhaust.spread = 4.0f;
+		exhaust.minLife = 0.25f;
+		exhaust.maxLife = 0.6f;
+		exhaust.ramp = PARTICLE_RAMP_EXHAUST;
+		particles.Emit(exhaust, 60, random);
+	}
+
+	void Draw(int frame)
+	{
+		compositor.BeginFrame(buffer.data(), size.width, size.height);
+		compositor.DrawSprite(Fuel::SPRITE, view.SpriteToScreenX(LEVEL_WIDTH / 3, Fuel::WIDTH), view.SpriteToScreenY(LEVEL_HEIGHT / 3, Fuel::HEIGHT));
+		particles.Draw(compositor, buffer.data(), view.GetOffsetX(), view.GetOffsetY(), 0, view.GetScale());
+		int landerX = (frame * 3) % (LEVEL_WIDTH - Player::WIDTH);
+		int landerY = (frame / 2) % (LEVEL_HEIGHT - Player::HEIGHT);
+		compositor.DrawSprite(Player::SPRITE_DEFAULT, view.SpriteToScreenX(landerX, Player::WIDTH), view.SpriteToScreenY(landerY, Player::HEIGHT));
+
+		scoreField.SetValue(50.0f);
+		timeField.SetValue(frame / 60.0f);
+		velocityField.SetValue(-0.5f + (frame % 100) / 100.0f);
+		fuelField.SetValue(100.0f - (frame % 1000) / 10.0f);
+		altitudeField.SetValue((float)(frame % size.height));
+		compositor.DrawHudField(scoreField, 1, 0);
+		compositor.DrawHudField(timeField, 1, 1);
+		compositor.DrawHudField(velocityField, 1, 2);
+		compositor.DrawHudField(fuelField, 1, 3);
+		compositor.DrawHudField(altitudeField, size.width - 14, 0);
+	}
+
+	FrameSize size;
+	std::vector<Cell> buffer;
+	Layer levelLayer;
+	Viewport view;
+	Layer backgroundLayer;
+	Compositor compositor;
+	ParticleSystem particles;
+	HudField scoreField{ "SCORE: ", 0 };
+	HudField timeField{ "TIME: ", 2 };
+	HudField velocityField{ "Y VELOCITY: ", 2 };
+	HudField fuelField{ "FUEL: ", 2 };
+	HudField altitudeField{ "ALTITUDE: ", 0, "M" };
+};
+
+/// <summary>
+/// Times the drawing functions from Utility.h at every size, along with the old unclipped versions at the game's size
+/// </summary>
+static void RunDrawingBenchmarks()
+{
+	// The images that the game draws, as plain characters and colours like WriteImageToBuffer takes them
+	const char* landerChars = "=__  ||  /\\ ";
+	const uint8_t landerColours[Player::WIDTH * Player::HEIGHT] = { 0xA, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xE, 0xE, 0xF };
+	const char* explosionChars = "\\  |  /       -     -       /  |  \\";
+	const char* crashText = "Press 'Enter' to return to menu...";
+	const int crashTextLength = (int)strlen(crashText);
+
+	std::vector<Cell> screen(LEVEL_WIDTH * LEVEL_HEIGHT);
+	Cell* consoleBuffer = screen.data();
+
+	// The lander, explosion and background at the game's size where the unclipped versions can be used as well
+	RunBenchmark("image_4x3_unclipped", LEVEL_WIDTH, LEVEL_HEIGHT, 1000000, [&](int i)
+	{
+		WriteImageToBufferUnclipped(consoleBuffer, landerChars, landerColours, 3, 4, i % 140, i % 35);
+	});
+	RunBenchmark("image_7x5_unclipped", LEVEL_WIDTH, LEVEL_HEIGHT, 1000000, [&](int i)
+	{
+		WriteImageToBufferUnclipped(consoleBuffer, explosionChars, Explosion::COLOURS, 5, 7, i % 140, i % 35);
+	});
+	RunBenchmark("image_150x40_unclipped", LEVEL_WIDTH, LEVEL_HEIGHT, 10000, [&](int)
+	{
+		WriteImageToBufferUnclipped(consoleBuffer, Background::CHARACTERS, nullptr, LEVEL_HEIGHT, LEVEL_WIDTH, 0, 0);
+	});
+
+	for (const FrameSize& size : FRAME_SIZES)
+	{
+		std::vector<Cell> buffer(size.width * size.height);
+		Cell* target = buffer.data();
+		const int w = size.width;
+		const int h = size.height;
+		std::string tiled = TileBackground(size);
+
+		RunBenchmark("clear_screen", w, h, IterationsForSize(10000, size), [&](int)
+		{
+			ClearScreen(target, w, h);
+		});
+		// The background filling the whole buffer, the biggest image the game draws
+		RunBenchmark("image_full_screen", w, h, IterationsForSize(10000, size), [&](int)
+		{
+			WriteImageToBuffer(target, w, h, tiled.c_str(), nullptr, h, w, 0, 0);
+		});
+		RunBenchmark("image_4x3_clipped", w, h, 1000000, [&](int i)
+		{
+			WriteImageToBuffer(target, w, h, landerChars, landerColours, 3, 4, (i * 7) % (w - 4), (i * 3) % (h - 3));
+		});
+		RunBenchmark("image_7x5_clipped", w, h, 1000000, [&](int i)
+		{
+			WriteImageToBuffer(target, w, h, explosionChars, Explosion::COLOURS, 5, 7, (i * 7) % (w - 7), (i * 3) % (h - 5));
+		});
+		// The explosion hanging off the bottom right corner, this is the case that used to write past the end of the buffer
+		RunBenchmark("image_7x5_clipped_edge", w, h, 1000000, [&](int i)
+		{
+			WriteImageToBuffer(target, w, h, explosionChars, Explosion::COLOURS, 5, 7, w - 3, h - 2 - (i & 1));
+		});
+		RunBenchmark("sprite_7x5_clipped", w, h, 1000000, [&](int i)
+		{
+			WriteSpriteToBuffer(target, w, h, Explosion::SPRITE_BIG, (i * 7) % (w - 7), (i * 3) % (h - 5));
+		});
+		// The crash text, once in the middle where the game draws it and once running off the right hand side
+		RunBenchmark("text_34_clipped", w, h, 1000000, [&](int i)
+		{
+			WriteTextToBuffer(target, w, h, crashText, crashTextLength, w / 2 - crashTextLength / 2, i % h);
+		});
+		RunBenchmark("text_34_clipped_edge", w, h, 1000000, [&](int i)
+		{
+			WriteTextToBuffer(target, w, h, crashText, crashTextLength, w - 10, i % h);
+		});
+		benchmarkSink = target[w * h - 1].glyph;
+	}
+	benchmarkSink = consoleBuffer[LEVEL_WIDTH * LEVEL_HEIGHT - 1].glyph;
+}
+
+/// <summary>
+/// Times a whole play frame being composed, and then turned in to console output by the presenter. The presenter is timed
+/// sending every cell (the first frame, or after the screen has been cleared) and sending only what changed between two play
+/// frames, which is what it does nearly all of the time.
+/// </summary>
+static void RunFrameBenchmarks()
+{
+	for (const FrameSize& size : FRAME_SIZES)
+	{
+		PlayFrame playFrame;
+		playFrame.Initialise(size);
+		const int w = size.width;
+		const int h = size.height;
+
+		// Fitting the level to the screen, the game only does this when the screen changes size or the camera moves
+		RunBenchmark("viewport_map", w, h, IterationsForSize(2000, size), [&](int)
+		{
+			playFrame.view.MapLayer(playFrame.levelLayer, playFrame.backgroundLayer);
+		});
+		RunBenchmark("play_frame_compose", w, h, IterationsForSize(20000, size), [&](int i)
+		{
+			playFrame.Draw(i);
+		});
+
+		// Two frames that are a frame apart, to present one after the other
+		playFrame.Draw(100);
+		std::vector<Cell> frameA = playFrame.buffer;
+		playFrame.Draw(101);
+		std::vector<Cell> frameB = playFrame.buffer;
+
+		Presenter presenter;
+		std::string output;
+		// Big enough for the worst case up front, so the timing doesnt include the string growing
+		output.reserve(w * h * 24);
+		long long bytes = 0;
+		long long presents = 0;
+
+		if (ShouldRun("present_full"))
+		{
+			BenchmarkResult full = Measure(IterationsForSize(2000, size), [&](int)
+			{
+				presenter.Invalidate();
+				presenter.Diff(frameA.data(), w, h);
+				presenter.EncodeAnsi(frameA.data(), w, output);
+				bytes += output.size();
+				presents++;
+			});
+			Report("present_full", w, h, full, (double)bytes / presents);
+		}
+
+		if (ShouldRun("present_play"))
+		{
+			bytes = 0;
+			presents = 0;
+			BenchmarkResult changed = Measure(IterationsForSize(20000, size), [&](int i)
+			{
+				const Cell* frame = (i & 1) ? frameB.data() : frameA.data();
+				presenter.Diff(frame, w, h);
+				presenter.EncodeAnsi(frame, w, output);
+				bytes += output.size();
+				presents++;
+			});
+			Report("present_play", w, h, changed, (double)bytes / presents);
+		}
+
+		// The same as present_play but converting to console cells like the windows platform does
+		if (ShouldRun("present_play_char_info"))
+		{
+			std::vector<CHAR_INFO> consoleCells(w * h);
+			bytes = 0;
+			presents = 0;
+			BenchmarkResult changed = Measure(IterationsForSize(20000, size), [&](int i)
+			{
+				const Cell* frame = (i & 1) ? frameB.data() : frameA.data();
+				presenter.Diff(frame, w, h);
+				presenter.EncodeCharInfo(frame, w, consoleCells);
+				bytes += consoleCells.size() * sizeof(CHAR_INFO);
+				presents++;
+			});
+			Report("present_play_char_info", w, h, changed, (double)bytes / presents);
+			benchmarkSink = (int)consoleCells.size();
+		}
+
+		// The whole frame as the game does it, composed and then turned in to console output, with the presenter only sending
+		// what changed since the frame before
+		if (ShouldRun("play_frame"))
+		{
+			Presenter framePresenter;
+			bytes = 0;
+			presents = 0;
+			BenchmarkResult whole = Measure(IterationsForSize(20000, size), [&](int i)
+			{
+				playFrame.Draw(i);
+				framePresenter.Diff(playFrame.buffer.data(), w, h);
+				framePresenter.EncodeAnsi(playFrame.buffer.data(), w, output);
+				bytes += output.size();
+				presents++;
+			});
+			Report("play_frame", w, h, whole, (double)bytes / presents);
+		}
+		benchmarkSink = (int)output.size();
+	}
+}
+
+/// <summary>
+/// Times the HUD, the particles and the planet view at the game's size
+/// </summary>
+static void RunGameplayBenchmarks()
+{
+	std::vector<Cell> buffer(LEVEL_WIDTH * LEVEL_HEIGHT);
+	Cell* consoleBuffer = buffer.data();
+
+	// Draw the play screen HUD the same way the game does, once it has settled down there should be no heap allocations at all
+	Layer backgroundLayer;
+	backgroundLayer.Build(Background::CHARACTERS, nullptr, LEVEL_HEIGHT, LEVEL_WIDTH);
+	Compositor compositor;
+	compositor.SetBackground(&backgroundLayer);
+	HudField scoreField("SCORE: ", 0);
+	HudField timeField("TIME: ", 2);
+	HudField velocityField("Y VELOCITY: ", 2);
+	HudField fuelField("FUEL: ", 2);
+	HudField altitudeField("ALTITUDE: ", 0, "M");
+
+	RunBenchmark("hud_frame", LEVEL_WIDTH, LEVEL_HEIGHT, 100000, [&](int frame)
+	{
+		compositor.BeginFrame(consoleBuffer, LEVEL_WIDTH, LEVEL_HEIGHT);
+		scoreField.SetValue(50.0f);
+		timeField.SetValue(frame / 60.0f);
+		velocityField.SetValue(-0.5f + (frame % 100) / 100.0f);
+		fuelField.SetValue(100.0f - (frame % 1000) / 10.0f);
+		altitudeField.SetValue((float)(frame % LEVEL_HEIGHT));
+		compositor.DrawHudField(scoreField, 1, 0);
+		compositor.DrawHudField(timeField, 1, 1);
+		compositor.DrawHudField(velocityField, 1, 2);
+		compositor.DrawHudField(fuelField, 1, 3);
+		compositor.DrawHudField(altitudeField, LEVEL_WIDTH - 14, 0);
+		compositor.DrawText("COMMAND, MISSION HAS FAILED!", LEVEL_WIDTH / 2, LEVEL_HEIGHT / 2);
+	});
+
+	// A full pool of explosion debris, topped back up every frame so the count stays the same while it is being timed
+	ParticleSystem particles;
+	particles.Initialise(ParticleSystem::DEFAULT_CAPACITY, LEVEL_WIDTH, LEVEL_HEIGHT);
+	Random random;
+	random.Seed(1, RANDOM_STREAM_EFFECTS);
+	ParticleBurst debris;
+	debris.x = LEVEL_WIDTH * 0.5f;
+	debris.y = LEVEL_HEIGHT * 0.5f;
+	debris.spread = 40.0f;
+	debris.minLife = 0.5f;
+	debris.maxLife = 3.0f;
+	debris.ramp = PARTICLE_RAMP_EXPLOSION;
+
+	RunBenchmark("particles_32768_frame", LEVEL_WIDTH, LEVEL_HEIGHT, 200, [&](int)
+	{
+		particles.Emit(debris, particles.GetCapacity() - particles.GetCount(), random);
+		particles.Update(1.0f / 60.0f, 12.0f, 1.5f);
+		compositor.BeginFrame(consoleBuffer, LEVEL_WIDTH, LEVEL_HEIGHT);
+		particles.Draw(compositor, consoleBuffer);
+	});
+
+	// The view scrolling across planets of very different sizes, only the chunks in view are touched so these should all take
+	// the same time. The camera stays inside a stretch that fits in the chunk cache so this times drawing rather than generating.
+	const int planetWidths[] = { 16, 256, 4096 };
+	for (int widthInChunks : planetWidths)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "planet_view_%d_wide", widthInChunks * CHUNK_SIZE);
+		if (!ShouldRun(name))
+		{
+			continue;
+		}
+
+		ChunkWorld world;
+		PlanetSettings planetSettings;
+		planetSettings.widthInChunks = widthInChunks;
+		world.Initialise(planetSettings);
+		RunBenchmark(name, LEVEL_WIDTH, LEVEL_HEIGHT, 10000, [&](int i)
+		{
+			world.BeginFrame();
+			world.Render(consoleBuffer, LEVEL_WIDTH, LEVEL_HEIGHT, (i * 3) % 1024, 60 + (i % 20));
+		});
+	}
+
+	benchmarkSink = consoleBuffer[LEVEL_WIDTH * LEVEL_HEIGHT - 1].glyph;
+}
+
+/// <summary>
+/// Fills some cells with random glyphs and colours, a few glyphs are used a lot so that runs of the same cell and the
+/// see-through glyph both come up often
+/// </summary>
+static void RandomCells(Cell* cells, int count, Random& random)
+{
+	const char glyphs[] = { ' ', ' ', '.', '#', '/', '\\' };
+	for (int i = 0; i < count; i++)
+	{
+		cells[i].glyph = glyphs[random.NextInt((int)sizeof(glyphs))];
+		cells[i].attributes = (uint8_t)random.NextInt(4);
+	}
+}
+
+/// <summary>
+/// Prints a kernel that gave a different answer to the plain version
+/// </summary>
+static void ReportKernelMismatch(const char* kernel, CELL_KERNEL_LEVEL level, int count)
+{
+	fprintf(stderr, "kernel_mismatch,%s,%s,%d\n", kernel, GetCellKernelLevelName(level), count);
+}
+
+/// <summary>
+/// Checks that every version of the cell kernels the cpu can run gives exactly the same answer as the plain one. The lengths
+/// go from nothing up past a few whole registers and start at different places, so the parts before and after the SIMD loops
+/// are covered, and the cells either side are checked to make sure nothing is written past the end.
+/// </summary>
+/// <returns> How many checks gave a different answer </returns>
+static int CheckCellKernels()
+{
+	const int MAX_COUNT = 70;
+	const int GUARD = 4;
+	const int frameWidths[] = { 1, 7, 8, 9, 15, 16, 17, 33, LEVEL_WIDTH, 300 };
+	const int FRAME_HEIGHT = 6;
+	// Out of 100, how many cells change between the two frames
+	const int changeChances[] = { 1, 10, 50, 100 };
+
+	int mismatches = 0;
+	Random random;
+	random.Seed(2, RANDOM_STREAM_EFFECTS);
+	std::vector<Cell> source(MAX_COUNT + GUARD * 2);
+	std::vector<Cell> start(MAX_COUNT + GUARD * 2);
+	std::vector<Cell> expected(MAX_COUNT + GUARD * 2);
+	std::vector<Cell> result(MAX_COUNT + GUARD * 2);
+
+	for (int level = CELL_KERNELS_SSE2; level <= GetBestCellKernelLevel(); level++)
+	{
+		CELL_KERNEL_LEVEL kernelLevel = (CELL_KERNEL_LEVEL)level;
+		for (int count = 0; count <= MAX_COUNT; count++)
+		{
+			for (int offset = 0; offset < GUARD; offset++)
+			{
+				RandomCells(source.data(), (int)source.size(), random);
+				RandomCells(start.data(), (int)start.size(), random);
+				Cell value = source[0];
+
+				expected = start;
+				SetCellKernelLevel(CELL_KERNELS_SCALAR);
+				FillCells(expected.data() + offset, count, value);
+				result = start;
+				SetCellKernelLevel(kernelLevel);
+				FillCells(result.data() + offset, count, value);
+				if (memcmp(expected.data(), result.data(), expected.size() * sizeof(Cell)) != 0)
+				{
+					ReportKernelMismatch("fill_cells", kernelLevel, count);
+					mismatches++;
+				}
+
+				expected = start;
+				SetCellKernelLevel(CELL_KERNELS_SCALAR);
+				BlitCellsKeyed(expected.data() + offset, source.data() + GUARD, count, TRANSPARENT_CHAR);
+				result = start;
+				SetCellKernelLevel(kernelLevel);
+				BlitCellsKeyed(result.data() + offset, source.data() + GUARD, count, TRANSPARENT_CHAR);
+				if (memcmp(expected.data(), result.data(), expected.size() * sizeof(Cell)) != 0)
+				{
+					ReportKernelMismatch("blit_keyed", kernelLevel, count);
+					mismatches++;
+				}
+			}
+		}
+
+		// Two frames with changes scattered over them, the spans, the count and the updated previous frame all have to match
+		for (int width : frameWidths)
+		{
+			for (int changeChance : changeChances)
+			{
+				std::vector<Cell> previous(width * FRAME_HEIGHT);
+				RandomCells(previous.data(), (int)previous.size(), random);
+				std::vector<Cell> current = previous;
+				for (Cell& cell : current)
+				{
+					if (random.NextInt(100) < changeChance)
+					{
+						cell.attributes ^= 8;
+					}
+				}
+
+				std::vector<Cell> expectedPrevious = previous;
+				std::vector<CellSpan> expectedSpans;
+				int expectedChanged = 0;
+				SetCellKernelLevel(CELL_KERNELS_SCALAR);
+				for (int y = 0; y < FRAME_HEIGHT; y++)
+				{
+					expectedChanged += DiffCellRow(current.data() + width * y, expectedPrevious.data() + width * y, width, y, 4, expectedSpans);
+				}
+
+				std::vector<Cell> resultPrevious = previous;
+				std::vector<CellSpan> resultSpans;
+				int resultChanged = 0;
+				SetCellKernelLevel(kernelLevel);
+				for (int y = 0; y < FRAME_HEIGHT; y++)
+				{
+					resultChanged += DiffCellRow(current.data() + width * y, resultPrevious.data() + width * y, width, y, 4, resultSpans);
+				}
+
+				bool sameSpans = expectedSpans.size() == resultSpans.size();
+				for (size_t i = 0; sameSpans && i < expectedSpans.size(); i++)
+				{
+					sameSpans = expectedSpans[i].y == resultSpans[i].y && expectedSpans[i].xStart == resultSpans[i].xStart && expectedSpans[i].xEnd == resultSpans[i].xEnd;
+				}
+				if (!sameSpans || expectedChanged != resultChanged || memcmp(expectedPrevious.data(), resultPrevious.data(), previous.size() * sizeof(Cell)) != 0
+					|| memcmp(resultPrevious.data(), current.data(), current.size() * sizeof(Cell)) != 0)
+				{
+					ReportKernelMismatch("diff_row", kernelLevel, width);
+					mismatches++;
+				}
+			}
+		}
+	}
+
+	SetCellKernelLevel(GetBestCellKernelLevel());
+	return mismatches;
+}
+
+/// <summary>
+/// Times each version of the cell kernels the cpu can run on a whole frame, the fill is a clear, the blit is the background
+/// drawn with its spaces left see-through and the diff is two play frames one after the other
+/// </summary>
+static void RunKernelBenchmarks()
+{
+	for (const FrameSize& size : FRAME_SIZES)
+	{
+		const int w = size.width;
+		const int h = size.height;
+		std::vector<Cell> buffer(w * h);
+		std::vector<Cell> background(w * h);
+		std::string tiled = TileBackground(size);
+		for (int i = 0; i < w * h; i++)
+		{
+			background[i].glyph = tiled[i];
+			background[i].attributes = 7;
+		}
+
+		PlayFrame playFrame;
+		playFrame.Initialise(size);
+		playFrame.Draw(100);
+		std::vector<Cell> frameA = playFrame.buffer;
+		playFrame.Draw(101);
+		std::vector<Cell> frameB = playFrame.buffer;
+		std::vector<Cell> previous = frameA;
+		std::vector<CellSpan> spans;
+		spans.reserve(w * h);
+
+		for (int level = CELL_KERNELS_SCALAR; level <= GetBestCellKernelLevel(); level++)
+		{
+			SetCellKernelLevel((CELL_KERNEL_LEVEL)level);
+			const char* levelName = GetCellKernelLevelName((CELL_KERNEL_LEVEL)level);
+			char name[64];
+
+			snprintf(name, sizeof(name), "fill_cells_%s", levelName);
+			RunBenchmark(name, w, h, IterationsForSize(10000, size), [&](int i)
+			{
+				FillCells(buffer.data(), w * h, Cell{ (char)(i & 1), 0 });
+			});
+			snprintf(name, sizeof(name), "blit_keyed_%s", levelName);
+			RunBenchmark(name, w, h, IterationsForSize(10000, size), [&](int)
+			{
+				BlitCellsKeyed(buffer.data(), background.data(), w * h, TRANSPARENT_CHAR);
+			});
+			snprintf(name, sizeof(name), "diff_frame_%s", levelName);
+			RunBenchmark(name, w, h, IterationsForSize(20000, size), [&](int i)
+			{
+				const Cell* frame = (i & 1) ? frameB.data() : frameA.data();
+				spans.clear();
+				for (int y = 0; y < h; y++)
+				{
+					DiffCellRow(frame + w * y, previous.data() + w * y, w, y, 4, spans);
+				}
+			});
+		}
+		SetCellKernelLevel(GetBestCellKernelLevel());
+		benchmarkSink = buffer[w * h - 1].glyph + (int)spans.size();
+	}
+}
+
+/// <summary>
+/// Compares the results against an earlier run, anything that has got slower by more than the tolerance is printed
+/// </summary>
+/// <param name="path"> The output of an earlier run </param>
+/// <param name="tolerance"> How much slower something can get before it counts, 0.1 is 10% </param>
+/// <returns> How many benchmarks got slower, or -1 if the baseline couldnt be read </returns>
+static int CompareWithBaseline(const char* path, double tolerance)
+{
+	FILE* file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "Couldnt read baseline %s\n", path);
+		return -1;
+	}
+
+	int regressions = 0;
+	char line[512];
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[128];
+		int width = 0;
+		int height = 0;
+		double baselineNs = 0.0;
+		// The header and anything else that isnt a result is skipped
+		if (sscanf(line, "%127[^,],%d,%d,%lf", name, &width, &height, &baselineNs) != 4)
+		{
+			continue;
+		}
+
+		for (const ReportedResult& result : reportedResults)
+		{
+			if (result.name == name && result.width == width && result.height == height && result.bestNs > baselineNs * (1.0 + tolerance))
+			{
+				fprintf(stderr, "regression,%s,%d,%d,%.2f,%.2f\n", name, width, height, baselineNs, result.bestNs);
+				regressions++;
+			}
+		}
+	}
+	fclose(file);
+	return regressions;
+}
+
+/// <summary>
+/// The keys held on each frame of the allocation check, the lander thrusts every other frame so it hovers with the thruster going
+/// on and off, and drifts left and then right so it keeps moving without touching down
+/// </summary>
+static uint16_t FlyingKeys(int frame)
+{
+	uint16_t keyMask = (frame % 2) != 0 ? KEY_MASK_W : 0;
+	return keyMask | ((frame / 120) % 2 == 0 ? KEY_MASK_A : KEY_MASK_D);
+}
+
+/// <summary>
+/// Plays the real game on the headless platform with no sound, from the splash screen in to a few hundred frames of flying over
+/// the level, and checks the flying frames didnt make any heap allocations. The profiler overlay is turned on so that is drawn
+/// as well. The planet isnt checked, its chunks are made on the streaming thread as new ground comes in to view, so when they
+/// allocate depends on how that thread gets scheduled.
+/// </summary>
+/// <returns> 0 if nothing was allocated, 1 if something was, the number of allocations is printed </returns>
+static int CheckGameAllocations()
+{
+	Platform* platform = CreateHeadlessPlatform();
+	Game gameInstance;
+	gameInstance.Initialise(platform, new NullAudioSink(), 1, false);
+
+	// The same as a replay, the clock is moved on and then the update runs with the given keys
+	auto playFrame = [&](uint16_t keyMask)
+	{
+		platform->SleepFor(GAME_FRAME_TIME);
+		gameInstance.SetReplayInput(keyMask);
+		gameInstance.Update(GAME_FRAME_TIME);
+		gameInstance.Draw();
+	};
+
+	// Wait out the splash screen, press enter on the menu to play and then press P for the overlay
+	const int splashFrames = (int)(3.0f / GAME_FRAME_TIME) + 2;
+	for (int frame = 0; frame < splashFrames; frame++)
+	{
+		playFrame(0);
+	}
+	playFrame(KEY_MASK_ENTER);
+	playFrame(0);
+	playFrame(KEY_MASK_P);
+	playFrame(0);
+
+	for (int frame = 0; frame < GAME_WARM_UP_FRAMES; frame++)
+	{
+		playFrame(FlyingKeys(frame));
+	}
+	long long allocationsBefore = allocationCount;
+	for (int frame = GAME_WARM_UP_FRAMES; frame < GAME_WARM_UP_FRAMES + GAME_COUNTED_FRAMES; frame++)
+	{
+		playFrame(FlyingKeys(frame));
+	}
+	long long allocations = allocationCount - allocationsBefore;
+
+	gameInstance.Shutdown();
+	delete platform;
+
+	if (allocations > 0)
+	{
+		fprintf(stderr, "allocations,game,%d,%lld\n", GAME_COUNTED_FRAMES, allocations);
+		return 1;
+	}
+	return 0;
+}
+
+/// <summary>
+/// Times the render path and prints the results as csv. The times are in nanoseconds per call and ns_per_cell divides that by
+/// the size of the buffer. bytes_per_frame is how much console output the presenter made for each frame.
+/// </summary>
+/// <param name="argc"> Number of command line arguments </param>
+/// <param name="argv"> The command line arguments, --samples followed by a number changes how many times each timing is repeated,
+/// --filter followed by some text only runs the benchmarks with it in their name, and --baseline followed by the output of an
+/// earlier run compares against it (--tolerance followed by a fraction sets how much slower counts, 0.1 by default) </param>
+/// <returns> 0 unless one of the SIMD cell kernels disagreed with the plain one, the game allocated while flying, something got
+/// slower than the baseline or the baseline couldnt be read </returns>
+int main(int argc, char* argv[])
+{
+	const char* baselinePath = nullptr;
+	double tolerance = 0.1;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+		{
+			sampleCount = atoi(argv[++i]);
+			sampleCount = sampleCount > 0 ? sampleCount : DEFAULT_SAMPLE_COUNT;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			nameFilter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+		{
+			baselinePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+		{
+			tolerance = atof(argv[++i]);
+		}
+	}
+
+	// A kernel that gives the wrong answer fails the run whatever the timings are, and so does the game allocating every frame
+	int kernelMismatches = CheckCellKernels();
+	int gameAllocated = CheckGameAllocations();
+
+	printf("benchmark,width,height,best_ns,median_ns,ns_per_cell,bytes_per_frame,allocations_per_call\n");
+	RunDrawingBenchmarks();
+	RunFrameBenchmarks();
+	RunGameplayBenchmarks();
+	RunKernelBenchmarks();
+
+	bool passed = kernelMismatches == 0 && gameAllocated == 0;
+	if (baselinePath)
+	{
+		int regressions = CompareWithBaseline(baselinePath, tolerance);
+		passed = passed && regressions == 0;
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Cell.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the cell type that every frame, layer and sprite is made of. It is half the size of the console's
+// CHAR_INFO, and is only turned in to CHAR_INFO or escape codes by the presenter when the frame is sent to the console
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CELL_H
+#define CELL_H
+
+// Includes
+#include <stdint.h>
+
+/// <summary>
+/// One character on the screen. The colour is the same 4 bit console colour the game has always used, the text colour in the
+/// low 4 bits and the background colour in the high 4 bits.
+/// </summary>
+struct Cell
+{
+	char glyph;
+	uint8_t attributes;
+};
+
+// The frame is copied, cleared and compared as whole cells, so there mustnt be any padding in them
+static_assert(sizeof(Cell) == 2, "A cell should be 2 bytes, a glyph and a colour");
+
+/// <summary>
+/// Checks if two cells would look the same on screen
+/// </summary>
+inline bool SameCell(const Cell& a, const Cell& b)
+{
+	return a.glyph == b.glyph && a.attributes == b.attributes;
+}
+
+#endif // !CELL_H
@@ -0,0 +1,421 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: CellKernels.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the plain, SSE2 and AVX2 versions of the cell kernels and picks between them
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "CellKernels.h"
+// Includes
+#include <atomic>
+#include <string.h>
+
+// SSE2 is always there on 64 bit x86 and on 32 bit builds that ask for it, anything else only gets the plain versions
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CELL_KERNELS_USE_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define CELL_KERNELS_USE_SSE2 0
+#endif
+
+// AVX2 isnt something the build can assume, so its versions are built whatever the compiler settings are and only used
+// once the cpu has been checked for it. GCC and clang need telling that those functions are allowed to use it.
+#if CELL_KERNELS_USE_SSE2 && (defined(_MSC_VER) || defined(__GNUC__))
+#define CELL_KERNELS_USE_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define AVX2_FUNCTION
+#else
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#else
+#define CELL_KERNELS_USE_AVX2 0
+#endif
+
+#if CELL_KERNELS_USE_SSE2
+/// <summary>
+/// A cell as the 16 bits the SIMD versions work with, the glyph is the low byte and the colour is the high one
+/// </summary>
+static uint16_t CellBits(Cell cell)
+{
+	uint16_t bits;
+	memcpy(&bits, &cell, sizeof(Cell));
+	return bits;
+}
+
+/// <summary>
+/// Gets the position of the lowest bit that is set, there must be one
+/// </summary>
+static int LowestSetBit(unsigned int bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+#endif
+
+/// <summary>
+/// Finds the runs of changed cells, this is the same for every version and only the searching for the start and end of
+/// each run is done differently. The finder has NextChanged and NextSame, which give the first cell from x onwards that is
+/// different from (or the same as) the previous frame, or the width if there isnt one.
+/// </summary>
+template <typename FINDER>
+static int DiffRowWith(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans)
+{
+	int changedCells = 0;
+	int x = FINDER::NextChanged(row, previousRow, 0, width);
+	while (x < width)
+	{
+		// Find the end of this run of changed cells, then the previous frame can be brought up to date all at once
+		int start = x;
+		x = FINDER::NextSame(row, previousRow, x, width);
+		memcpy(previousRow + start, row + start, (x - start) * sizeof(Cell));
+
+		// Join it on to the previous span if the gap is small enough
+		if (!spans.empty() && spans.back().y == y && start - spans.back().xEnd <= mergeGap)
+		{
+			changedCells += x - spans.back().xEnd;
+			spans.back().xEnd = x;
+		}
+		else
+		{
+			spans.push_back({ y, start, x });
+			changedCells += x - start;
+		}
+
+		x = FINDER::NextChanged(row, previousRow, x, width);
+	}
+	return changedCells;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Plain versions, these are what the others are checked against
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void FillCellsScalar(Cell* cells, int count, Cell value)
+{
+	for (int i = 0; i < count; i++)
+	{
+		cells[i] = value;
+	}
+}
+
+static void BlitCellsKeyedScalar(Cell* destination, const Cell* source, int count, char keyGlyph)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (source[i].glyph != keyGlyph)
+		{
+			destination[i] = source[i];
+		}
+	}
+}
+
+struct ScalarFinder
+{
+	static int NextChanged(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		while (x < width && SameCell(row[x], previousRow[x]))
+		{
+			x++;
+		}
+		return x;
+	}
+
+	static int NextSame(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		while (x < width && !SameCell(row[x], previousRow[x]))
+		{
+			x++;
+		}
+		return x;
+	}
+};
+
+static int DiffCellRowScalar(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans)
+{
+	return DiffRowWith<ScalarFinder>(row, previousRow, width, y, mergeGap, spans);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2 versions, 8 cells at a time with the plain loop doing whatever is left over at the end
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if CELL_KERNELS_USE_SSE2
+static void FillCellsSse2(Cell* cells, int count, Cell value)
+{
+	const __m128i values = _mm_set1_epi16((short)CellBits(value));
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm_storeu_si128((__m128i*)(cells + i), values);
+	}
+	FillCellsScalar(cells + i, count - i, value);
+}
+
+static void BlitCellsKeyedSse2(Cell* destination, const Cell* source, int count, char keyGlyph)
+{
+	// Only the glyph byte of each cell is compared, a matching cell gives all 16 bits set which picks what was already there
+	const __m128i glyphBits = _mm_set1_epi16(0x00FF);
+	const __m128i key = _mm_set1_epi16((short)(unsigned char)keyGlyph);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i drawn = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i behind = _mm_loadu_si128((const __m128i*)(destination + i));
+		__m128i seeThrough = _mm_cmpeq_epi16(_mm_and_si128(drawn, glyphBits), key);
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_or_si128(_mm_and_si128(seeThrough, behind), _mm_andnot_si128(seeThrough, drawn)));
+	}
+	BlitCellsKeyedScalar(destination + i, source + i, count - i, keyGlyph);
+}
+
+struct Sse2Finder
+{
+	/// <summary>
+	/// Gets 2 bits per cell, both set if the cell is the same as the previous frame
+	/// </summary>
+	static unsigned int SameBits(const Cell* row, const Cell* previousRow, int x)
+	{
+		__m128i current = _mm_loadu_si128((const __m128i*)(row + x));
+		__m128i previous = _mm_loadu_si128((const __m128i*)(previousRow + x));
+		return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi16(current, previous));
+	}
+
+	static int NextChanged(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		for (; x + 8 <= width; x += 8)
+		{
+			unsigned int changed = ~SameBits(row, previousRow, x) & 0xFFFFu;
+			if (changed != 0)
+			{
+				return x + LowestSetBit(changed) / 2;
+			}
+		}
+		return ScalarFinder::NextChanged(row, previousRow, x, width);
+	}
+
+	static int NextSame(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		for (; x + 8 <= width; x += 8)
+		{
+			unsigned int same = SameBits(row, previousRow, x);
+			if (same != 0)
+			{
+				return x + LowestSetBit(same) / 2;
+			}
+		}
+		return ScalarFinder::NextSame(row, previousRow, x, width);
+	}
+};
+
+static int DiffCellRowSse2(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans)
+{
+	return DiffRowWith<Sse2Finder>(row, previousRow, width, y, mergeGap, spans);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2 versions, 16 cells at a time with the SSE2 ones doing what is left over
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if CELL_KERNELS_USE_AVX2
+AVX2_FUNCTION static void FillCellsAvx2(Cell* cells, int count, Cell value)
+{
+	const __m256i values = _mm256_set1_epi16((short)CellBits(value));
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		_mm256_storeu_si256((__m256i*)(cells + i), values);
+	}
+	FillCellsSse2(cells + i, count - i, value);
+}
+
+AVX2_FUNCTION static void BlitCellsKeyedAvx2(Cell* destination, const Cell* source, int count, char keyGlyph)
+{
+	const __m256i glyphBits = _mm256_set1_epi16(0x00FF);
+	const __m256i key = _mm256_set1_epi16((short)(unsigned char)keyGlyph);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i drawn = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i behind = _mm256_loadu_si256((const __m256i*)(destination + i));
+		__m256i seeThrough = _mm256_cmpeq_epi16(_mm256_and_si256(drawn, glyphBits), key);
+		_mm256_storeu_si256((__m256i*)(destination + i), _mm256_blendv_epi8(drawn, behind, seeThrough));
+	}
+	BlitCellsKeyedSse2(destination + i, source + i, count - i, keyGlyph);
+}
+
+struct Avx2Finder
+{
+	AVX2_FUNCTION static unsigned int SameBits(const Cell* row, const Cell* previousRow, int x)
+	{
+		__m256i current = _mm256_loadu_si256((const __m256i*)(row + x));
+		__m256i previous = _mm256_loadu_si256((const __m256i*)(previousRow + x));
+		return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi16(current, previous));
+	}
+
+	AVX2_FUNCTION static int NextChanged(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		for (; x + 16 <= width; x += 16)
+		{
+			unsigned int changed = ~SameBits(row, previousRow, x);
+			if (changed != 0)
+			{
+				return x + LowestSetBit(changed) / 2;
+			}
+		}
+		return Sse2Finder::NextChanged(row, previousRow, x, width);
+	}
+
+	AVX2_FUNCTION static int NextSame(const Cell* row, const Cell* previousRow, int x, int width)
+	{
+		for (; x + 16 <= width; x += 16)
+		{
+			unsigned int same = SameBits(row, previousRow, x);
+			if (same != 0)
+			{
+				return x + LowestSetBit(same) / 2;
+			}
+		}
+		return Sse2Finder::NextSame(row, previousRow, x, width);
+	}
+};
+
+static int DiffCellRowAvx2(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans)
+{
+	return DiffRowWith<Avx2Finder>(row, previousRow, width, y, mergeGap, spans);
+}
+
+/// <summary>
+/// Checks that the cpu has AVX2 and that the operating system saves the registers it uses
+/// </summary>
+static bool CpuHasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	// OSXSAVE and AVX, then the operating system has to have turned on saving the SSE and AVX registers
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Picking a version
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// The functions for one version of the kernels
+/// </summary>
+struct CellKernelTable
+{
+	void (*fill)(Cell* cells, int count, Cell value);
+	void (*blitKeyed)(Cell* destination, const Cell* source, int count, char keyGlyph);
+	int (*diffRow)(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans);
+};
+
+// A version that wasnt built uses the plain functions, GetBestCellKernelLevel never picks it anyway
+static const CellKernelTable KERNEL_TABLES[CELL_KERNEL_LEVEL_COUNT] = {
+	{ FillCellsScalar, BlitCellsKeyedScalar, DiffCellRowScalar },
+#if CELL_KERNELS_USE_SSE2
+	{ FillCellsSse2, BlitCellsKeyedSse2, DiffCellRowSse2 },
+#else
+	{ FillCellsScalar, BlitCellsKeyedScalar, DiffCellRowScalar },
+#endif
+#if CELL_KERNELS_USE_AVX2
+	{ FillCellsAvx2, BlitCellsKeyedAvx2, DiffCellRowAvx2 },
+#else
+	{ FillCellsScalar, BlitCellsKeyedScalar, DiffCellRowScalar },
+#endif
+};
+
+static const char* const KERNEL_LEVEL_NAMES[CELL_KERNEL_LEVEL_COUNT] = { "scalar", "sse2", "avx2" };
+
+// The version being used, this is worked out on first use as nothing else can be relied on to have run before then
+static std::atomic<const CellKernelTable*> activeKernels{ nullptr };
+
+/// <summary>
+/// Gets the functions for the version being used
+/// </summary>
+static const CellKernelTable& ActiveKernels()
+{
+	const CellKernelTable* kernels = activeKernels.load(std::memory_order_relaxed);
+	if (!kernels)
+	{
+		kernels = &KERNEL_TABLES[GetBestCellKernelLevel()];
+		activeKernels.store(kernels, std::memory_order_relaxed);
+	}
+	return *kernels;
+}
+
+void FillCells(Cell* cells, int count, Cell value)
+{
+	ActiveKernels().fill(cells, count, value);
+}
+
+void BlitCellsKeyed(Cell* destination, const Cell* source, int count, char keyGlyph)
+{
+	ActiveKernels().blitKeyed(destination, source, count, keyGlyph);
+}
+
+int DiffCellRow(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans)
+{
+	return ActiveKernels().diffRow(row, previousRow, width, y, mergeGap, spans);
+}
+
+CELL_KERNEL_LEVEL GetBestCellKernelLevel()
+{
+#if CELL_KERNELS_USE_AVX2
+	static const bool hasAvx2 = CpuHasAvx2();
+	if (hasAvx2)
+	{
+		return CELL_KERNELS_AVX2;
+	}
+#endif
+#if CELL_KERNELS_USE_SSE2
+	return CELL_KERNELS_SSE2;
+#else
+	return CELL_KERNELS_SCALAR;
+#endif
+}
+
+CELL_KERNEL_LEVEL GetCellKernelLevel()
+{
+	return (CELL_KERNEL_LEVEL)(&ActiveKernels() - KERNEL_TABLES);
+}
+
+bool SetCellKernelLevel(CELL_KERNEL_LEVEL level)
+{
+	if (level < 0 || level > GetBestCellKernelLevel())
+	{
+		return false;
+	}
+	activeKernels.store(&KERNEL_TABLES[level], std::memory_order_relaxed);
+	return true;
+}
+
+const char* GetCellKernelLevelName(CELL_KERNEL_LEVEL level)
+{
+	return (level >= 0 && level < CELL_KERNEL_LEVEL_COUNT) ? KERNEL_LEVEL_NAMES[level] : "unknown";
+}
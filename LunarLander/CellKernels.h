@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: CellKernels.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the loops that go over whole rows of cells (filling, blitting with a see-through glyph and comparing
+// against the last frame). Each one has a plain version and SSE2 and AVX2 ones, the best one the cpu has is picked when the
+// program starts.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CELL_KERNELS_H
+#define CELL_KERNELS_H
+
+// Includes
+#include "Cell.h"
+#include <vector>
+
+/// <summary>
+/// A run of changed cells on a single row, xStart is the first cell and xEnd is one past the last one
+/// </summary>
+struct CellSpan
+{
+	int y;
+	int xStart;
+	int xEnd;
+};
+
+/// <summary>
+/// Which version of the kernels is being used, each one does 2 bytes per cell so SSE2 does 8 cells at a time and AVX2 does 16
+/// </summary>
+enum CELL_KERNEL_LEVEL
+{
+	CELL_KERNELS_SCALAR,
+	CELL_KERNELS_SSE2,
+	CELL_KERNELS_AVX2,
+	CELL_KERNEL_LEVEL_COUNT
+};
+
+/// <summary>
+/// Sets every cell to the same value
+/// </summary>
+/// <param name="cells"> The first cell to set </param>
+/// <param name="count"> How many cells to set </param>
+/// <param name="value"> What to set them to </param>
+void FillCells(Cell* cells, int count, Cell value);
+
+/// <summary>
+/// Copies cells over the top of others, a cell with the key glyph is see-through and leaves what was under it
+/// </summary>
+/// <param name="destination"> The cells to draw over </param>
+/// <param name="source"> The cells to draw </param>
+/// <param name="count"> How many cells to draw </param>
+/// <param name="keyGlyph"> The glyph that isnt drawn, the colour of the cell doesnt matter </param>
+void BlitCellsKeyed(Cell* destination, const Cell* source, int count, char keyGlyph);
+
+/// <summary>
+/// Finds the runs of cells on a row that are different from the last frame and adds them on to the spans, a run that starts
+/// mergeGap cells or less after the last span on the same row is joined on to it. The previous row is updated to match.
+/// </summary>
+/// <param name="row"> The row of the frame being presented </param>
+/// <param name="previousRow"> The same row of the last frame, it is the same as row afterwards </param>
+/// <param name="width"> How many cells are in the row </param>
+/// <param name="y"> Which row it is, this goes in to the spans </param>
+/// <param name="mergeGap"> The biggest gap between two runs that still gets them joined </param>
+/// <param name="spans"> The spans are added on to the end of this </param>
+/// <returns> How many cells the new spans cover, including any gaps that were joined over </returns>
+int DiffCellRow(const Cell* row, Cell* previousRow, int width, int y, int mergeGap, std::vector<CellSpan>& spans);
+
+/// <summary>
+/// Gets the fastest version of the kernels the cpu can run
+/// </summary>
+CELL_KERNEL_LEVEL GetBestCellKernelLevel();
+
+/// <summary>
+/// Gets the version of the kernels that is being used, this is the best one unless SetCellKernelLevel has been called
+/// </summary>
+CELL_KERNEL_LEVEL GetCellKernelLevel();
+
+/// <summary>
+/// Changes which version of the kernels is used, this is for comparing them against each other in the benchmark
+/// </summary>
+/// <param name="level"> The version to use </param>
+/// <returns> False if the cpu cant run that version, the one being used is left as it was </returns>
+bool SetCellKernelLevel(CELL_KERNEL_LEVEL level);
+
+/// <summary>
+/// Gets the name of a version of the kernels, such as "sse2"
+/// </summary>
+const char* GetCellKernelLevelName(CELL_KERNEL_LEVEL level);
+
+#endif // !CELL_KERNELS_H
@@ -0,0 +1,501 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: ChunkWorld.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the planet generator and the chunked world
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "ChunkWorld.h"
+
+// Includes
+#include "CellKernels.h"
+#include <math.h>
+#include <string.h>
+
+// The hills are made of noise at these wavelengths (in columns), the longest one has to fit around the planet a whole number of times
+static const int HILL_WAVELENGTHS[] = { 512, 128, 32, 8 };
+static const float HILL_AMOUNTS[] = { 0.5f, 0.3f, 0.15f, 0.05f };
+// The hills stay between this many rows from the top and the bottom of the planet, there is always room above them to fly
+const int SKY_ROWS = 24;
+const int BEDROCK_ROWS = 8;
+
+// Each stretch of this many columns can have one platform in it
+const int PAD_SPACING = 32;
+const int PAD_MIN_WIDTH = 5;
+const int PAD_MAX_WIDTH = 8;
+
+// How far above the ground the fuel pickups float, in rows. The sky is always taller than this.
+const int PICKUP_MIN_HEIGHT = 3;
+const int PICKUP_MAX_HEIGHT = 12;
+
+/// <summary>
+/// Scrambles a number so that numbers next to each other give completely different results, this is the end of SplitMix64
+/// </summary>
+static uint64_t MixBits(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+void PlanetGenerator::Initialise(const PlanetSettings& planetSettings)
+{
+	seed = planetSettings.seed;
+	int chunksAcross = planetSettings.widthInChunks < 8 ? 8 : (planetSettings.widthInChunks + 7) & ~7;
+	int chunksDown = planetSettings.heightInChunks < 1 ? 1 : planetSettings.heightInChunks;
+	width = chunksAcross * CHUNK_SIZE;
+	height = chunksDown * CHUNK_SIZE;
+}
+
+float PlanetGenerator::GetNoise(int worldX, int wavelength) const
+{
+	// A random value at every wavelength, blended smoothly in between. The points wrap around with the planet.
+	const int points = width / wavelength;
+	int point = worldX / wavelength;
+	float along = (float)(worldX - point * wavelength) / wavelength;
+	float left = (float)(MixBits(seed ^ ((uint64_t)wavelength << 40) ^ (uint64_t)point) >> 40) / 16777216.0f;
+	float right = (float)(MixBits(seed ^ ((uint64_t)wavelength << 40) ^ (uint64_t)((point + 1) % points)) >> 40) / 16777216.0f;
+	along = along * along * (3.0f - 2.0f * along);
+	return left + (right - left) * along;
+}
+
+int PlanetGenerator::GetHillRow(int worldX) const
+{
+	float amount = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		amount += GetNoise(worldX, HILL_WAVELENGTHS[i]) * HILL_AMOUNTS[i];
+	}
+	int highest = SKY_ROWS;
+	int lowest = height - BEDROCK_ROWS;
+	return highest + (int)(amount * (lowest - highest));
+}
+
+bool PlanetGenerator::FindPad(int worldX, int& padStart, int& multiplier) const
+{
+	// Each stretch decides for itself if it has a platform and where, so a column only ever has to look at its own stretch
+	int stretch = worldX / PAD_SPACING;
+	uint64_t bits = MixBits(seed ^ 0x9e3779b97f4a7c15ULL ^ (uint64_t)stretch);
+	if ((bits & 3) == 0)
+	{
+		return false;
+	}
+	int padWidth = PAD_MIN_WIDTH + (int)((bits >> 8) % (PAD_MAX_WIDTH - PAD_MIN_WIDTH + 1));
+	padStart = stretch * PAD_SPACING + 2 + (int)((bits >> 16) % (PAD_SPACING - PAD_MAX_WIDTH - 4));
+	multiplier = ((bits >> 24) & 3) == 0 ? 4 : 2;
+	return worldX >= padStart && worldX < padStart + padWidth;
+}
+
+int PlanetGenerator::GetSurfaceRow(int worldX) const
+{
+	// Platforms are as high as the hill where they start, all the way across
+	int padStart;
+	int multiplier;
+	return FindPad(worldX, padStart, multiplier) ? GetHillRow(padStart) : GetHillRow(worldX);
+}
+
+int PlanetGenerator::GetPadMultiplier(int worldX) const
+{
+	int padStart;
+	int multiplier;
+	return FindPad(worldX, padStart, multiplier) ? multiplier : 0;
+}
+
+void PlanetGenerator::GetPickup(int chunkColumn, int& worldX, int& worldY) const
+{
+	// Like the platforms each column of chunks decides for itself, so a pickup can be found without generating anything
+	uint64_t bits = MixBits(seed ^ 0xd1b54a32d192ed03ULL ^ (uint64_t)chunkColumn);
+	worldX = chunkColumn * CHUNK_SIZE + (int)(bits % CHUNK_SIZE);
+	worldY = GetSurfaceRow(worldX) - PICKUP_MIN_HEIGHT - (int)((bits >> 16) % (PICKUP_MAX_HEIGHT - PICKUP_MIN_HEIGHT + 1));
+}
+
+void PlanetGenerator::Generate(Chunk& chunk) const
+{
+	const int firstColumn = chunk.chunkX * CHUNK_SIZE;
+	const int firstRow = chunk.chunkY * CHUNK_SIZE;
+
+	for (int x = 0; x < CHUNK_SIZE; x++)
+	{
+		int worldX = firstColumn + x;
+		int here = GetSurfaceRow(worldX);
+		int left = GetSurfaceRow((worldX + width - 1) % width);
+		int right = GetSurfaceRow((worldX + 1) % width);
+		int padStart;
+		int multiplier;
+		bool isPad = FindPad(worldX, padStart, multiplier);
+
+		// The ground is drawn as an outline like the built in level, a slope character on the surface and a wall going down to
+		// whichever side is lower so there are never any gaps in it
+		char surface;
+		if (isPad)
+		{
+			surface = '_';
+		}
+		else if (right < left)
+		{
+			surface = '/';
+		}
+		else if (right > left)
+		{
+			surface = '\\';
+		}
+		else
+		{
+			surface = left > here ? '^' : (left < here ? 'v' : '-');
+		}
+		int wallBottom = (left > right ? left : right) - 1;
+
+		for (int y = 0; y < CHUNK_SIZE; y++)
+		{
+			int worldY = firstRow + y;
+			char character = ' ';
+			if (worldY == here)
+			{
+				character = surface;
+			}
+			else if (worldY > here && worldY <= wallBottom)
+			{
+				character = '|';
+			}
+			else if (isPad && worldY == here + 1 && worldX > padStart && worldX - padStart < 3)
+			{
+				// The multiplier is written under the platform the same as it is in the built in level
+				character = worldX == padStart + 1 ? 'X' : (char)('0' + multiplier);
+			}
+			else if (worldY < here)
+			{
+				// A few stars in the sky
+				uint64_t star = MixBits(seed ^ ((uint64_t)worldY << 32) ^ (uint64_t)worldX);
+				character = (star & 255) == 0 ? '*' : ((star & 255) == 1 ? '.' : ' ');
+			}
+
+			int cell = x + CHUNK_SIZE * y;
+			chunk.cells[cell].glyph = character;
+			chunk.cells[cell].attributes = 7;
+			// The same rules as a level file
+			if (character == '_')
+			{
+				chunk.mask[cell] = TERRAIN_PAD;
+			}
+			else if (character == ' ' || character == '*' || character == '.')
+			{
+				chunk.mask[cell] = TERRAIN_EMPTY;
+			}
+			else
+			{
+				chunk.mask[cell] = TERRAIN_SOLID;
+			}
+		}
+	}
+}
+
+ChunkWorld::~ChunkWorld()
+{
+	Shutdown();
+}
+
+void ChunkWorld::Initialise(const PlanetSettings& planetSettings)
+{
+	Shutdown();
+
+	settings = planetSettings;
+	settings.cacheSize = settings.cacheSize < 1 ? 1 : settings.cacheSize;
+	generator.Initialise(settings);
+	width = generator.GetWidth();
+	height = generator.GetHeight();
+	cache.reserve(settings.cacheSize);
+	pickupCollected.assign(width / CHUNK_SIZE, 0);
+
+	stopping = false;
+	streamer = std::thread(&ChunkWorld::StreamerLoop, this);
+}
+
+void ChunkWorld::Shutdown()
+{
+	if (streamer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			pendingRequests.clear();
+		}
+		requestQueued.notify_one();
+		streamer.join();
+	}
+
+	finished.clear();
+	cache.clear();
+	lookup.clear();
+	requested.clear();
+	lastChunk = nullptr;
+}
+
+void ChunkWorld::BeginFrame()
+{
+	useClock++;
+
+	std::vector<std::unique_ptr<Chunk>> arrived;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		arrived.swap(finished);
+	}
+	for (std::unique_ptr<Chunk>& chunk : arrived)
+	{
+		uint64_t key = MakeKey(chunk->chunkX, chunk->chunkY);
+		requested.erase(key);
+		// It might have been generated on the game thread while it was waiting, then this copy isnt needed
+		if (lookup.find(key) == lookup.end())
+		{
+			Insert(std::move(chunk));
+		}
+	}
+}
+
+bool ChunkWorld::Render(Cell* target, int viewWidth, int viewHeight, int cameraX, int cameraY)
+{
+	bool complete = true;
+	const int firstChunkX = (int)floorf((float)cameraX / CHUNK_SIZE);
+	const int lastChunkX = (int)floorf((float)(cameraX + viewWidth - 1) / CHUNK_SIZE);
+	const int firstChunkY = (int)floorf((float)cameraY / CHUNK_SIZE);
+	const int lastChunkY = (int)floorf((float)(cameraY + viewHeight - 1) / CHUNK_SIZE);
+	const int chunksDown = height / CHUNK_SIZE;
+
+	for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++)
+	{
+		for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++)
+		{
+			// The part of this chunk that is in the view
+			int left = chunkX * CHUNK_SIZE > cameraX ? chunkX * CHUNK_SIZE : cameraX;
+			int right = (chunkX + 1) * CHUNK_SIZE < cameraX + viewWidth ? (chunkX + 1) * CHUNK_SIZE : cameraX + viewWidth;
+			int top = chunkY * CHUNK_SIZE > cameraY ? chunkY * CHUNK_SIZE : cameraY;
+			int bottom = (chunkY + 1) * CHUNK_SIZE < cameraY + viewHeight ? (chunkY + 1) * CHUNK_SIZE : cameraY + viewHeight;
+
+			Chunk* chunk = nullptr;
+			if (chunkY >= 0 && chunkY < chunksDown)
+			{
+				chunk = GetChunk(chunkX, chunkY, false);
+				if (!chunk)
+				{
+					Request(chunkX, chunkY);
+					complete = false;
+				}
+			}
+
+			for (int y = top; y < bottom; y++)
+			{
+				Cell* row = target + (left - cameraX) + viewWidth * (y - cameraY);
+				if (chunk)
+				{
+					memcpy(row, chunk->cells + (left - chunkX * CHUNK_SIZE) + CHUNK_SIZE * (y - chunkY * CHUNK_SIZE), (right - left) * sizeof(Cell));
+				}
+				else
+				{
+					// Not here yet, or outside the planet
+					FillCells(row, right - left, Cell{ ' ', 7 });
+				}
+			}
+		}
+	}
+
+	// Get the chunks around the view ready, so they are already here when the camera gets to them
+	for (int chunkY = firstChunkY - 1; chunkY <= lastChunkY + 1; chunkY++)
+	{
+		for (int chunkX = firstChunkX - 1; chunkX <= lastChunkX + 1; chunkX++)
+		{
+			if (chunkY >= 0 && chunkY < chunksDown)
+			{
+				Request(chunkX, chunkY);
+			}
+		}
+	}
+	return complete;
+}
+
+LANDING_RESULT ChunkWorld::CheckLanding(int cellX, int cellY, float velocityY)
+{
+	int legX = cellX + (Player::WIDTH - 3);
+	int legY = cellY + (Player::HEIGHT - 1);
+	uint8_t left = GetMask(legX, legY);
+	uint8_t right = GetMask(legX + 1, legY);
+	if (left == TERRAIN_PAD && right == TERRAIN_PAD && velocityY > -0.2f)
+	{
+		return LANDING_LANDED;
+	}
+	return (left | right) != TERRAIN_EMPTY ? LANDING_CRASHED : LANDING_NONE;
+}
+
+TerrainContact ChunkWorld::SweepLander(float fromX, float fromY, float toX, float toY, float velocityY)
+{
+	// Chunks dont have a distance field, so there is never any clearance to jump
+	TerrainContact contact = SweepCells(fromX, fromY, toX, toY, width,
+		[this, velocityY](int cellX, int cellY) { return CheckLanding(cellX, cellY, velocityY); },
+		[](int, int) { return 0; });
+	if (contact.result != LANDING_NONE)
+	{
+		contact.surface = GetSurface((int)contact.xPos, (int)contact.yPos);
+	}
+	return contact;
+}
+
+int ChunkWorld::GetLandingScore(int cellX, int cellY) const
+{
+	// Only the left leg needs looking at, a lander can only land with both legs on the same platform
+	(void)cellY;
+	return BASE_SCORE * generator.GetPadMultiplier(WrapX(cellX + (Player::WIDTH - 3)));
+}
+
+int ChunkWorld::GetAltitude(int cellX, int cellY)
+{
+	int legX = cellX + (Player::WIDTH - 3);
+	int legY = cellY + (Player::HEIGHT - 1);
+	for (int row = legY; row < height; row++)
+	{
+		if (GetMask(legX, row) != TERRAIN_EMPTY || GetMask(legX + 1, row) != TERRAIN_EMPTY)
+		{
+			return row - legY;
+		}
+	}
+	return height - legY;
+}
+
+bool ChunkWorld::GetPickup(int chunkColumn, int& worldX, int& worldY) const
+{
+	generator.GetPickup(chunkColumn, worldX, worldY);
+	return !pickupCollected[chunkColumn];
+}
+
+bool ChunkWorld::CollectPickupAt(int cellX, int cellY)
+{
+	int worldX = WrapX(cellX);
+	int chunkColumn = worldX / CHUNK_SIZE;
+	int pickupX;
+	int pickupY;
+	if (!GetPickup(chunkColumn, pickupX, pickupY) || pickupX != worldX || pickupY != cellY)
+	{
+		return false;
+	}
+	pickupCollected[chunkColumn] = 1;
+	return true;
+}
+
+Chunk* ChunkWorld::GetChunk(int chunkX, int chunkY, bool generateIfMissing)
+{
+	chunkX = ((chunkX % (width / CHUNK_SIZE)) + width / CHUNK_SIZE) % (width / CHUNK_SIZE);
+	if (lastChunk && lastChunk->chunkX == chunkX && lastChunk->chunkY == chunkY)
+	{
+		lastChunk->lastUsed = useClock;
+		return lastChunk;
+	}
+
+	std::unordered_map<uint64_t, Chunk*>::iterator found = lookup.find(MakeKey(chunkX, chunkY));
+	if (found != lookup.end())
+	{
+		lastChunk = found->second;
+		lastChunk->lastUsed = useClock;
+		return lastChunk;
+	}
+	if (!generateIfMissing)
+	{
+		return nullptr;
+	}
+
+	// The physics cant wait for the streaming thread, and the result has to be the same whether it had got to it or not
+	std::unique_ptr<Chunk> chunk(new Chunk());
+	chunk->chunkX = chunkX;
+	chunk->chunkY = chunkY;
+	generator.Generate(*chunk);
+	lastChunk = Insert(std::move(chunk));
+	return lastChunk;
+}
+
+uint8_t ChunkWorld::GetMask(int worldX, int worldY)
+{
+	if (worldY < 0 || worldY >= height)
+	{
+		return TERRAIN_EMPTY;
+	}
+	worldX = WrapX(worldX);
+	Chunk* chunk = GetChunk(worldX / CHUNK_SIZE, worldY / CHUNK_SIZE, true);
+	return chunk->mask[(worldX % CHUNK_SIZE) + CHUNK_SIZE * (worldY % CHUNK_SIZE)];
+}
+
+TERRAIN_TYPE ChunkWorld::GetSurface(int cellX, int cellY)
+{
+	int legX = cellX + (Player::WIDTH - 3);
+	int legY = cellY + (Player::HEIGHT - 1);
+	return (GetMask(legX, legY) == TERRAIN_SOLID || GetMask(legX + 1, legY) == TERRAIN_SOLID) ? TERRAIN_SOLID : TERRAIN_PAD;
+}
+
+void ChunkWorld::Request(int chunkX, int chunkY)
+{
+	chunkX = ((chunkX % (width / CHUNK_SIZE)) + width / CHUNK_SIZE) % (width / CHUNK_SIZE);
+	uint64_t key = MakeKey(chunkX, chunkY);
+	if (lookup.find(key) != lookup.end() || !requested.insert(key).second)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingRequests.push_back(key);
+	}
+	requestQueued.notify_one();
+}
+
+Chunk* ChunkWorld::Insert(std::unique_ptr<Chunk> chunk)
+{
+	chunk->lastUsed = useClock;
+	generatedCount++;
+
+	if ((int)cache.size() < settings.cacheSize)
+	{
+		cache.push_back(std::move(chunk));
+		lookup[MakeKey(cache.back()->chunkX, cache.back()->chunkY)] = cache.back().get();
+		return cache.back().get();
+	}
+
+	// The cache is only a few dozen chunks so looking through all of them for the oldest is quicker than keeping them in order
+	size_t oldest = 0;
+	for (size_t i = 1; i < cache.size(); i++)
+	{
+		if (cache[i]->lastUsed < cache[oldest]->lastUsed)
+		{
+			oldest = i;
+		}
+	}
+	lookup.erase(MakeKey(cache[oldest]->chunkX, cache[oldest]->chunkY));
+	if (lastChunk == cache[oldest].get())
+	{
+		lastChunk = nullptr;
+	}
+	cache[oldest] = std::move(chunk);
+	lookup[MakeKey(cache[oldest]->chunkX, cache[oldest]->chunkY)] = cache[oldest].get();
+	return cache[oldest].get();
+}
+
+void ChunkWorld::StreamerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		requestQueued.wait(lock, [this] { return !pendingRequests.empty() || stopping; });
+		if (stopping)
+		{
+			break;
+		}
+
+		uint64_t key = pendingRequests.front();
+		pendingRequests.pop_front();
+		lock.unlock();
+
+		// Generating is the slow part, so it is done without holding the lock
+		std::unique_ptr<Chunk> chunk(new Chunk());
+		chunk->chunkX = (int)(uint32_t)key;
+		chunk->chunkY = (int)(uint32_t)(key >> 32);
+		generator.Generate(*chunk);
+
+		lock.lock();
+		finished.push_back(std::move(chunk));
+	}
+}
@@ -0,0 +1,262 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: ChunkWorld.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the chunked world used for planets. The planet is far too big to keep in memory, so it is made
+// out of square chunks that are generated from the seed when they are needed. Chunks near the camera are generated on a
+// background thread before they come in to view, and only a fixed number of them are kept, the least recently used chunk
+// is thrown away to make room. Everything per frame only looks at the chunks in the view, so the size of the planet
+// doesnt change how long a frame takes.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHUNK_WORLD_H
+#define CHUNK_WORLD_H
+
+// Includes
+#include "Platform.h"
+#include "TerrainIndex.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The width and height of a chunk in cells
+const int CHUNK_SIZE = 64;
+// How many chunks are kept in memory by default, this is enough for the view and a ring of chunks around it
+const int DEFAULT_CHUNK_CACHE_SIZE = 64;
+
+/// <summary>
+/// How a planet is made, the same settings always give the same planet
+/// </summary>
+struct PlanetSettings
+{
+	uint64_t seed = 1;
+	// How big the planet is in chunks, it wraps around going across and has a top and a bottom going down. The width is
+	// rounded up to a multiple of 8 so the longest hills fit around it a whole number of times.
+	int widthInChunks = 256;
+	int heightInChunks = 3;
+	// The most chunks that are kept in memory at once
+	int cacheSize = DEFAULT_CHUNK_CACHE_SIZE;
+};
+
+/// <summary>
+/// A square piece of the planet
+/// </summary>
+struct Chunk
+{
+	// Which chunk this is, in chunks rather than cells
+	int chunkX = 0;
+	int chunkY = 0;
+	// The cells ready to be copied to the screen, and the TERRAIN_TYPE of each one for collision
+	Cell cells[CHUNK_SIZE * CHUNK_SIZE];
+	uint8_t mask[CHUNK_SIZE * CHUNK_SIZE];
+	// When the chunk was last used, the one used longest ago is thrown away when the cache is full
+	uint64_t lastUsed = 0;
+};
+
+/// <summary>
+/// Works out what is in any part of a planet from its seed, without needing anything around it. This is what lets the chunks
+/// be made in any order on any thread.
+/// </summary>
+class PlanetGenerator
+{
+public:
+	void Initialise(const PlanetSettings& planetSettings);
+
+	/// <summary>
+	/// The row the ground is on in a column, platforms are flat so every column of one gives the same row
+	/// </summary>
+	int GetSurfaceRow(int worldX) const;
+
+	/// <summary>
+	/// What landing on the platform in this column multiplies the score by
+	/// </summary>
+	/// <returns> The multiplier, or 0 if there isnt a platform in this column </returns>
+	int GetPadMultiplier(int worldX) const;
+
+	/// <summary>
+	/// Where the fuel pickup for a column of chunks is, there is one somewhere above the ground in every column of chunks
+	/// </summary>
+	void GetPickup(int chunkColumn, int& worldX, int& worldY) const;
+
+	/// <summary>
+	/// Fills in the cells and collision mask of a chunk, the chunk's position has to be set first
+	/// </summary>
+	void Generate(Chunk& chunk) const;
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+
+private:
+	/// <summary>
+	/// Finds the platform that a column is part of
+	/// </summary>
+	/// <returns> False if the column isnt part of a platform </returns>
+	bool FindPad(int worldX, int& padStart, int& multiplier) const;
+
+	/// <summary>
+	/// The height of the hills before the platforms are flattened in to them
+	/// </summary>
+	int GetHillRow(int worldX) const;
+
+	/// <summary>
+	/// Smooth noise from 0 to 1 that repeats every time it goes around the planet
+	/// </summary>
+	float GetNoise(int worldX, int wavelength) const;
+
+	uint64_t seed = 0;
+	int width = 0;
+	int height = 0;
+};
+
+/// <summary>
+/// The planet's chunks, the cache of them and the thread that streams them in
+/// </summary>
+class ChunkWorld
+{
+public:
+	~ChunkWorld();
+
+	/// <summary>
+	/// Sets up the planet and starts the streaming thread, nothing is generated until it is asked for
+	/// </summary>
+	void Initialise(const PlanetSettings& planetSettings);
+
+	/// <summary>
+	/// Stops the streaming thread and throws away every chunk, it is fine to call this more than once
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	/// Takes in any chunks the streaming thread has finished, this should be called once at the start of each frame
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Copies the part of the planet that is in view in to a buffer. Only the chunks that overlap the view are looked at, any
+	/// that arent in memory yet are left blank and asked for along with the chunks around the view.
+	/// </summary>
+	/// <param name="target"> The buffer to draw in to, viewWidth * viewHeight cells </param>
+	/// <param name="viewWidth"> Width of the view in cells </param>
+	/// <param name="viewHeight"> Height of the view in cells </param>
+	/// <param name="cameraX"> The column at the left of the view, it wraps around the planet </param>
+	/// <param name="cameraY"> The row at the top of the view </param>
+	/// <returns> False if part of the view was left blank, it should be drawn again once the chunks have arrived </returns>
+	bool Render(Cell* target, int viewWidth, int viewHeight, int cameraX, int cameraY);
+
+	/// <summary>
+	/// The same as TerrainIndex::CheckLanding, but anywhere on the planet. A chunk that isnt in memory is generated straight
+	/// away so the result never depends on how far the streaming thread has got.
+	/// </summary>
+	LANDING_RESULT CheckLanding(int cellX, int cellY, float velocityY);
+
+	/// <summary>
+	/// The same as TerrainIndex::SweepLander, but anywhere on the planet. Chunks dont have a distance field so this always
+	/// goes a cell at a time, which is only ever a cell or two for a physics step.
+	/// </summary>
+	TerrainContact SweepLander(float fromX, float fromY, float toX, float toY, float velocityY);
+
+	/// <summary>
+	/// The score for landing at this position, the base score times the platform's multiplier
+	/// </summary>
+	int GetLandingScore(int cellX, int cellY) const;
+
+	/// <summary>
+	/// How far the lander's legs are above whatever is under them
+	/// </summary>
+	int GetAltitude(int cellX, int cellY);
+
+	/// <summary>
+	/// Wraps a column back on to the planet
+	/// </summary>
+	int WrapX(int worldX) const { return ((worldX % width) + width) % width; }
+
+	/// <summary>
+	/// Where the fuel pickup for a column of chunks is
+	/// </summary>
+	/// <returns> False if it has already been collected </returns>
+	bool GetPickup(int chunkColumn, int& worldX, int& worldY) const;
+
+	/// <summary>
+	/// Collects the pickup in this cell, the same as EntityStore::CollectPickupAt but anywhere on the planet
+	/// </summary>
+	/// <returns> True if there was a pickup there that hadnt been collected </returns>
+	bool CollectPickupAt(int cellX, int cellY);
+
+	/// <summary>
+	/// Puts back every pickup that has been collected
+	/// </summary>
+	void ResetPickups() { std::fill(pickupCollected.begin(), pickupCollected.end(), (uint8_t)0); }
+
+	int GetSurfaceRow(int worldX) const { return generator.GetSurfaceRow(WrapX(worldX)); }
+	int GetWidth() const { return width; }
+	int GetWidthInChunks() const { return width / CHUNK_SIZE; }
+	// One for each column of chunks, set once its pickup has been collected
+	const std::vector<uint8_t>& GetCollectedPickups() const { return pickupCollected; }
+	int GetHeight() const { return height; }
+	int GetResidentCount() const { return (int)cache.size(); }
+	long long GetGeneratedCount() const { return generatedCount; }
+
+private:
+	/// <summary>
+	/// Finds a chunk in the cache and marks it as used
+	/// </summary>
+	/// <param name="generateIfMissing"> If true a chunk that isnt in memory is generated on this thread, otherwise nullptr is given back </param>
+	Chunk* GetChunk(int chunkX, int chunkY, bool generateIfMissing);
+
+	/// <summary>
+	/// The TERRAIN_TYPE of any cell on the planet, above and below the planet is empty
+	/// </summary>
+	uint8_t GetMask(int worldX, int worldY);
+
+	/// <summary>
+	/// What the legs of a lander in this cell are touching, solid if either of them is on something that isnt a platform
+	/// </summary>
+	TERRAIN_TYPE GetSurface(int cellX, int cellY);
+
+	/// <summary>
+	/// Asks the streaming thread for a chunk, nothing happens if it is already in memory or already asked for
+	/// </summary>
+	void Request(int chunkX, int chunkY);
+
+	/// <summary>
+	/// Puts a chunk in the cache, throwing out the least recently used chunk if it is full
+	/// </summary>
+	Chunk* Insert(std::unique_ptr<Chunk> chunk);
+
+	void StreamerLoop();
+	static uint64_t MakeKey(int chunkX, int chunkY) { return ((uint64_t)(uint32_t)chunkY << 32) | (uint32_t)chunkX; }
+
+	PlanetSettings settings;
+	PlanetGenerator generator;
+	int width = 0;
+	int height = 0;
+
+	// The cache, this is only touched by the game thread
+	std::vector<std::unique_ptr<Chunk>> cache;
+	std::unordered_map<uint64_t, Chunk*> lookup;
+	// The chunks that have been asked for and havent arrived yet
+	std::unordered_set<uint64_t> requested;
+	uint64_t useClock = 0;
+	// The chunk the last lookup found, collision checks are nearly always in the same chunk as the last one
+	Chunk* lastChunk = nullptr;
+	long long generatedCount = 0;
+	// The pickups are part of the game rather than the terrain, so they are kept here instead of in the chunks that come and go
+	std::vector<uint8_t> pickupCollected;
+
+	// Everything below is shared with the streaming thread and is protected by the mutex
+	std::mutex mutex;
+	// Wakes the streaming thread when there is something to generate or it needs to stop
+	std::condition_variable requestQueued;
+	std::deque<uint64_t> pendingRequests;
+	std::vector<std::unique_ptr<Chunk>> finished;
+	bool stopping = false;
+	std::thread streamer;
+};
+
+#endif // !CHUNK_WORLD_H
@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Compositor.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the layer compositor
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Compositor.h"
+// Includes
+#include "Utility.h"
+#include <string.h>
+
+void Layer::Build(const char* charsToPrint, const uint8_t coloursToPrint[], int layerHeight, int layerWidth)
+{
+	width = layerWidth;
+	height = layerHeight;
+	cells.resize(width * height);
+
+	for (int i = 0; i < width * height; i++)
+	{
+		if (charsToPrint)
+		{
+			// Defaults to colour of white if no colour was specified, the same as WriteImageToBuffer
+			cells[i].glyph = charsToPrint[i];
+			cells[i].attributes = coloursToPrint ? coloursToPrint[i] : 7;
+		}
+		else
+		{
+			// An empty layer is the same as a cleared screen
+			cells[i].glyph = 0;
+			cells[i].attributes = 0;
+		}
+	}
+}
+
+void Layer::BuildFromCells(const Cell* cellsToCopy, int layerHeight, int layerWidth)
+{
+	width = layerWidth;
+	height = layerHeight;
+	cells.assign(cellsToCopy, cellsToCopy + width * height);
+}
+
+void Compositor::SetBackground(const Layer* layer)
+{
+	if (layer != background)
+	{
+		background = layer;
+		needsFullRestore = true;
+	}
+}
+
+void Compositor::BeginFrame(Cell* buffer, int bufferWidth, int bufferHeight)
+{
+	if (buffer != target || bufferWidth != targetWidth || bufferHeight != targetHeight)
+	{
+		target = buffer;
+		targetWidth = bufferWidth;
+		targetHeight = bufferHeight;
+		needsFullRestore = true;
+	}
+
+	if (needsFullRestore)
+	{
+		Restore({ 0, 0, targetWidth, targetHeight });
+		needsFullRestore = false;
+	}
+	else
+	{
+		for (const DirtyRect& rect : dirtyRects)
+		{
+			Restore(rect);
+		}
+	}
+	dirtyRects.clear();
+}
+
+void Compositor::DrawImage(const char* charsToPrint, const uint8_t coloursToPrint[], const int imageHeight, const int imageWidth, int imageXPos, int imageYPos)
+{
+	WriteImageToBuffer(target, targetWidth, targetHeight, charsToPrint, coloursToPrint, imageHeight, imageWidth, imageXPos, imageYPos);
+	MarkDirty(imageXPos, imageYPos, imageWidth, imageHeight);
+}
+
+void Compositor::DrawText(const char* textToPrint, int textLength, int textXPos, int textYPos)
+{
+	WriteTextToBuffer(target, targetWidth, targetHeight, textToPrint, textLength, textXPos, textYPos);
+	MarkDirty(textXPos, textYPos, textLength, 1);
+}
+
+void Compositor::DrawText(const char* textToPrint, int textXPos, int textYPos)
+{
+	DrawText(textToPrint, (int)strlen(textToPrint), textXPos, textYPos);
+}
+
+void Compositor::DrawHudField(const HudField& field, int textXPos, int textYPos)
+{
+	DrawText(field.text, field.length, textXPos, textYPos);
+}
+
+void Compositor::MarkDirty(int x, int y, int width, int height)
+{
+	dirtyRects.push_back({ x, y, width, height });
+}
+
+void Compositor::Restore(const DirtyRect& rect)
+{
+	// Keep the rectangle inside the buffer
+	int left = rect.x < 0 ? 0 : rect.x;
+	int top = rect.y < 0 ? 0 : rect.y;
+	int right = rect.x + rect.width > targetWidth ? targetWidth : rect.x + rect.width;
+	int bottom = rect.y + rect.height > targetHeight ? targetHeight : rect.y + rect.height;
+	if (left >= right || top >= bottom)
+	{
+		return;
+	}
+
+	for (int y = top; y < bottom; y++)
+	{
+		Cell* row = target + targetWidth * y;
+
+		// Copy the row of the background straight over
+		int copyEnd = left;
+		if (background && y < background->height && left < background->width)
+		{
+			copyEnd = right < background->width ? right : background->width;
+			memcpy(row + left, background->cells.data() + background->width * y + left, (copyEnd - left) * sizeof(Cell));
+		}
+
+		// Anything past the edge of the background is left empty
+		if (right > copyEnd)
+		{
+			memset(row + copyEnd, 0, (right - copyEnd) * sizeof(Cell));
+		}
+	}
+}
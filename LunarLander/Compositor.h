@@ -0,0 +1,148 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Compositor.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the compositor, it builds each frame out of a cached static background layer with the sprites and text
+// drawn on top, only the parts of the background that the sprites covered last frame are put back each frame
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+// Includes
+#include "Platform.h"
+#include "Sprite.h"
+#include "HudText.h"
+#include <vector>
+
+/// <summary>
+/// A static layer, such as the level background or a menu screen, that has already been turned into cells
+/// </summary>
+struct Layer
+{
+	/// <summary>
+	/// Converts an ascii image in to cells, this only needs to be done once
+	/// </summary>
+	/// <param name="charsToPrint"> The ascii image, or nullptr for an empty layer </param>
+	/// <param name="coloursToPrint"> The colours for the image, or nullptr to default to white </param>
+	/// <param name="layerHeight"> Height of the image </param>
+	/// <param name="layerWidth"> Width of the image </param>
+	void Build(const char* charsToPrint, const uint8_t coloursToPrint[], int layerHeight, int layerWidth);
+
+	/// <summary>
+	/// Copies cells that are already built, such as the ones in a level file, in to the layer
+	/// </summary>
+	/// <param name="cellsToCopy"> The cells, layerWidth * layerHeight of them </param>
+	/// <param name="layerHeight"> Height of the image </param>
+	/// <param name="layerWidth"> Width of the image </param>
+	void BuildFromCells(const Cell* cellsToCopy, int layerHeight, int layerWidth);
+
+	std::vector<Cell> cells;
+	int width = 0;
+	int height = 0;
+};
+
+/// <summary>
+/// A rectangle on the screen that has had something drawn in to it
+/// </summary>
+struct DirtyRect
+{
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+/// <summary>
+/// This class draws the frame in layers, the background is copied from a cache and only where something was drawn over it
+/// </summary>
+class Compositor
+{
+public:
+	/// <summary>
+	/// Sets which layer is drawn behind everything, changing it means the whole screen gets restored on the next frame
+	/// </summary>
+	void SetBackground(const Layer* layer);
+
+	/// <summary>
+	/// Starts a new frame, the areas that were drawn over last frame are restored from the background layer
+	/// </summary>
+	/// <param name="buffer"> The buffer to draw in to, this is expected to be the same buffer every frame </param>
+	/// <param name="bufferWidth"> Width of the buffer </param>
+	/// <param name="bufferHeight"> Height of the buffer </param>
+	void BeginFrame(Cell* buffer, int bufferWidth, int bufferHeight);
+
+	/// <summary>
+	/// Draws a sprite on top of the background, the same as WriteImageToBuffer but it remembers where it drew
+	/// </summary>
+	void DrawImage(const char* charsToPrint, const uint8_t coloursToPrint[], const int imageHeight, const int imageWidth, int imageXPos, int imageYPos);
+
+	/// <summary>
+	/// Draws a sprite that was looked up by its handle, such as the ones in the entity store
+	/// </summary>
+	void DrawSpriteView(const SpriteView& sprite, int spriteXPos, int spriteYPos)
+	{
+		WriteSpriteViewToBuffer(target, targetWidth, targetHeight, sprite, spriteXPos, spriteYPos);
+		MarkDirty(spriteXPos, spriteYPos, sprite.width, sprite.height);
+	}
+
+	/// <summary>
+	/// Draws a sprite on top of the background and remembers where it drew
+	/// </summary>
+	/// <param name="sprite"> The sprite to draw </param>
+	/// <param name="spriteXPos"> Position on the x axis </param>
+	/// <param name="spriteYPos"> Position on the y axis </param>
+	/// <param name="transparent"> If true then the spaces in the sprite leave what is behind them showing </param>
+	template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+	void DrawSprite(const Sprite<SPRITE_WIDTH, SPRITE_HEIGHT>& sprite, int spriteXPos, int spriteYPos, bool transparent = false)
+	{
+		if (transparent)
+		{
+			WriteSpriteToBufferMasked(target, targetWidth, targetHeight, sprite, spriteXPos, spriteYPos);
+		}
+		else
+		{
+			WriteSpriteToBuffer(target, targetWidth, targetHeight, sprite, spriteXPos, spriteYPos);
+		}
+		MarkDirty(spriteXPos, spriteYPos, SPRITE_WIDTH, SPRITE_HEIGHT);
+	}
+
+	/// <summary>
+	/// Draws text on top of the background, the same as WriteTextToBuffer but it remembers where it drew
+	/// </summary>
+	void DrawText(const char* textToPrint, int textLength, int textXPos, int textYPos);
+	void DrawText(const char* textToPrint, int textXPos, int textYPos);
+
+	/// <summary>
+	/// Draws a HUD field, this uses the text that the field already has so nothing gets formatted here
+	/// </summary>
+	void DrawHudField(const HudField& field, int textXPos, int textYPos);
+
+	/// <summary>
+	/// Marks an area as drawn over so that the background is put back there next frame, this is for anything drawn without the compositor
+	/// </summary>
+	void MarkDirty(int x, int y, int width, int height);
+
+	/// <summary>
+	/// Makes the next frame restore the whole background, used when something else has drawn over the buffer
+	/// </summary>
+	void Invalidate() { needsFullRestore = true; }
+
+private:
+	/// <summary>
+	/// Copies the background back over part of the buffer
+	/// </summary>
+	void Restore(const DirtyRect& rect);
+
+	const Layer* background = nullptr;
+	bool needsFullRestore = true;
+
+	Cell* target = nullptr;
+	int targetWidth = 0;
+	int targetHeight = 0;
+
+	// The areas that have been drawn over this frame, these get restored at the start of the next one
+	std::vector<DirtyRect> dirtyRects;
+};
+
+#endif // !COMPOSITOR_H
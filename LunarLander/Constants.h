@@ -9,12 +9,17 @@
 #define CONSTANTS_H
 
 //Headers
-#include <Windows.h>
+#include "Platform.h"
 
 // Defines
-#define SCREEN_WIDTH 150
-#define SCREEN_HEIGHT 40
 #define FRAME_RATE 5
+// How many times per second the physics is stepped, this is separate from the frame rate
+#define SIMULATION_RATE 60
+
+// The size of the level in cells, the physics, collision and pickups all work on this grid. The screen can be any size,
+// the level is fitted on to it when it is drawn
+const int LEVEL_WIDTH = 150;
+const int LEVEL_HEIGHT = 40;
 
 // Keys: these are the keyboard inputs that the player will be able to interface with in the game
 const int KEY_ESC = VK_ESCAPE;
@@ -23,15 +28,24 @@ const int KEY_W = 'W';
 const int KEY_A = 'A';
 const int KEY_S = 'S';
 const int KEY_D = 'D';
+// Shows or hides the profiler overlay
+const int KEY_P = 'P';
 const int KEY_1 = '1';
 const int KEY_2 = '2';
 const int KEY_3 = '3';
 const int KEY_4 = '4';
 
+// Simulation Parameters
+const float SIMULATION_STEP = 1.0f / SIMULATION_RATE;
+// If a frame takes so long that more than this many steps are due then the extra time is dropped
+const int MAX_SIMULATION_STEPS = 8;
+
 // Player Parameters
 const float ACCELERATION_RATE = 0.5f;
 const float DECELERATION_RATE = 0.2f;
-const float FUEL_CONSUMPTION_RATE = 0.5f;
+// These are per second, they match the one cell and 0.5 fuel per update that the lander used when it updated 5 times a second
+const float MOVE_SPEED = 5.0f;
+const float FUEL_CONSUMPTION_RATE = 2.5f;
 const int BASE_SCORE = 50; // The score you get for landing which is then multiplied by the modifier
 
 #endif // !CONSTANTS_H
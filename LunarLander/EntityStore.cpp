@@ -0,0 +1,311 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: EntityStore.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the entity store
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "EntityStore.h"
+// Includes
+#include <string.h>
+
+// SSE2 is always there on 64 bit x86 and on 32 bit builds that ask for it, anything else only gets the plain loop
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTITY_STORE_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define ENTITY_STORE_USE_SSE2 0
+#endif
+
+EntityStore::EntityStore()
+	: pickupGrid(LEVEL_WIDTH * LEVEL_HEIGHT, 0)
+{
+}
+
+int EntityStore::AddLander(float xPos, float yPos, float fuel, SpriteHandle sprite)
+{
+	landers.thrust.push_back(0);
+	landers.left.push_back(0);
+	landers.right.push_back(0);
+	landers.xPos.push_back(xPos);
+	landers.yPos.push_back(yPos);
+	landers.previousXPos.push_back(xPos);
+	landers.previousYPos.push_back(yPos);
+	landers.acceleration.push_back(0.0f);
+	landers.velocityY.push_back(0.0f);
+	landers.fuel.push_back(fuel);
+	landers.isMovingLeft.push_back(0);
+	landers.isMovingRight.push_back(0);
+	landers.state.push_back(LANDING_NONE);
+	landers.score.push_back(0);
+	landers.sprite.push_back(sprite);
+	return landers.Count() - 1;
+}
+
+void EntityStore::RemoveLander(int index)
+{
+	int last = landers.Count() - 1;
+	if (index != last)
+	{
+		landers.thrust[index] = landers.thrust[last];
+		landers.left[index] = landers.left[last];
+		landers.right[index] = landers.right[last];
+		landers.xPos[index] = landers.xPos[last];
+		landers.yPos[index] = landers.yPos[last];
+		landers.previousXPos[index] = landers.previousXPos[last];
+		landers.previousYPos[index] = landers.previousYPos[last];
+		landers.acceleration[index] = landers.acceleration[last];
+		landers.velocityY[index] = landers.velocityY[last];
+		landers.fuel[index] = landers.fuel[last];
+		landers.isMovingLeft[index] = landers.isMovingLeft[last];
+		landers.isMovingRight[index] = landers.isMovingRight[last];
+		landers.state[index] = landers.state[last];
+		landers.score[index] = landers.score[last];
+		landers.sprite[index] = landers.sprite[last];
+	}
+
+	landers.thrust.pop_back();
+	landers.left.pop_back();
+	landers.right.pop_back();
+	landers.xPos.pop_back();
+	landers.yPos.pop_back();
+	landers.previousXPos.pop_back();
+	landers.previousYPos.pop_back();
+	landers.acceleration.pop_back();
+	landers.velocityY.pop_back();
+	landers.fuel.pop_back();
+	landers.isMovingLeft.pop_back();
+	landers.isMovingRight.pop_back();
+	landers.state.pop_back();
+	landers.score.pop_back();
+	landers.sprite.pop_back();
+}
+
+int EntityStore::AddPickup(int x, int y, float fuel, SpriteHandle sprite)
+{
+	if (x < 0 || x >= LEVEL_WIDTH || y < 0 || y >= LEVEL_HEIGHT)
+	{
+		return -1;
+	}
+
+	int& cell = pickupGrid[x + LEVEL_WIDTH * y];
+	if (cell != 0)
+	{
+		RemovePickup(cell - 1);
+	}
+
+	pickups.x.push_back((short)x);
+	pickups.y.push_back((short)y);
+	pickups.fuel.push_back(fuel);
+	pickups.sprite.push_back(sprite);
+	cell = pickups.Count();
+	return pickups.Count() - 1;
+}
+
+void EntityStore::RemovePickup(int index)
+{
+	int last = pickups.Count() - 1;
+	pickupGrid[pickups.x[index] + LEVEL_WIDTH * pickups.y[index]] = 0;
+
+	if (index != last)
+	{
+		pickups.x[index] = pickups.x[last];
+		pickups.y[index] = pickups.y[last];
+		pickups.fuel[index] = pickups.fuel[last];
+		pickups.sprite[index] = pickups.sprite[last];
+		pickupGrid[pickups.x[index] + LEVEL_WIDTH * pickups.y[index]] = index + 1;
+	}
+
+	pickups.x.pop_back();
+	pickups.y.pop_back();
+	pickups.fuel.pop_back();
+	pickups.sprite.pop_back();
+}
+
+void EntityStore::ClearLanders()
+{
+	landers.thrust.clear();
+	landers.left.clear();
+	landers.right.clear();
+	landers.xPos.clear();
+	landers.yPos.clear();
+	landers.previousXPos.clear();
+	landers.previousYPos.clear();
+	landers.acceleration.clear();
+	landers.velocityY.clear();
+	landers.fuel.clear();
+	landers.isMovingLeft.clear();
+	landers.isMovingRight.clear();
+	landers.state.clear();
+	landers.score.clear();
+	landers.sprite.clear();
+}
+
+void EntityStore::ClearPickups()
+{
+	for (int i = 0; i < pickups.Count(); i++)
+	{
+		pickupGrid[pickups.x[i] + LEVEL_WIDTH * pickups.y[i]] = 0;
+	}
+	pickups.x.clear();
+	pickups.y.clear();
+	pickups.fuel.clear();
+	pickups.sprite.clear();
+}
+
+#if ENTITY_STORE_USE_SSE2
+/// <summary>
+/// Turns 4 of the 0 or 1 bytes from a column in to 4 masks, all bits set for 1 and none for 0
+/// </summary>
+static __m128 LoadByteMasks(const uint8_t* bytes)
+{
+	int32_t packed;
+	memcpy(&packed, bytes, sizeof(packed));
+	const __m128i zero = _mm_setzero_si128();
+	__m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+	return _mm_castsi128_ps(_mm_cmpgt_epi32(wide, zero));
+}
+
+/// <summary>
+/// The other way to LoadByteMasks, 4 masks are written to a column as 0 or 1
+/// </summary>
+static void StoreByteMasks(uint8_t* bytes, __m128 masks)
+{
+	__m128i words = _mm_packs_epi32(_mm_castps_si128(masks), _mm_castps_si128(masks));
+	__m128i narrow = _mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1));
+	int32_t packed = _mm_cvtsi128_si32(narrow);
+	memcpy(bytes, &packed, sizeof(packed));
+}
+
+/// <summary>
+/// SelectFloat for 4 at a time, the mask has all bits set where the true value is wanted
+/// </summary>
+static __m128 SelectFloats(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+{
+	return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+#endif
+
+void EntityStore::StepLanders(float step, const PhysicsTuning& tuning)
+{
+	const int count = landers.Count();
+	int i = 0;
+
+#if ENTITY_STORE_USE_SSE2
+	// This is StepLanderMotion line for line on 4 landers at once. Every step is the same operation on the same values, so
+	// the results are exactly the same as the game's lander gets.
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 fuelSpent = _mm_set1_ps(tuning.fuelConsumptionRate * step);
+	const __m128 moveStep = _mm_set1_ps(tuning.moveSpeed * step);
+	const __m128 negativeMoveStep = _mm_set1_ps(-(tuning.moveSpeed * step));
+	const __m128 speedUp = _mm_set1_ps(tuning.accelerationRate * step);
+	const __m128 slowDown = _mm_set1_ps(-(tuning.decelerationRate * step));
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 mostAcceleration = _mm_set1_ps(1.5f);
+	const __m128 wrapWidth = _mm_set1_ps(tuning.wrapWidth);
+	const __m128 lowestY = _mm_set1_ps(tuning.lowestY);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 xPos = _mm_loadu_ps(&landers.xPos[i]);
+		__m128 yPos = _mm_loadu_ps(&landers.yPos[i]);
+		__m128 acceleration = _mm_loadu_ps(&landers.acceleration[i]);
+		__m128 fuel = _mm_loadu_ps(&landers.fuel[i]);
+		_mm_storeu_ps(&landers.previousXPos[i], xPos);
+		_mm_storeu_ps(&landers.previousYPos[i], yPos);
+
+		__m128 isAccelerating = _mm_and_ps(LoadByteMasks(&landers.thrust[i]), _mm_cmpgt_ps(fuel, zero));
+		fuel = _mm_sub_ps(fuel, SelectFloats(isAccelerating, fuelSpent, zero));
+
+		__m128 isMovingLeft = _mm_and_ps(LoadByteMasks(&landers.left[i]), _mm_cmpgt_ps(fuel, zero));
+		xPos = _mm_sub_ps(xPos, SelectFloats(isMovingLeft, moveStep, zero));
+		fuel = _mm_sub_ps(fuel, SelectFloats(isMovingLeft, fuelSpent, zero));
+
+		__m128 isMovingRight = _mm_and_ps(LoadByteMasks(&landers.right[i]), _mm_cmpgt_ps(fuel, zero));
+		xPos = _mm_add_ps(xPos, SelectFloats(isMovingRight, moveStep, zero));
+		fuel = _mm_sub_ps(fuel, SelectFloats(isMovingRight, fuelSpent, zero));
+
+		acceleration = _mm_add_ps(acceleration, SelectFloats(isAccelerating, speedUp, slowDown));
+		acceleration = SelectFloats(_mm_cmple_ps(acceleration, zero), zero,
+			SelectFloats(_mm_cmpge_ps(acceleration, mostAcceleration), mostAcceleration, acceleration));
+
+		yPos = _mm_add_ps(yPos, SelectFloats(_mm_cmpge_ps(acceleration, half), negativeMoveStep, moveStep));
+
+		__m128 wrappedLeft = SelectFloats(_mm_cmplt_ps(xPos, zero), _mm_add_ps(xPos, wrapWidth), xPos);
+		xPos = SelectFloats(_mm_cmpge_ps(xPos, wrapWidth), _mm_sub_ps(xPos, wrapWidth), wrappedLeft);
+		yPos = SelectFloats(_mm_cmple_ps(yPos, zero), zero, SelectFloats(_mm_cmpge_ps(yPos, lowestY), lowestY, yPos));
+
+		_mm_storeu_ps(&landers.xPos[i], xPos);
+		_mm_storeu_ps(&landers.yPos[i], yPos);
+		_mm_storeu_ps(&landers.acceleration[i], acceleration);
+		_mm_storeu_ps(&landers.velocityY[i], _mm_sub_ps(acceleration, half));
+		_mm_storeu_ps(&landers.fuel[i], fuel);
+		StoreByteMasks(&landers.isMovingLeft[i], isMovingLeft);
+		StoreByteMasks(&landers.isMovingRight[i], isMovingRight);
+	}
+#endif
+
+	// Whatever is left over, or everything without SSE2
+	for (; i < count; i++)
+	{
+		landers.previousXPos[i] = landers.xPos[i];
+		landers.previousYPos[i] = landers.yPos[i];
+		PlayerInput input;
+		input.thrust = landers.thrust[i] != 0;
+		input.left = landers.left[i] != 0;
+		input.right = landers.right[i] != 0;
+		bool isMovingLeft;
+		bool isMovingRight;
+		StepLanderMotion(landers.xPos[i], landers.yPos[i], landers.acceleration[i], landers.velocityY[i], landers.fuel[i], isMovingLeft, isMovingRight,
+			input, step, tuning);
+		landers.isMovingLeft[i] = isMovingLeft;
+		landers.isMovingRight[i] = isMovingRight;
+	}
+}
+
+int EntityStore::CheckLandings(const TerrainIndex& terrain)
+{
+	float* xPos = landers.xPos.data();
+	float* yPos = landers.yPos.data();
+	const float* previousXPos = landers.previousXPos.data();
+	const float* previousYPos = landers.previousYPos.data();
+	const float* velocityY = landers.velocityY.data();
+	uint8_t* state = landers.state.data();
+	const int count = landers.Count();
+
+	int touchedDown = 0;
+	for (int i = 0; i < count; i++)
+	{
+		TerrainContact contact = terrain.SweepLander(previousXPos[i], previousYPos[i], xPos[i], yPos[i], velocityY[i]);
+		LANDING_RESULT result = contact.result;
+		if (result != LANDING_NONE)
+		{
+			xPos[i] = contact.xPos;
+			yPos[i] = contact.yPos;
+			state[i] = (uint8_t)result;
+			if (result == LANDING_LANDED)
+			{
+				landers.score[i] += terrain.GetLandingScore((int)xPos[i], (int)yPos[i]);
+			}
+			touchedDown++;
+		}
+	}
+	return touchedDown;
+}
+
+float EntityStore::CollectPickupAt(int x, int y)
+{
+	if (x < 0 || x >= LEVEL_WIDTH || y < 0 || y >= LEVEL_HEIGHT)
+	{
+		return 0.0f;
+	}
+
+	int cell = pickupGrid[x + LEVEL_WIDTH * y];
+	if (cell == 0)
+	{
+		return 0.0f;
+	}
+	float fuel = pickups.fuel[cell - 1];
+	RemovePickup(cell - 1);
+	return fuel;
+}
@@ -0,0 +1,145 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: EntityStore.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the entity store, landers and pickups are kept as columns (one array per value) rather than one struct
+// each, so the update and collision passes only read the values they need from memory that is all next to each other.
+// Sprites are kept once in a table and entities just hold a handle to theirs.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+// Includes
+#include "LanderPhysics.h"
+#include "TerrainIndex.h"
+#include "Sprite.h"
+#include <stdint.h>
+#include <vector>
+
+// TYPEDEFS
+typedef uint16_t SpriteHandle;
+
+/// <summary>
+/// Holds every sprite the entities use, entities refer to them by the handle that Add gives back
+/// </summary>
+class SpriteTable
+{
+public:
+	template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+	SpriteHandle Add(const Sprite<SPRITE_WIDTH, SPRITE_HEIGHT>& sprite)
+	{
+		views.push_back(MakeSpriteView(sprite));
+		return (SpriteHandle)(views.size() - 1);
+	}
+
+	const SpriteView& Get(SpriteHandle handle) const { return views[handle]; }
+
+private:
+	std::vector<SpriteView> views;
+};
+
+/// <summary>
+/// The landers, the same index in each array is the same lander. Every lander in the store is flying, the state is a LANDING_RESULT
+/// that CheckLandings sets when one touches down and it should then be taken out before the next step.
+/// </summary>
+struct LanderColumns
+{
+	// The controls for the next step, these are set before StepLanders is run
+	std::vector<uint8_t> thrust;
+	std::vector<uint8_t> left;
+	std::vector<uint8_t> right;
+	std::vector<float> xPos;
+	std::vector<float> yPos;
+	std::vector<float> previousXPos;
+	std::vector<float> previousYPos;
+	std::vector<float> acceleration;
+	std::vector<float> velocityY;
+	std::vector<float> fuel;
+	std::vector<uint8_t> isMovingLeft;
+	std::vector<uint8_t> isMovingRight;
+	std::vector<uint8_t> state;
+	std::vector<int> score;
+	std::vector<SpriteHandle> sprite;
+
+	int Count() const { return (int)xPos.size(); }
+};
+
+/// <summary>
+/// The pickups, the same index in each array is the same pickup
+/// </summary>
+struct PickupColumns
+{
+	std::vector<short> x;
+	std::vector<short> y;
+	std::vector<float> fuel;
+	std::vector<SpriteHandle> sprite;
+
+	int Count() const { return (int)x.size(); }
+};
+
+/// <summary>
+/// This class keeps all of the landers and pickups and runs the passes over them
+/// </summary>
+class EntityStore
+{
+public:
+	EntityStore();
+
+	/// <summary>
+	/// Adds a lander, it starts off still
+	/// </summary>
+	/// <returns> The index of the lander </returns>
+	int AddLander(float xPos, float yPos, float fuel, SpriteHandle sprite);
+
+	/// <summary>
+	/// Removes a lander, the last lander is moved in to its place so the columns stay packed and the passes dont have to skip it
+	/// </summary>
+	void RemoveLander(int index);
+
+	/// <summary>
+	/// Adds a fuel pickup, if there is already one in that cell then it is replaced
+	/// </summary>
+	/// <returns> The index of the pickup, this changes when other pickups are removed </returns>
+	int AddPickup(int x, int y, float fuel, SpriteHandle sprite);
+
+	/// <summary>
+	/// Removes a pickup, the last pickup is moved in to its place so the columns stay packed
+	/// </summary>
+	void RemovePickup(int index);
+
+	void ClearLanders();
+	void ClearPickups();
+
+	/// <summary>
+	/// Moves every lander by one physics step with the controls in its thrust, left and right columns. It gives exactly the same
+	/// numbers as MoveLander, but works on 4 landers at a time with SSE2 where the cpu has it.
+	/// </summary>
+	/// <param name="step"> Length of the step in seconds </param>
+	/// <param name="tuning"> How the landers handle </param>
+	void StepLanders(float step, const PhysicsTuning& tuning);
+
+	/// <summary>
+	/// Sweeps every lander along its last step against the terrain, the ones that touched down are moved back to where they
+	/// touched and have their state and score set
+	/// </summary>
+	/// <param name="terrain"> The index of the level being flown </param>
+	/// <returns> How many landers landed or crashed in this pass </returns>
+	int CheckLandings(const TerrainIndex& terrain);
+
+	/// <summary>
+	/// Collects the pickup in one cell, this is for a lander that isnt in the store
+	/// </summary>
+	/// <returns> The fuel that was in the pickup, 0 if there wasnt one </returns>
+	float CollectPickupAt(int x, int y);
+
+	SpriteTable sprites;
+	LanderColumns landers;
+	PickupColumns pickups;
+
+private:
+	// For each cell on screen, the index of the pickup in it plus one, so 0 means empty. This means collision is one lookup per lander
+	std::vector<int> pickupGrid;
+};
+
+#endif // !ENTITY_STORE_H
@@ -0,0 +1,88 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: FrameScheduler.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the frame scheduler
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "FrameScheduler.h"
+// Includes
+#include <cmath>
+
+/// <summary>
+/// Gets the average amount that frames started late by
+/// </summary>
+double FrameStats::GetMeanJitter() const
+{
+	return frameCount > 0 ? jitterSum / frameCount : 0.0;
+}
+
+/// <summary>
+/// Gets the standard deviation of the jitter, a low value means the frames are evenly spaced
+/// </summary>
+double FrameStats::GetJitterDeviation() const
+{
+	if (frameCount == 0)
+	{
+		return 0.0;
+	}
+	double mean = GetMeanJitter();
+	double variance = (jitterSquaredSum / frameCount) - (mean * mean);
+	return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+void FrameScheduler::Initialise(Platform* schedulerPlatform, float targetRate, PACING_MODE mode)
+{
+	platform = schedulerPlatform;
+	pacingMode = mode;
+	framePeriod = 1.0 / (double)targetRate;
+
+	previousFrameTime = platform->GetTime();
+	nextDeadline = previousFrameTime;
+	stats = FrameStats();
+}
+
+float FrameScheduler::WaitForNextFrame()
+{
+	double now = platform->GetTime();
+
+	// Sleep for most of the time that is left, then spin for the rest
+	double remaining = nextDeadline - now;
+	if (remaining > SPIN_TIME)
+	{
+		platform->SleepFor(remaining - SPIN_TIME);
+	}
+	while ((now = platform->GetTime()) < nextDeadline)
+	{
+	}
+
+	// Record how late this frame was
+	double jitter = now - nextDeadline;
+	stats.frameCount++;
+	stats.lastJitter = jitter;
+	stats.maxJitter = jitter > stats.maxJitter ? jitter : stats.maxJitter;
+	stats.jitterSum += jitter;
+	stats.jitterSquaredSum += jitter * jitter;
+
+	// Work out when the next frame is due
+	if (pacingMode == PACING_FIXED)
+	{
+		nextDeadline += framePeriod;
+		if (nextDeadline <= now)
+		{
+			// We are more than a whole frame behind, so skip the missed deadlines instead of running frames back to back
+			int missed = (int)std::floor((now - nextDeadline) / framePeriod) + 1;
+			stats.missedFrames += missed;
+			nextDeadline += missed * framePeriod;
+		}
+	}
+	else
+	{
+		nextDeadline = now + framePeriod;
+	}
+
+	float deltaTime = (float)(now - previousFrameTime);
+	previousFrameTime = now;
+	return deltaTime;
+}
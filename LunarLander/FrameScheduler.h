@@ -0,0 +1,81 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: FrameScheduler.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the frame scheduler, it sleeps the main loop until the next frame is due instead of spinning
+// and keeps statistics on how close to the deadline each frame actually started
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+// Includes
+#include "Platform.h"
+
+/// <summary>
+/// The different ways the scheduler can decide when the next frame is due
+/// </summary>
+enum PACING_MODE
+{
+	// Deadlines are kept on a fixed grid (like vsync), a late frame doesnt push back the ones after it,
+	// and if a whole frame is missed it is skipped rather than trying to catch up
+	PACING_FIXED,
+	// The next deadline is one frame after the previous frame actually started
+	PACING_FROM_LAST_FRAME,
+};
+
+/// <summary>
+/// Statistics about how accurately frames have started, jitter is how late a frame started compared to its deadline
+/// </summary>
+struct FrameStats
+{
+	int frameCount = 0;
+	int missedFrames = 0;
+	double lastJitter = 0.0;
+	double maxJitter = 0.0;
+	double jitterSum = 0.0;
+	double jitterSquaredSum = 0.0;
+
+	double GetMeanJitter() const;
+	double GetJitterDeviation() const;
+};
+
+/// <summary>
+/// This class paces the main game loop to a target frame rate
+/// </summary>
+class FrameScheduler
+{
+public:
+	/// <summary>
+	/// Sets up the scheduler, the first frame is due straight away
+	/// </summary>
+	/// <param name="schedulerPlatform"> The platform to get the time from and sleep with </param>
+	/// <param name="targetRate"> How many frames per second to run at </param>
+	/// <param name="mode"> How the deadlines are worked out </param>
+	void Initialise(Platform* schedulerPlatform, float targetRate, PACING_MODE mode = PACING_FIXED);
+
+	/// <summary>
+	/// Sleeps until the next frame is due, most of the wait is a normal sleep and then the last little bit is spun
+	/// as sleeping isnt accurate enough to hit the deadline on its own
+	/// </summary>
+	/// <returns> The time in seconds since the previous frame started </returns>
+	float WaitForNextFrame();
+
+	/// <summary>
+	/// Gets the jitter statistics for all the frames since the scheduler started
+	/// </summary>
+	const FrameStats& GetStats() const { return stats; }
+
+private:
+	// The sleep is stopped this long before the deadline and the rest is spun, this covers the inaccuracy of the sleep
+	static constexpr double SPIN_TIME = 0.002;
+
+	Platform* platform = nullptr;
+	PACING_MODE pacingMode = PACING_FIXED;
+	double framePeriod = 0.0;
+	double nextDeadline = 0.0;
+	double previousFrameTime = 0.0;
+	FrameStats stats;
+};
+
+#endif // !FRAME_SCHEDULER_H
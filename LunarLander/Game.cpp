@@ -10,39 +10,133 @@
 // Includes
 #include "Utility.h"
 #include "Constants.h"
+#include "LanderPhysics.h"
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <time.h>
-#include <Windows.h>
 
 /// <summary>
 /// This function will initialise what is needed for the game upon startup
 /// </summary>
-void Game::Initialise()
+/// <param name="gamePlatform"> The platform that the game will draw to and take input from </param>
+/// <param name="audioSink"> Where the sound goes, if this is null then the platform's speakers are used. The game takes ownership of it </param>
+/// <param name="seed"> The seed for all of the random numbers in this session, the same seed gives the same game </param>
+/// <param name="useSettingsFiles"> If false the high score and sound setting arent loaded or saved, replays use this so they dont touch the real files </param>
+/// <param name="levelPath"> A level file to play, if this is null or the file cant be used then the built in level is played </param>
+/// <param name="planet"> If true the lander flies over a whole planet made from the seed instead of the level </param>
+void Game::Initialise(Platform* gamePlatform, AudioSink* audioSink, uint64_t seed, bool useSettingsFiles, const char* levelPath, bool planet)
 {
-	// Set the console title
-	SetConsoleTitle(L"Lunar Lander");
-
-	// Set screen buffer size
-	SetConsoleScreenBufferSize(wHnd, bufferSize);
-	// Set the window size
-	SetConsoleWindowInfo(wHnd, TRUE, &windowSize);
-
-	// When you first load up the game it will open the file that stores the state of whenever sound is on or off
-	// And sets the stored value to be 1 as i want sound to be on by default when you open the game.
-	std::ofstream soundStateTxt;
-	soundStateTxt.open("SoundState.txt");
-	soundStateTxt << std::to_string(1);
-	soundStateTxt.close();
+	platform = gamePlatform;
+
+	// Every part of the game that needs random numbers gets its own stream from the one seed, so they dont affect each other
+	randomSeed = seed;
+	for (int stream = 0; stream < RANDOM_STREAM_COUNT; stream++)
+	{
+		random[stream].Seed(seed, (uint64_t)stream);
+	}
+
+	// The level file is mapped and used as it is, the built in level is only converted if there isnt one.
+	// This is done before the console is set up so that the message can be seen
+	if (!levelPath || !level.Load(platform, levelPath))
+	{
+		if (levelPath)
+		{
+			std::cerr << "Couldnt load level " << levelPath << ", playing the built in level" << std::endl;
+		}
+		level.BuildFromAscii(background.CHARACTERS);
+	}
+	terrain.Build(level);
+
+	// The planet is made from the same seed as everything else, its chunks are only generated once they are needed
+	planetMode = planet;
+	if (planetMode)
+	{
+		PlanetSettings planetSettings;
+		planetSettings.seed = seed;
+		world.Initialise(planetSettings);
+		ResetPlayer();
+	}
+
+	// Set the console title and ask for the level's size, the console might end up being a different size
+	platform->Initialise("Lunar Lander", LEVEL_WIDTH, LEVEL_HEIGHT);
+
+	// Convert the static screens in to cells once, from then on they are just copied
+	levelArt.BuildFromCells(level.GetCells(), LEVEL_HEIGHT, LEVEL_WIDTH);
+	menuArt.Build(menu.CHARACTERS, nullptr, LEVEL_HEIGHT, LEVEL_WIDTH);
+	optionsArt.Build(menu.CHARACTERS_OPTIONS, nullptr, LEVEL_HEIGHT, LEVEL_WIDTH);
+
+	// The sprites for things in the entity store are added once and then referred to by handle
+	fuelSprite = entities.sprites.Add(fuel.SPRITE);
+
+	// The particle pool is allocated once here and reused for the whole game
+	particles.Initialise(ParticleSystem::DEFAULT_CAPACITY, screenWidth, screenHeight);
+
+	// Size everything that depends on the console to whatever size it is
+	int width = LEVEL_WIDTH;
+	int height = LEVEL_HEIGHT;
+	platform->PollResize(width, height);
+	Resize(width, height);
+
+	// These are the only keys the game uses, so they are the only ones that get read each update
+	const int keys[] = { KEY_ESC, KEY_ENTER, KEY_W, KEY_A, KEY_S, KEY_D, KEY_P };
+	input.Initialise(platform, keys, sizeof(keys) / sizeof(keys[0]));
+
+	// Load the high score and sound setting, after this they are only read from memory
+	settings.Initialise(platform, useSettingsFiles);
+
+	// Sound is turned on whenever you open the game, as i want sound to be on by default
+	settings.SetSoundOn(true);
+
+	// Start the mixer and decode the sounds now, so that playing them later doesnt touch the disk
+	audio.Initialise(audioSink ? audioSink : platform->CreateAudioSink());
+	thrusterSound = audio.LoadSound("Thruster.wav");
 }
 
 /// <summary>
-/// This function is called every frame, it is the game loop itself
+/// This function saves anything that hasnt been written yet, it needs to be called before the platform is deleted
+/// </summary>
+void Game::Shutdown()
+{
+	audio.Shutdown();
+	settings.Shutdown();
+	// Finish off the trace file if there is one
+	profiler.Shutdown();
+	// The chunk streaming thread has to be stopped before the game goes away
+	world.Shutdown();
+	// A mapped level is unmapped through the platform
+	level.Unload();
+}
+
+/// <summary>
+/// This function is called every frame, it is the game loop itself. It updates the state of the game but doesnt draw anything,
+/// that is done in Draw so that the game can be drawn at a different rate to the physics
 /// </summary>
 /// <param name="deltaTime"> Passed in is the change in time since the last frame </param>
 void Game::Update(float deltaTime)
 {
+	// The frame is timed from here to the end of Draw
+	profiler.BeginFrame();
+
+	// Read the keyboard once, everything below asks the input system instead of the platform
+	ProfileScope inputScope(profiler, PROFILE_INPUT);
+	input.Sample();
+
+	// Remember when the oldest key press that hasnt been drawn yet happened, Draw uses it to work out the input latency
+	InputEvent event;
+	while (input.PollEvent(event))
+	{
+		if (event.type == KEY_PRESSED && undrawnInputTime < 0.0)
+		{
+			undrawnInputTime = event.time;
+		}
+	}
+
+	// The profiler overlay can be turned on and off on any screen, it only changes what is drawn
+	if (input.WasPressed(KEY_P))
+	{
+		profiler.ToggleOverlay();
+	}
+	inputScope.End();
+
 	// This checks the current state/scene the game is on
 	switch (currentGameState)
 	{
@@ -51,19 +145,10 @@ void Game::Update(float deltaTime)
 		*/
 		case SPLASH:
 		{
-			// Create new splash screen
-			static Splash splash;
-
 			// Calculate current splash duration
 			splash.duration += deltaTime;
 
-			if (splash.duration < 3.0f)
-			{
-				// Draw splash image
-				WriteImageToBuffer(consoleBuffer, splash.CHARACTERS, splash.COLOURS, splash.HEIGHT, splash.WIDTH,
-					(SCREEN_WIDTH / 2) - (splash.WIDTH / 2), (SCREEN_HEIGHT / 2) - (splash.HEIGHT / 2));
-			}
-			else
+			if (splash.duration >= 3.0f)
 			{
 				// Move to menu state and reset splash duration
 				splash.duration = 0.0f;
@@ -80,104 +165,41 @@ void Game::Update(float deltaTime)
 			// Sets the timer to be 0 when not in game as i dont want it to be counting up when the player isnt in game
 			gameSequence.runTime = 0.0f;
 
-			// This will set the sound to null as i have a bug where if the sound is playing when you land or crash, then it wont stop
-			PlaySound(NULL, 0, 0);
-
-			// Clear any previous images
-			ClearScreen(consoleBuffer);
-			// Draw the menu to the buffer
-			WriteImageToBuffer(consoleBuffer, menu.CHARACTERS, nullptr, SCREEN_HEIGHT, SCREEN_WIDTH, 0, 0);
+			// Make sure the thruster isnt still going from the last game, this only sends anything to the mixer if it is
+			SetThrusterPlaying(false);
 
-			// Opens the highscore file and saves it to an integer variable
-			int score;
-			std::ifstream highScoreTxt("HighScore.txt", std::ios::in);
-			highScoreTxt >> score;
+			// Get the highscore, this comes from memory so it is fine to do every frame
+			menu.highScore = settings.GetHighScore();
 
 			// this is a variable that will enable the highscore text to blink (in proper retro fashion)
-			static float blinkTimer = 0.0f;
-			blinkTimer += deltaTime; // increment blink timer by delta time
-
-			// if blink timer is more than 0.5 or less than 2, display the highscore text
-			if (blinkTimer >= 0.5f && blinkTimer < 2.0f)
-			{
-				WriteTextToBuffer(consoleBuffer, "H I G H  S C O R E : " + std::to_string(score), 65, 13);
-			}
-			//else display that nothing, this creates a blinking animation for the highscore text
-			else if(blinkTimer > 2.0f)
+			menu.blinkTimer += deltaTime; // increment blink timer by delta time
+			if (menu.blinkTimer > 2.0f)
 			{
-				WriteTextToBuffer(consoleBuffer, "", 65, 13);
-				blinkTimer = 0.0f;
-			}
-			highScoreTxt.close();
-			
-			// This displays the selection sprite at the position correlating to the currently selected option
-			if (menu.menuSelection == 0)
-			{
-				// draw select icon to the position for having play selected
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 15);
-			}
-			else if (menu.menuSelection == 1)
-			{
-				// draw select icon to the position for having options selected
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 55, 21);
-			}
-			else if (menu.menuSelection == 2)
-			{
-				// draw select icon to the position for having quit selected
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 62, 27);
-			}
-
-			// Take the input of either w or s, this will then move the select icon accordingly and change the value for which option is selected
-			if (GetAsyncKeyState(KEY_S) && menu.menuSelection == 0)
-			{
-				// if they currently have play selected and press s, move the icon to be next to options and change the menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 55, 21);
-				menu.menuSelection = 1;
-			}
-			else if (GetAsyncKeyState(KEY_S) && menu.menuSelection == 1)
-			{
-				// if they currently have options selected and press s, move the icon to be next to quit and change the menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 62, 27);
-				menu.menuSelection = 2;
-			}
-			else if (GetAsyncKeyState(KEY_S) && menu.menuSelection == 2)
-			{
-				// if they currently have quit selected and press s, move the icon to be next to play so that it loops back to the top and change the menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 15);
-				menu.menuSelection = 0;
+				menu.blinkTimer = 0.0f;
 			}
 
-			if (GetAsyncKeyState(KEY_W) && menu.menuSelection == 0)
+			// Take the input of either w or s, this will then change the value for which option is selected, it wraps around at the top and bottom
+			if (input.WasPressed(KEY_S))
 			{
-				// if they currently have play selected and press w, move the icon to be next to quit so that it loops back to the bottom and change the menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 62, 27);
-				menu.menuSelection = 2;
+				menu.menuSelection = (menu.menuSelection + 1) % 3;
 			}
-			else if (GetAsyncKeyState(KEY_W) && menu.menuSelection == 1)
+			else if (input.WasPressed(KEY_W))
 			{
-				// if they currently have options selected and press w, move the icon next to play and change menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 15);
-				menu.menuSelection = 0;
-			}
-			else if (GetAsyncKeyState(KEY_W) && menu.menuSelection == 2)
-			{
-				// if they currently have quit selected and press w, move the icon next to options and change menu selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 55, 21);
-				menu.menuSelection = 1;
+				menu.menuSelection = (menu.menuSelection + 2) % 3;
 			}
 			
 			// when the player presses enter on the menu, it will get what option is currently selected and react appropriately
-			if (GetAsyncKeyState(KEY_ENTER) && menu.menuSelection == 0)
+			if (input.WasPressed(KEY_ENTER) && menu.menuSelection == 0)
 			{
 				// if play is selected then load the play game state
 				currentGameState = PLAY;
 			}
-			else if (GetAsyncKeyState(KEY_ENTER) && menu.menuSelection == 1)
+			else if (input.WasPressed(KEY_ENTER) && menu.menuSelection == 1)
 			{
 				// if options is selected then load the options game state
 				currentGameState = OPTIONS;
 			}
-			else if (GetAsyncKeyState(KEY_ENTER) && menu.menuSelection == 2)
+			else if (input.WasPressed(KEY_ENTER) && menu.menuSelection == 2)
 			{
 				// if quit is selected then the game will quite when enter is pressed
 				gameSequence.exitGame = true;
@@ -194,84 +216,27 @@ void Game::Update(float deltaTime)
 			// Sets the timer to be 0 when not in game as i dont want it to be counting up when the player isnt in game
 			gameSequence.runTime = 0.0f;
 
-			// Clear any previous images
-			ClearScreen(consoleBuffer);
-			// Draw the options screen to the buffer
-			WriteImageToBuffer(consoleBuffer, menu.CHARACTERS_OPTIONS, nullptr, SCREEN_HEIGHT, SCREEN_WIDTH, 0, 0);
-
-			// Display select option next to currently selected option
-			if (menu.optionsSelection == 0)
+			// Take the input of a or d and change selection appropriately, it wraps around at either end
+			if (input.WasPressed(KEY_D))
 			{
-				// position for sound on
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 49, 22);
+				menu.optionsSelection = (menu.optionsSelection + 1) % 3;
 			}
-			else if (menu.optionsSelection == 1)
+			else if (input.WasPressed(KEY_A))
 			{
-				// position for sound off
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 80, 22);
-			}
-			else if (menu.optionsSelection == 2)
-			{
-				// position for sound back
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 32);
-			}
-
-			// Take the input of a or d and move the icon and change selection appropriately
-			if (GetAsyncKeyState(KEY_D) && menu.optionsSelection == 0)
-			{
-				// if selected sound on, move icon to sound off and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 80, 22);
-				menu.optionsSelection = 1;
-			}
-			else if (GetAsyncKeyState(KEY_D) && menu.optionsSelection == 1)
-			{
-				// if selected sound off, move icon to back and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 32);
-				menu.optionsSelection = 2;
-			}
-			else if (GetAsyncKeyState(KEY_D) && menu.optionsSelection == 2)
-			{
-				// if selected sound back, move icon to sound on and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 49, 22);
-				menu.optionsSelection = 0;
+				menu.optionsSelection = (menu.optionsSelection + 2) % 3;
 			}
 
-			if (GetAsyncKeyState(KEY_A) && menu.optionsSelection == 0)
+			if (input.WasPressed(KEY_ENTER) && menu.optionsSelection == 0)
 			{
-				// if selected sound on, move icon to back and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 60, 32);
-				menu.optionsSelection = 2;
+				//if they have sound on selected and press enter, turn the sound on, it is saved in the background
+				settings.SetSoundOn(true);
 			}
-			else if (GetAsyncKeyState(KEY_A) && menu.optionsSelection == 1)
+			else if (input.WasPressed(KEY_ENTER) && menu.optionsSelection == 1)
 			{
-				// if selected sound off, move icon to sound on and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 49, 22);
-				menu.optionsSelection = 0;
+				//if they have sound off selected and press enter, turn the sound off, it is saved in the background
+				settings.SetSoundOn(false);
 			}
-			else if (GetAsyncKeyState(KEY_A) && menu.optionsSelection == 2)
-			{
-				// if selected back, move icon to sound off and change selection
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, 80, 22);
-				menu.optionsSelection = 1;
-			}
-
-			if (GetAsyncKeyState(KEY_ENTER) && menu.optionsSelection == 0)
-			{
-				//if they have sound on selected and press enter, replace the value in sound state file with the value of 1
-				std::ofstream soundStateTxt;
-				soundStateTxt.open("SoundState.txt");
-				soundStateTxt << std::to_string(1);
-				soundStateTxt.close();
-			}
-			else if (GetAsyncKeyState(KEY_ENTER) && menu.optionsSelection == 1)
-			{
-				//if they have sound off selected and press enter, replace the value in sound state file with the value of 0
-				std::ofstream soundStateTxt;
-				soundStateTxt.open("SoundState.txt");
-				soundStateTxt << std::to_string(0);
-				soundStateTxt.close();
-			}
-			else if (GetAsyncKeyState(KEY_ENTER) && menu.optionsSelection == 2)
+			else if (input.WasPressed(KEY_ENTER) && menu.optionsSelection == 2)
 			{
 				//if they have back selected and press enter, load the game menu state
 				currentGameState = MENU;
@@ -287,218 +252,384 @@ void Game::Update(float deltaTime)
 			if (!player.hasCrashed && !player.hasLanded)
 			{
 				// Increments run time, this will count how long the player has been playing for
-				// will reset state of moving left and right each frame
 				gameSequence.runTime += deltaTime;
-				player.isMovingLeft = false;
-				player.isMovingRight = false;
 			}
 
-			if (GetAsyncKeyState(KEY_ESC))
+			if (input.IsHeld(KEY_ESC))
 			{
 				//exit the game if they press esc
 				gameSequence.exitGame = true;
 			}
 
-			if (GetAsyncKeyState(KEY_ENTER) && (player.hasCrashed || player.hasLanded))
+			if (input.WasPressed(KEY_ENTER) && (player.hasCrashed || player.hasLanded))
 			{
 				if (gameSequence.playAgain)
 				{
 					//if they landed they can play again, this will then reset the player and reset fuel pickup and audio
-					player.Reset();
+					ResetPlayer();
 					gameSequence.playAgain = false;
 					fuel.fuelExists = false;
+					particles.Clear();
 					PlayAudio(); //this is called here so that it updates the fact that audio shouldnt be playing now
 				}
 				else
 				{
 					// if they crash then it will reset everything and load the menu game state
-					player.Reset();
+					ResetPlayer();
 					player.Refill();
 					ScoreReset();
 					fuel.fuelExists = false;
+					particles.Clear();
 					PlayAudio(); //this is called here so that it updates the fact that audio shouldnt be playing now
 					menu.menuSelection = 0;
 					currentGameState = MENU;
+					break;
 				}
 			}
 
-			if (!player.hasLanded && !player.hasCrashed)
+			// Read the controls once for this frame, the physics steps below all use the same input
+			playerInput.thrust = input.IsHeld(KEY_W);
+			playerInput.left = input.IsHeld(KEY_A);
+			playerInput.right = input.IsHeld(KEY_D);
+
+			// Run the physics at a fixed rate no matter what the frame rate is, any time left over is carried on to the next frame.
+			// If we have fallen a long way behind then the extra time is dropped so that the game slows down instead of locking up
+			ProfileScope simulateScope(profiler, PROFILE_SIMULATE);
+			gameSequence.simulationTime += deltaTime;
+			int steps = 0;
+			while (gameSequence.simulationTime >= SIMULATION_STEP && steps < MAX_SIMULATION_STEPS)
 			{
-				if (GetAsyncKeyState(KEY_W) && player.fuel > 0.0f)
-				{
-					// the lander will accelerate upwards if they have fuel
-					player.isAccelerating = true;
-					// spend fuel
-					player.fuel -= FUEL_CONSUMPTION_RATE;
-				}
-				if (GetAsyncKeyState(KEY_A) && player.fuel > 0.0f)
-				{
-					//move left, use fuel, set moving left as true
-					player.xPos--;
-					player.fuel -= FUEL_CONSUMPTION_RATE;
-					player.isMovingLeft = true;
+				Simulate(SIMULATION_STEP);
+				gameSequence.simulationTime -= SIMULATION_STEP;
+				steps++;
+			}
+			if (steps == MAX_SIMULATION_STEPS)
+			{
+				gameSequence.simulationTime = 0.0f;
+			}
 
-				}
-				if (GetAsyncKeyState(KEY_D) && player.fuel > 0.0f)
-				{
-					// move right, use fuel, set moving right as true
-					player.xPos++;
-					player.fuel -= FUEL_CONSUMPTION_RATE;
-					player.isMovingRight = true;
-				}
-				// Will play thruster sound if the lander is moving
-				PlayAudio();
+			// The particles only look nice so they move by the frame time rather than in fixed steps
+			particles.Update(deltaTime, 12.0f, 1.5f);
+			simulateScope.End();
 
-				// sets the players acceleration
-				if (player.isAccelerating)
-				{
-					// This is actually velocity as velocity is acceleration * time but i kept as this cos i didnt want to screw other things up
-					player.acceleration += (ACCELERATION_RATE * deltaTime);
-				}
-				else
+			// Will play thruster sound if the lander is moving, and stops it as soon as they land or crash
+			ProfileScope audioScope(profiler, PROFILE_AUDIO);
+			PlayAudio();
+			audioScope.End();
+
+			// The pickups are placed on the screen, over a planet the planet has its own at fixed places instead
+			if (!fuel.fuelExists && !planetMode)
+			{
+				//if their isnt a fuel pickup on the map then generate random coordinates and place it there, set it as existing now
+				int fuelX = RandIntLength();
+				int fuelY = RandIntHeight();
+				entities.ClearPickups();
+				entities.AddPickup(fuelX, fuelY, fuel.FUEL_AMOUNT, fuelSprite);
+				fuel.fuelExists = true;
+			}
+
+			if (player.hasCrashed)
+			{
+				//if the player has crashed then the explosion animation plays, this is the timer for which frame of it to show
+				explosion.flashTimer += deltaTime;
+				if (explosion.flashTimer >= 1.5f)
 				{
-					player.acceleration -= (DECELERATION_RATE * deltaTime);
+					explosion.flashTimer = 0.0f;
 				}
+			}
+			else if (player.hasLanded)
+			{
+				gameSequence.playAgain = true; //set play again as true because they have landed succesfully
+			}
+			break;
+		}
 
-				// Reset acceleration flag
-				player.isAccelerating = false;
+		default:
+		{
+			break;
+		}
+	}
+}
 
-				// Clamp our acceleration
-				player.acceleration = ClampFloat(player.acceleration, 0.0f, 1.5f);
+/// <summary>
+/// This function moves the lander forward by one fixed physics step, it checks for landing, crashing and picking up fuel
+/// </summary>
+/// <param name="step"> The length of the step in seconds, this is always SIMULATION_STEP </param>
+void Game::Simulate(float step)
+{
+	// Keep where the lander was at the start of the step so the drawing can blend between the two
+	player.previousXPos = player.xPos;
+	player.previousYPos = player.yPos;
 
-				if (player.acceleration >= 0.5f)
-				{
-					//increment y position of lander (it starts at 0 at top so - is increasing height)
-					player.yPos--;
-				}
-				else if (player.acceleration < 0.5f)
-				{
-					//decrement y position of lander
-					player.yPos++;
-				}
+	if (player.hasLanded || player.hasCrashed)
+	{
+		return;
+	}
+
+	// The movement is shared with the batch simulator so that both behave the same
+	bool isThrusting = playerInput.thrust && player.fuel > 0.0f;
+	// Over a planet the lander wraps around the whole planet rather than the screen, and can go as low as the bottom of it
+	PhysicsTuning tuning;
+	if (planetMode)
+	{
+		tuning.wrapWidth = (float)world.GetWidth();
+		tuning.lowestY = (float)(world.GetHeight() - Player::HEIGHT);
+	}
+	MoveLander(player, playerInput, step, tuning);
+	EmitThrusterParticles(isThrusting);
+
+	FuelPickup(); //call the fuel pickup function which will check if the player can pickup the fuel
+
+	// Follow the legs along the whole move rather than only looking where they ended up, so nothing thin can be passed through.
+	// If they touched something the lander is put back where it touched.
+	TerrainContact contact = planetMode
+		? world.SweepLander(player.previousXPos, player.previousYPos, player.xPos, player.yPos, player.velocityY)
+		: terrain.SweepLander(player.previousXPos, player.previousYPos, player.xPos, player.yPos, player.velocityY);
+	LANDING_RESULT landing = contact.result;
+	if (landing != LANDING_NONE)
+	{
+		player.xPos = contact.xPos;
+		player.yPos = contact.yPos;
+	}
+	if (landing == LANDING_LANDED)
+	{
+		// if it is a platform under the lander and they arent going too fast then tehy have landed and it calls addscore()
+		player.hasLanded = true;
+		AddScore();
+	}
+	else if (landing == LANDING_CRASHED)
+	{
+		//otherwise they have crashed
+		player.hasCrashed = true;
+
+		// Throw debris out from the middle of the lander, mostly upwards so it arcs back down
+		ParticleBurst debris;
+		debris.x = player.xPos + player.WIDTH * 0.5f;
+		debris.y = player.yPos + player.HEIGHT * 0.5f;
+		debris.velocityY = -6.0f;
+		debris.spread = 14.0f;
+		debris.minLife = 0.8f;
+		debris.maxLife = 2.5f;
+		debris.ramp = PARTICLE_RAMP_EXPLOSION;
+		particles.Emit(debris, 600, random[RANDOM_STREAM_EFFECTS]);
+	}
+}
+
+/// <summary>
+/// This function will build the frame for the current game state in to the buffer and then kick the draw in the buffer,
+/// only the cells that changed since the last draw get sent to the console
+/// </summary>
+void Game::Draw()
+{
+	// The console is only checked for a new size here, so the buffers are never reallocated in the middle of a frame
+	int newWidth = 0;
+	int newHeight = 0;
+	if (platform->PollResize(newWidth, newHeight))
+	{
+		Resize(newWidth, newHeight);
+	}
+
+	// Everything up to the HUD is composing, the text and the present are timed on their own
+	ProfileScope composeScope(profiler, PROFILE_COMPOSE);
+	switch (currentGameState)
+	{
+		case SPLASH:
+		{
+			compositor.SetBackground(&blankLayer);
+			compositor.BeginFrame(consoleBuffer.data(), screenWidth, screenHeight);
+
+			// Draw splash image
+			compositor.DrawSprite(splash.SPRITE, (screenWidth / 2) - (splash.WIDTH / 2), (screenHeight / 2) - (splash.HEIGHT / 2));
+			break;
+		}
+
+		case MENU:
+		{
+			// The menu is a cached layer, so only the parts that were drawn over last frame need putting back
+			compositor.SetBackground(&menuLayer);
+			compositor.BeginFrame(consoleBuffer.data(), screenWidth, screenHeight);
+
+			// if blink timer is more than 0.5 or less than 2, display the highscore text, this creates a blinking animation for the highscore text
+			if (menu.blinkTimer >= 0.5f && menu.blinkTimer < 2.0f)
+			{
+				highScoreField.SetValue((float)menu.highScore);
+				compositor.DrawHudField(highScoreField, menuView.ToScreenX(65), menuView.ToScreenY(13));
+			}
+
+			// This displays the selection sprite at the position correlating to the currently selected option
+			if (menu.menuSelection == 0)
+			{
+				// draw select icon to the position for having play selected
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(60), menuView.ToScreenY(15));
+			}
+			else if (menu.menuSelection == 1)
+			{
+				// draw select icon to the position for having options selected
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(55), menuView.ToScreenY(21));
+			}
+			else if (menu.menuSelection == 2)
+			{
+				// draw select icon to the position for having quit selected
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(62), menuView.ToScreenY(27));
+			}
+			break;
+		}
 
-				// Clamp the position of the lander so it cant go beyond the borders
-				player.xPos = ClampInt(player.xPos, 0, (SCREEN_WIDTH - player.WIDTH));
-				LevelWrap(); //call the level wrap function
-				player.yPos = ClampInt(player.yPos, 0, (SCREEN_HEIGHT - player.HEIGHT));
+		case OPTIONS:
+		{
+			// The options screen is a cached layer, so only the parts that were drawn over last frame need putting back
+			compositor.SetBackground(&optionsLayer);
+			compositor.BeginFrame(consoleBuffer.data(), screenWidth, screenHeight);
 
-				// Get the two characters under the landing gear
-				char bottomLeftChar = background.CHARACTERS[(player.xPos + (player.WIDTH - 3)) +SCREEN_WIDTH * (player.yPos + (player.HEIGHT - 1))];
-				char bottomRightChar = background.CHARACTERS[(player.xPos + (player.WIDTH - 2)) + SCREEN_WIDTH * (player.yPos + (player.HEIGHT - 1))];
+			// Display select option next to currently selected option
+			if (menu.optionsSelection == 0)
+			{
+				// position for sound on
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(49), menuView.ToScreenY(22));
+			}
+			else if (menu.optionsSelection == 1)
+			{
+				// position for sound off
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(80), menuView.ToScreenY(22));
+			}
+			else if (menu.optionsSelection == 2)
+			{
+				// position for sound back
+				compositor.DrawSprite(player.SPRITE_DEFAULT, menuView.ToScreenX(60), menuView.ToScreenY(32));
+			}
+			break;
+		}
+
+		case PLAY:
+		{
+			// The physics is usually part way between two steps when we draw, so blend between where the lander was and where it is now
+			float alpha = gameSequence.simulationTime / SIMULATION_STEP;
+			int drawX = player.GetDrawX(alpha);
+			int drawY = player.GetDrawY(alpha);
+			// Where the particles are drawn from and how much they are scaled, the same as the background
+			int particleOffsetX = cameraX;
+			int particleOffsetY = cameraY;
+			int particleScale = 1;
 
-				// Landed?
-				if (bottomLeftChar == '_' && bottomRightChar == '_' && player.velocityY > -0.2f)
+			if (planetMode)
+			{
+				// Take in any chunks that have finished, then move the camera if the lander is getting near the edge of the view.
+				// The view is only copied out of the chunks again when it has changed, the rest of the time it is a cached layer
+				// like the level.
+				world.BeginFrame();
+				FollowLander(drawX, drawY);
+				if (planetViewStale)
 				{
-					// if it is a platform under the lander and they arent going too fast then tehy have landed and it calls addscore()
-					player.hasLanded = true;
-					AddScore();
+					planetViewStale = !world.Render(planetLayer.cells.data(), screenWidth, screenHeight, cameraX, cameraY);
+					compositor.Invalidate();
 				}
-				else if (bottomLeftChar != ' ' && bottomLeftChar != '*' && bottomLeftChar != '.' || bottomRightChar != ' ' && bottomRightChar != '*' && bottomRightChar != '.')
+				compositor.SetBackground(&planetLayer);
+
+				// Everything below is drawn on the screen, so it is moved by the camera
+				drawX = world.WrapX(drawX - cameraX);
+				drawY -= cameraY;
+			}
+			else
+			{
+				// If the screen is smaller than the level it follows the lander, the level only needs mapping again when it moves
+				if (levelView.Follow(drawX, drawY, Player::WIDTH, Player::HEIGHT))
 				{
-					//otherwise they have crashed
-					player.hasCrashed = true;
+					levelView.MapLayer(levelArt, backgroundLayer);
+					compositor.Invalidate();
 				}
-			}
-
-			// Clear the previous 'frame' before we start build the next one
-			ClearScreen(consoleBuffer);
+				compositor.SetBackground(&backgroundLayer);
 
-			// Draw the background image
-			WriteImageToBuffer(consoleBuffer, background.CHARACTERS, nullptr, SCREEN_HEIGHT, SCREEN_WIDTH, 0, 0);
+				// Everything below is drawn on the screen, so it is moved and scaled the same way as the level
+				drawX = levelView.SpriteToScreenX(drawX, Player::WIDTH);
+				drawY = levelView.SpriteToScreenY(drawY, Player::HEIGHT);
+				particleOffsetX = levelView.GetOffsetX();
+				particleOffsetY = levelView.GetOffsetY();
+				particleScale = levelView.GetScale();
+			}
 
-			FuelPickup(); //call the fuel pickup function which will check if the player can pickup the fuel
+			// Start the frame from the cached background, this only puts back the parts that the sprites and text covered last frame
+			compositor.BeginFrame(consoleBuffer.data(), screenWidth, screenHeight);
 
-			if (!fuel.fuelExists)
+			// Draw every pickup that hasnt been collected yet, they are taken out of the store when they are
+			const PickupColumns& pickups = entities.pickups;
+			for (int i = 0; i < pickups.Count(); i++)
 			{
-				//if their isnt a fuel pickup on the map then generate random coordinates and place it there, set it as existing now
-				fuel.fuelX = RandIntLength();
-				fuel.fuelY = RandIntHeight();
-				fuel.fuelExists = true;
+				SpriteView sprite = entities.sprites.Get(pickups.sprite[i]);
+				compositor.DrawSpriteView(sprite, levelView.SpriteToScreenX(pickups.x[i], sprite.width), levelView.SpriteToScreenY(pickups.y[i], sprite.height));
 			}
-
-			if (!player.fuelCollected)
+			if (planetMode)
 			{
-				//if the fuel hasnt been collected, continue to draw it each for each frame
-				WriteImageToBuffer(consoleBuffer, fuel.CHARACTERS, fuel.COLOURS, fuel.HEIGHT, fuel.WIDTH, fuel.fuelX, fuel.fuelY);
+				DrawPlanetPickups();
 			}
-			
+
+			// The particles go behind the lander so the exhaust comes out from under it
+			particles.Draw(compositor, consoleBuffer.data(), particleOffsetX, particleOffsetY, planetMode ? world.GetWidth() : 0, particleScale);
+
 			if (player.hasCrashed)
 			{
 				//if the player has crashed then display the explosion animation
-				static float explosionFlashTimer = 0.0f;
-
-				explosionFlashTimer += deltaTime;
-				
-				if (explosionFlashTimer >= 0.5f && explosionFlashTimer < 1.0f)
+				if (explosion.flashTimer >= 0.5f && explosion.flashTimer < 1.0f)
 				{
 					// Draw first frame of explosion
-					WriteImageToBuffer(consoleBuffer, explosion.CHARACTERS_SMALL, explosion.COLOURS, explosion.HEIGHT, explosion.WIDTH, player.xPos, player.yPos);
-					
+					compositor.DrawSprite(explosion.SPRITE_SMALL, drawX, drawY);
 				}
-				else if (explosionFlashTimer >= 1.0f)
+				else if (explosion.flashTimer >= 1.0f)
 				{
 					// Draw second frame of explosion
-					WriteImageToBuffer(consoleBuffer, explosion.CHARACTERS_BIG, explosion.COLOURS, explosion.HEIGHT, explosion.WIDTH, player.xPos, player.yPos);
-					explosionFlashTimer = 0.0f;
+					compositor.DrawSprite(explosion.SPRITE_BIG, drawX, drawY);
 				}
 				else
 				{
 					// Draw empty Characters
-					WriteImageToBuffer(consoleBuffer, explosion.EMPTY_CHARACTERS, explosion.COLOURS, explosion.HEIGHT, explosion.WIDTH, player.xPos, player.yPos);
+					compositor.DrawSprite(explosion.SPRITE_EMPTY, drawX, drawY);
 				}
 
 				// Write the text to the screen to tell player what to do
-				WriteTextToBuffer(consoleBuffer, "COMMAND, MISSION HAS FAILED!", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
-				WriteTextToBuffer(consoleBuffer, "Press 'Enter' to return to menu...", SCREEN_WIDTH / 2, (SCREEN_HEIGHT / 2) + 1);
+				compositor.DrawText("COMMAND, MISSION HAS FAILED!", screenWidth / 2, screenHeight / 2);
+				compositor.DrawText("Press 'Enter' to return to menu...", screenWidth / 2, (screenHeight / 2) + 1);
 			}
 			else if(player.hasLanded)
 			{
 				// Draw player image
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, player.xPos, player.yPos);
+				compositor.DrawSprite(player.SPRITE_DEFAULT, drawX, drawY);
 
 				// Write the text to the screen to tell the player what to do
-				WriteTextToBuffer(consoleBuffer, "COMMAND, WE ARE IN THE CLEAR!", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
-				WriteTextToBuffer(consoleBuffer, "Press 'Enter' to continue", SCREEN_WIDTH / 2, (SCREEN_HEIGHT / 2) + 1);
-
-				gameSequence.playAgain = true; //set play again as true because they have landed succesfully
+				compositor.DrawText("COMMAND, WE ARE IN THE CLEAR!", screenWidth / 2, screenHeight / 2);
+				compositor.DrawText("Press 'Enter' to continue", screenWidth / 2, (screenHeight / 2) + 1);
 			}
 
 			//displays the different player sprites
 			else if(!player.isMovingLeft && !player.isMovingRight)
 			{
 				// Draw default sprite if not moving left or right
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_DEFAULT, player.COLOURS_DEFAULT, player.HEIGHT, player.WIDTH, player.xPos, player.yPos);
+				compositor.DrawSprite(player.SPRITE_DEFAULT, drawX, drawY);
 			}
 			else if (player.isMovingLeft)
 			{
 				// Draw the sprite for moving left if they are moving left
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_LEFT, player.COLOURS_LEFT, player.HEIGHT, player.WIDTH, player.xPos, player.yPos);
+				compositor.DrawSprite(player.SPRITE_LEFT, drawX, drawY);
 			}
 			else if (player.isMovingRight)
 			{
 				// Draw the sprite for moving right if they are moving right
-				WriteImageToBuffer(consoleBuffer, player.CHARACTERS_RIGHT, player.COLOURS_RIGHT, player.HEIGHT, player.WIDTH, player.xPos, player.yPos);
-			}
-			
-			if (player.acceleration < 0.5)
-			{
-				// as the lander will be going down, this changes the value to be a negative in order to display that the velocity is downwards
-				// the value of -0.5f is used here as it is the maximum negative velocity that can be achieved
-				player.velocityY = -0.5f + player.acceleration;
-			}
-			else
-			{
-				// as the lander will be going up, the acceleration is displayed as the number minus the range in which it goes down
-				// This is because in real life the lander would not move up or down if velocity is 0 so im trying to establish a point at which it is determined between positive and negative
-				player.velocityY = player.acceleration - 0.5f;
+				compositor.DrawSprite(player.SPRITE_RIGHT, drawX, drawY);
 			}
 
-			// Draw UI text
-			WriteTextToBuffer(consoleBuffer, "SCORE: " + std::to_string(player.currentScore), 1, 0); // Display their current score	
-			WriteTextToBuffer(consoleBuffer, "TIME: " + std::to_string(gameSequence.runTime), 1, 1); // Display how long they've been playing
-			WriteTextToBuffer(consoleBuffer, "Y VELOCITY: " + std::to_string(player.velocityY), 1, 2); // Display their vertical velocity
-			WriteTextToBuffer(consoleBuffer, "FUEL: " + std::to_string(player.fuel), 1, 3); // Display their fuel level
-			WriteTextToBuffer(consoleBuffer, "ALTITUDE: " + std::to_string(SCREEN_HEIGHT - player.yPos) + "M", SCREEN_WIDTH - 14, 0); // Display their current alitude at top right of screen
+			// Draw UI text, the fields only rebuild their text when the value has changed since the last frame
+			composeScope.End();
+			ProfileScope textScope(profiler, PROFILE_TEXT);
+			scoreField.SetValue((float)player.currentScore);
+			timeField.SetValue(gameSequence.runTime);
+			velocityField.SetValue(player.velocityY);
+			fuelField.SetValue(player.fuel);
+			// The altitude is how high the legs are above the ground under them, not just above the bottom of the screen
+			int altitude = planetMode ? world.GetAltitude(player.GetCellX(), player.GetCellY()) : terrain.GetAltitude(player.GetCellX(), player.GetCellY());
+			altitudeField.SetValue((float)altitude);
+			compositor.DrawHudField(scoreField, 1, 0); // Display their current score
+			compositor.DrawHudField(timeField, 1, 1); // Display how long they've been playing
+			compositor.DrawHudField(velocityField, 1, 2); // Display their vertical velocity
+			compositor.DrawHudField(fuelField, 1, 3); // Display their fuel level
+			compositor.DrawHudField(altitudeField, screenWidth - 14, 0); // Display their current alitude at top right of screen
 			break;
 		}
 
@@ -507,77 +638,189 @@ void Game::Update(float deltaTime)
 			break;
 		}
 	}
+
+	composeScope.End();
+
+	// The overlay goes along the bottom over whatever screen we are on, it shows the times and counters as of the last few frames
+	if (profiler.IsOverlayVisible())
+	{
+		ProfileScope textScope(profiler, PROFILE_TEXT);
+		for (int row = 0; row < Profiler::OVERLAY_ROWS; row++)
+		{
+			compositor.DrawText(profiler.GetOverlayText(row), profiler.GetOverlayLength(row), 0, screenHeight - Profiler::OVERLAY_ROWS + row);
+		}
+	}
+
+	ProfileScope presentScope(profiler, PROFILE_PRESENT);
+	PresentStats presentStats = platform->Present(consoleBuffer.data(), screenWidth, screenHeight);
+	presentScope.End();
+	// How much went to the console, this shows how well only sending the changes is working
+	profiler.RecordCounter(PROFILE_PRESENT_BYTES, (float)presentStats.bytesWritten);
+	profiler.RecordCounter(PROFILE_PRESENT_CELLS, (float)presentStats.cellsWritten);
+
+	// If a key was pressed since the last draw then this is the first frame that can show it
+	if (undrawnInputTime >= 0.0)
+	{
+		profiler.RecordCounter(PROFILE_INPUT_LATENCY, (float)(platform->GetTime() - undrawnInputTime));
+		undrawnInputTime = -1.0;
+	}
+
+	profiler.EndFrame();
 }
 
 /// <summary>
-/// This function will kick the draw in the buffer
+/// This function will find the platform that the lander landed on and will multiply the base score by that platform's multiplier
 /// </summary>
-void Game::Draw()
+void Game::AddScore()
 {
-	WriteConsoleOutputA(wHnd, consoleBuffer, characterBufferSize, characterPosition, &consoleWriteArea);
+	// The multipliers were worked out from the '2's and '4's under the platforms when the level was built, so nothing is scanned here
+	player.currentScore += planetMode ? world.GetLandingScore(player.GetCellX(), player.GetCellY()) : terrain.GetLandingScore(player.GetCellX(), player.GetCellY());
 }
 
 /// <summary>
-/// This function will check for a number character under the platform that the lander lands on and will multiply the base score by that number
+/// This function will be called when the game is over and it will check the current score against the highscore
+/// it will then either replace the highscore and clear current score, or will just clear current score if it is not a new highscore
 /// </summary>
-void Game::AddScore()
+void Game::ScoreReset()
 {
-	// Get all the characters for the left of the platform
-	char bottomLeftChar = background.CHARACTERS[player.xPos + SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
-	char bottomLeftChar1 = background.CHARACTERS[player.xPos + 1 + SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
-	char bottomLeftChar2 = background.CHARACTERS[player.xPos + 2 +SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
-	// Get all the characters for the right of the platform
-	char bottomRightChar = background.CHARACTERS[(player.xPos + (player.WIDTH - 1)) + SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
-	char bottomRightChar1 = background.CHARACTERS[(player.xPos + (player.WIDTH - 2)) + SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
-	char bottomRightChar2 = background.CHARACTERS[(player.xPos + (player.WIDTH - 3)) + SCREEN_WIDTH * (player.yPos + (player.HEIGHT))];
+	// If the current score is higher than the highscore it becomes the new highscore, the file is written in the background
+	settings.SubmitScore(player.currentScore);
+	
+	// The current score is then reset
+	player.currentScore = 0;
+}
 
-	// If their is a '2' under the platform then the base score will be multiplied by 2 and added to current score
-	if (bottomLeftChar == '2' || bottomLeftChar1 == '2' || bottomLeftChar2 == '2' || bottomRightChar == '2' || bottomRightChar1 == '2' || bottomRightChar2 == '2')
+/// <summary>
+/// Sizes everything that depends on the console, this is the only place the screen's buffers and layers are allocated so a
+/// resize costs one allocation of each rather than any per frame
+/// </summary>
+/// <param name="width"> The new width of the console in characters </param>
+/// <param name="height"> The new height of the console in characters </param>
+void Game::Resize(int width, int height)
+{
+	screenWidth = width > 1 ? width : 1;
+	screenHeight = height > 1 ? height : 1;
+	consoleBuffer.assign(screenWidth * screenHeight, Cell());
+
+	// Work out where the level and menus go, then map them on to the screen once so each frame only copies them
+	levelView.Resize(screenWidth, screenHeight, LEVEL_WIDTH, LEVEL_HEIGHT, true);
+	menuView.Resize(screenWidth, screenHeight, LEVEL_WIDTH, LEVEL_HEIGHT, false);
+	levelView.MapLayer(levelArt, backgroundLayer);
+	menuView.MapLayer(menuArt, menuLayer);
+	menuView.MapLayer(optionsArt, optionsLayer);
+	blankLayer.Build(nullptr, nullptr, screenHeight, screenWidth);
+	particles.Resize(screenWidth, screenHeight);
+
+	// The planet view is copied out of the chunks again at the new size, the camera is kept but pulled back inside the planet
+	if (planetMode)
 	{
-		player.currentScore += BASE_SCORE * 2;
+		planetLayer.Build(nullptr, nullptr, screenHeight, screenWidth);
+		cameraY = ClampInt(cameraY, 0, GetLowestCameraY());
+		planetViewStale = true;
 	}
-	// If their is a '4' under the platform then the base score will be multiplied by 4 and added to the current score
-	else if (bottomLeftChar == '4' || bottomLeftChar1 == '4' || bottomLeftChar2 == '4' || bottomRightChar == '4' || bottomRightChar1 == '4' || bottomRightChar2 == '4')
+
+	// The layers have all been rebuilt, so the whole of the next frame comes from them
+	compositor.Invalidate();
+}
+
+/// <summary>
+/// The furthest down the camera can go over a planet, if the screen is taller than the planet it stays at the top
+/// </summary>
+int Game::GetLowestCameraY()
+{
+	return world.GetHeight() > screenHeight ? world.GetHeight() - screenHeight : 0;
+}
+
+/// <summary>
+/// Puts the lander back at the start for another go. Over a planet it starts a little way above the ground under it, as the
+/// ground can be anywhere, and the camera is put back on it.
+/// </summary>
+void Game::ResetPlayer()
+{
+	player.Reset();
+	if (!planetMode)
 	{
-		player.currentScore += BASE_SCORE * 4;
+		return;
 	}
+
+	int ground = world.GetHeight();
+	for (int column = 0; column < Player::WIDTH; column++)
+	{
+		int row = world.GetSurfaceRow(player.GetCellX() + column);
+		ground = row < ground ? row : ground;
+	}
+	player.yPos = (float)ClampInt(ground - Player::HEIGHT - 20, 0, world.GetHeight() - Player::HEIGHT);
+	player.previousYPos = player.yPos;
+	// A new lander gets all of the pickups back, the same as a new one is placed on a level
+	world.ResetPickups();
+
+	cameraX = world.WrapX(player.GetCellX() - screenWidth / 2);
+	cameraY = ClampInt(player.GetCellY() - screenHeight / 2, 0, GetLowestCameraY());
+	planetViewStale = true;
 }
 
 /// <summary>
-/// This function will be called when the game is over and it will check the current score against the highscore in the file
-/// it will then either replace the value and clear current score, or will just clear current score if it is not a new highscore
+/// Draws the planet's pickups that are in view and havent been collected, only the columns of chunks the view covers are looked at
 /// </summary>
-void Game::ScoreReset()
+void Game::DrawPlanetPickups()
 {
-	bool newHighScore = false;
+	const int firstColumn = cameraX / CHUNK_SIZE;
+	const int lastColumn = (cameraX + screenWidth - 1) / CHUNK_SIZE;
+	SpriteView sprite = entities.sprites.Get(fuelSprite);
+	for (int column = firstColumn; column <= lastColumn; column++)
+	{
+		int pickupX;
+		int pickupY;
+		if (world.GetPickup(column % world.GetWidthInChunks(), pickupX, pickupY))
+		{
+			compositor.DrawSpriteView(sprite, world.WrapX(pickupX - cameraX), pickupY - cameraY);
+		}
+	}
+}
 
-	// opens and reads the highscore file
-	int score;
-	std::ifstream highScoreTxt("HighScore.txt", std::ios::in);
-	highScoreTxt >> score;
+/// <summary>
+/// Moves the camera over the planet so the lander stays at least a third of the screen in from the edges. It only moves when
+/// it has to, as every time it moves the whole view has to be drawn again.
+/// </summary>
+/// <param name="drawX"> Where the lander is being drawn on the planet </param>
+/// <param name="drawY"> Where the lander is being drawn on the planet </param>
+void Game::FollowLander(int drawX, int drawY)
+{
+	const int marginX = screenWidth / 3;
+	const int marginY = screenHeight / 3;
 
-	// Compares current score with the highscore, if it is higher then it will set the boolean of new highscore as true
-	if (player.currentScore > score)
+	// Where the lander is on the screen, the short way round if the camera is across the edge of the planet from it
+	int screenX = world.WrapX(drawX - cameraX);
+	screenX = screenX > world.GetWidth() / 2 ? screenX - world.GetWidth() : screenX;
+	int screenY = drawY - cameraY;
+
+	int newCameraX = cameraX;
+	if (screenX < marginX)
+	{
+		newCameraX = drawX - marginX;
+	}
+	else if (screenX > screenWidth - Player::WIDTH - marginX)
+	{
+		newCameraX = drawX - (screenWidth - Player::WIDTH - marginX);
+	}
+	int newCameraY = cameraY;
+	if (screenY < marginY)
 	{
-		newHighScore = true;
+		newCameraY = drawY - marginY;
 	}
-	else
+	else if (screenY > screenHeight - Player::HEIGHT - marginY)
 	{
-		newHighScore = false;
+		newCameraY = drawY - (screenHeight - Player::HEIGHT - marginY);
 	}
-	highScoreTxt.close(); // closes the file
+	newCameraX = world.WrapX(newCameraX);
+	newCameraY = ClampInt(newCameraY, 0, GetLowestCameraY());
 
-	// If their is a new highscore then the contents of the highscore file will be replaced with the current score
-	if (newHighScore)
+	if (newCameraX != cameraX || newCameraY != cameraY)
 	{
-		std::ofstream highScoreTxt;
-		highScoreTxt.open("HighScore.txt");
-		highScoreTxt << std::to_string(player.currentScore);
-		highScoreTxt.close();
+		cameraX = newCameraX;
+		cameraY = newCameraY;
+		planetViewStale = true;
 	}
-	
-	// The current score is then reset
-	player.currentScore = 0;
 }
 
 /// <summary>
@@ -586,10 +829,7 @@ void Game::ScoreReset()
 /// <returns> Returns a random number </returns>
 int Game::RandIntLength()
 {
-	int iSecret = -1;
-	srand(time(NULL)); //seed the random number
-	iSecret = rand() % 99 + 0; //generate the random number
-	return iSecret;
+	return random[RANDOM_STREAM_FUEL].NextInt(99); //generate the random number
 }
 
 /// <summary>
@@ -598,10 +838,7 @@ int Game::RandIntLength()
 /// <returns> Returns a random number </returns>
 int Game::RandIntHeight()
 {
-	int iSecret = -1;
-	srand(time(NULL)); //seed the random number
-	iSecret = rand() % 39 + 0; //generate the random number
-	return iSecret;
+	return random[RANDOM_STREAM_FUEL].NextInt(39); //generate the random number
 }
 
 /// <summary>
@@ -609,28 +846,63 @@ int Game::RandIntHeight()
 /// </summary>
 void Game::FuelPickup()
 {
-	if (player.xPos == fuel.fuelX && player.yPos == fuel.fuelY)
+	// This is checked every physics step now, so make sure the same pickup cant be collected more than once. A planet has
+	// a pickup in every column of chunks and remembers which have gone, so there any number can be collected.
+	if (player.fuelCollected && !planetMode)
 	{
-		// If the player lander is in same position of the fuel then it will add fuel to the players count and set the fuel as collected.
-		player.fuel += 25.0f;
-		player.fuelCollected = true; // This will make it so the fuel vanishes after collection due to a check higher up in the code.
+		return;
+	}
+
+	// If the player lander is in same position of the fuel then it will add fuel to the players count and set the fuel as collected.
+	// Collecting it takes it out of the entity store, so it isnt drawn any more. Over a planet the planet keeps track of them.
+	float collected = planetMode
+		? (world.CollectPickupAt(player.GetCellX(), player.GetCellY()) ? fuel.FUEL_AMOUNT : 0.0f)
+		: entities.CollectPickupAt(player.GetCellX(), player.GetCellY());
+	if (collected > 0.0f)
+	{
+		player.fuel += collected;
+		player.fuelCollected = true;
 	}
 }
 
 /// <summary>
-/// This function, when called, will allow the player to move off one side and appear on the other side.
+/// Puts out a few exhaust particles for each thruster that is firing, this is called every physics step so the amount
+/// doesnt depend on the frame rate
 /// </summary>
-void Game::LevelWrap()
+/// <param name="isThrusting"> If the main engine fired this step </param>
+void Game::EmitThrusterParticles(bool isThrusting)
 {
-	// if the player moves off the right hand side, then they will appear on the left
-	if (player.xPos == (SCREEN_WIDTH - player.WIDTH))
+	ParticleBurst exhaust;
+	exhaust.spread = 1.5f;
+	exhaust.minLife = 0.25f;
+	exhaust.maxLife = 0.6f;
+	exhaust.ramp = PARTICLE_RAMP_EXHAUST;
+
+	if (isThrusting)
 	{
-		player.xPos = 0;
+		// Out of the bottom, between the legs
+		exhaust.x = player.xPos + player.WIDTH * 0.5f;
+		exhaust.y = player.yPos + player.HEIGHT;
+		exhaust.velocityX = 0.0f;
+		exhaust.velocityY = 10.0f;
+		particles.Emit(exhaust, 4, random[RANDOM_STREAM_EFFECTS]);
 	}
-	//vice versa
-	else if (player.xPos == 0)
+	if (player.isMovingLeft)
 	{
-		player.xPos = SCREEN_WIDTH - player.WIDTH;
+		// Moving left means the jet on the right hand side is firing
+		exhaust.x = player.xPos + player.WIDTH;
+		exhaust.y = player.yPos + 1.0f;
+		exhaust.velocityX = 10.0f;
+		exhaust.velocityY = 0.0f;
+		particles.Emit(exhaust, 2, random[RANDOM_STREAM_EFFECTS]);
+	}
+	if (player.isMovingRight)
+	{
+		exhaust.x = player.xPos - 0.01f;
+		exhaust.y = player.yPos + 1.0f;
+		exhaust.velocityX = -10.0f;
+		exhaust.velocityY = 0.0f;
+		particles.Emit(exhaust, 2, random[RANDOM_STREAM_EFFECTS]);
 	}
 }
 
@@ -639,22 +911,27 @@ void Game::LevelWrap()
 /// </summary>
 void Game::PlayAudio()
 {
-	// Opens the sound state file which contains a value that determines if sound should be on or off
-	int soundState;
-	std::ifstream soundStateTxt("SoundState.txt", std::ios::in);
-	soundStateTxt >> soundState;
-
-	// The following was used to get this working
-	// https://stackoverflow.com/questions/21034935/playsound-in-c
+	// The lander is thrusting if the main engine is firing (the same check Simulate does) or either side jet is
+	bool isThrusting = (playerInput.thrust && player.fuel > 0.0f) || player.isMovingLeft || player.isMovingRight;
 
 	// if the player is moving and they have sound on, then play the thruster sound effect
-	if ((player.isAccelerating || player.isMovingLeft || player.isMovingRight) && soundState == 1)
+	SetThrusterPlaying(isThrusting && !player.hasCrashed && !player.hasLanded && settings.IsSoundOn());
+}
+
+/// <summary>
+/// Starts or stops the looping thruster sound, the mixer is only told when it actually changes so the sound isnt restarted every update
+/// </summary>
+/// <param name="playing"> If the thruster should be heard </param>
+void Game::SetThrusterPlaying(bool playing)
+{
+	if (playing && thrusterVoice == INVALID_AUDIO_ID)
 	{
-		PlaySound(TEXT("Thruster.wav"), NULL, SND_ASYNC);
+		thrusterVoice = audio.Play(thrusterSound, true);
 	}
-	else
+	else if (!playing && thrusterVoice != INVALID_AUDIO_ID)
 	{
-		PlaySound(NULL, 0, 0);
+		audio.Stop(thrusterVoice);
+		thrusterVoice = INVALID_AUDIO_ID;
 	}
 }
 
@@ -665,4 +942,123 @@ void Game::PlayAudio()
 bool Game::GetQuit()
 {
 	return (gameSequence.exitGame);
+}
+
+/// <summary>
+/// This will return the keys that were down for the last update, this is what gets saved in a replay
+/// </summary>
+/// <returns> One bit for each key the game uses </returns>
+uint16_t Game::GetInputMask()
+{
+	return input.GetKeyMask();
+}
+
+/// <summary>
+/// This sets the keys for the next update instead of reading the keyboard, once this is called the keyboard isnt read again
+/// </summary>
+/// <param name="keyMask"> The keys in the same format as GetInputMask </param>
+void Game::SetReplayInput(uint16_t keyMask)
+{
+	input.SetPlaybackMask(keyMask);
+}
+
+/// <summary>
+/// This will return a hash of everything that affects how the game plays out, if a replay ends with the same hash as the
+/// recording then it played out the same
+/// </summary>
+/// <returns> The hash </returns>
+uint64_t Game::GetStateHash()
+{
+	StateHash hash;
+	hash.Add(currentGameState);
+
+	hash.Add(player.xPos);
+	hash.Add(player.yPos);
+	hash.Add(player.previousXPos);
+	hash.Add(player.previousYPos);
+	hash.Add(player.acceleration);
+	hash.Add(player.velocityY);
+	hash.Add(player.fuel);
+	hash.Add(player.currentScore);
+	hash.Add(player.hasLanded);
+	hash.Add(player.hasCrashed);
+	hash.Add(player.isMovingLeft);
+	hash.Add(player.isMovingRight);
+	hash.Add(player.fuelCollected);
+
+	hash.Add(entities.pickups.Count());
+	for (int i = 0; i < entities.pickups.Count(); i++)
+	{
+		hash.Add(entities.pickups.x[i]);
+		hash.Add(entities.pickups.y[i]);
+		hash.Add(entities.pickups.fuel[i]);
+	}
+	hash.Add(fuel.fuelExists);
+	const std::vector<uint8_t>& planetPickups = world.GetCollectedPickups();
+	hash.Add(planetPickups.data(), planetPickups.size());
+	hash.Add(particles.GetCount());
+	hash.Add(explosion.flashTimer);
+	hash.Add(splash.duration);
+	hash.Add(menu.menuSelection);
+	hash.Add(menu.optionsSelection);
+	hash.Add(gameSequence.exitGame);
+	hash.Add(gameSequence.runTime);
+	hash.Add(gameSequence.playAgain);
+	hash.Add(gameSequence.simulationTime);
+
+	for (int stream = 0; stream < RANDOM_STREAM_COUNT; stream++)
+	{
+		hash.Add(random[stream].GetState());
+	}
+	return hash.Get();
+}
+
+/// <summary>
+/// This will return a hash of the level being played, a replay checks it so that it isnt played back on a different level
+/// </summary>
+/// <returns> The hash, or 0 when flying over a planet as the level isnt used </returns>
+uint64_t Game::GetLevelHash()
+{
+	if (planetMode)
+	{
+		return 0;
+	}
+
+	StateHash hash;
+	const int cellCount = level.GetWidth() * level.GetHeight();
+	hash.Add(level.GetCharacters(), cellCount);
+	hash.Add(level.GetMask(), cellCount);
+	hash.Add(level.GetPlatforms(), level.GetPlatformCount() * sizeof(LevelPlatform));
+	return hash.Get();
+}
+
+/// <summary>
+/// This will return the seed that the random numbers were started from, running again with it gives the same fuel pickups
+/// </summary>
+/// <returns> The seed </returns>
+uint64_t Game::GetSeed()
+{
+	return randomSeed;
+}
+
+/// <summary>
+/// Gives the profiler how late the frame started, the scheduler that knows this is in main rather than the game
+/// </summary>
+/// <param name="jitter"> How long after its deadline the frame started, in seconds </param>
+void Game::RecordFrameJitter(double jitter)
+{
+	profiler.RecordCounter(PROFILE_FRAME_JITTER, (float)jitter);
+}
+
+/// <summary>
+/// Turns on the profiler overlay and starts writing a trace of every frame, the times are always being recorded so this only
+/// changes what is done with them
+/// </summary>
+/// <param name="showOverlay"> If the overlay should be shown straight away, it can still be turned on and off with 'P' </param>
+/// <param name="tracePath"> Where to write the trace, a Chrome trace if it ends in .json and csv otherwise. Null for no trace </param>
+/// <returns> False if the trace file couldnt be opened </returns>
+bool Game::StartProfiler(bool showOverlay, const char* tracePath)
+{
+	profiler.SetOverlayVisible(showOverlay);
+	return !tracePath || profiler.StartTrace(tracePath);
 }
\ No newline at end of file
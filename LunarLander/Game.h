@@ -9,8 +9,22 @@
 #define GAME_H
 
 // Includes
-#include <Windows.h>
+#include "Platform.h"
 #include "GameObjects.h"
+#include "AudioEngine.h"
+#include "ChunkWorld.h"
+#include "Compositor.h"
+#include "EntityStore.h"
+#include "Input.h"
+#include "Level.h"
+#include "ParticleSystem.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Replay.h"
+#include "SettingsStore.h"
+#include "TerrainIndex.h"
+#include "Viewport.h"
+#include <vector>
 
 /// <summary>
 /// This class contains the definitions for the functions and the game console window
@@ -19,17 +33,33 @@ class Game
 {
 public:
 	// Functions: these are the definitions for the functions that will be used in the main game loop
-	void Initialise();
+	void Initialise(Platform* gamePlatform, AudioSink* audioSink, uint64_t seed, bool useSettingsFiles = true, const char* levelPath = nullptr,
+		bool planet = false);
+	void Shutdown();
 	void Update(float deltaTime);
 	void Draw();
+	void Simulate(float step);
 	void AddScore();
 	bool GetQuit();
+	uint64_t GetSeed();
+	uint16_t GetInputMask();
+	void SetReplayInput(uint16_t keyMask);
+	uint64_t GetStateHash();
+	uint64_t GetLevelHash();
+	bool StartProfiler(bool showOverlay, const char* tracePath);
+	void RecordFrameJitter(double jitter);
 	void ScoreReset();
+	void Resize(int width, int height);
+	void ResetPlayer();
+	void FollowLander(int drawX, int drawY);
+	void DrawPlanetPickups();
+	int GetLowestCameraY();
 	int RandIntLength();
 	int RandIntHeight();
 	void FuelPickup();
-	void LevelWrap();
+	void EmitThrusterParticles(bool isThrusting);
 	void PlayAudio();
+	void SetThrusterPlaying(bool playing);
 
 private:
 	// ENUMS
@@ -43,27 +73,75 @@ private:
 	};
 
 	// Console Variables
-	// Window size coordinates, be sure to start at zero
-	SMALL_RECT windowSize{ 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1 };
-	// A COORD struct for specifying the console's screen buffer dimensions
-	COORD bufferSize = { SCREEN_WIDTH, SCREEN_HEIGHT };
-	// Setting up different variables for passing to WriteConsoleOutput
-	COORD characterBufferSize = { SCREEN_WIDTH, SCREEN_HEIGHT };
-	COORD characterPosition = { 0,0 };
-	SMALL_RECT consoleWriteArea = { 0,0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1 };
-	// A CHAR_INFO structure containing data about our frame
-	CHAR_INFO consoleBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
-	// Initialise handles
-	HANDLE wHnd = GetStdHandle(STD_OUTPUT_HANDLE);
-	HANDLE rHnd = GetStdHandle(STD_INPUT_HANDLE);
+	// The platform that the game draws to and takes input from, this is owned by main
+	Platform* platform = nullptr;
+	// The cells of our frame, it is the size of the console and is only reallocated when that changes
+	std::vector<Cell> consoleBuffer;
+	int screenWidth = LEVEL_WIDTH;
+	int screenHeight = LEVEL_HEIGHT;
+	// Builds each frame out of the cached layers below with the sprites drawn on top
+	Compositor compositor;
+	Layer backgroundLayer;
+	Layer menuLayer;
+	Layer optionsLayer;
+	Layer blankLayer;
+	// The level and the menus at their own size, they are mapped on to the screen sized layers above whenever the screen
+	// changes size. The level is scaled up to fill a big screen, the menus are just centred.
+	Layer levelArt;
+	Layer menuArt;
+	Layer optionsArt;
+	Viewport levelView;
+	Viewport menuView;
+	// The HUD text, these keep their text between frames so that it is only rebuilt when the value changes
+	HudField scoreField{ "SCORE: ", 0 };
+	HudField timeField{ "TIME: ", 2 };
+	HudField velocityField{ "Y VELOCITY: ", 2 };
+	HudField fuelField{ "FUEL: ", 2 };
+	HudField altitudeField{ "ALTITUDE: ", 0, "M" };
+	HudField highScoreField{ "H I G H  S C O R E : ", 0 };
+	// Times each part of every frame, 'P' shows the times along the bottom of the screen
+	Profiler profiler;
+	// The keyboard, it is read once at the start of each update
+	Input input;
+	// When the oldest key press that isnt on screen yet was read, or -1 if there isnt one
+	double undrawnInputTime = -1.0;
+	// The random numbers, there is one stream for each part of the game that uses them
+	uint64_t randomSeed = 0;
+	Random random[RANDOM_STREAM_COUNT];
+	// Mixes the sound on its own thread, the game only ever sends it commands
+	AudioEngine audio;
+	int thrusterSound = INVALID_AUDIO_ID;
+	int thrusterVoice = INVALID_AUDIO_ID;
+	// The high score and sound setting, these are loaded once and saved in the background when they change
+	SettingsStore settings;
 
 	// Game Variables
 	GAME_STATE currentGameState = SPLASH;
 	// The following relate to the structs within GameObjects.h, it allows other scripts to easily reference those structs
 	Background background;
+	// The level being played, either mapped from a level file or built from the background's ascii art
+	Level level;
+	// Built from the level once it is loaded, the collision, scoring and altimeter all look things up in this
+	TerrainIndex terrain;
+	// When flying over a planet the level isnt used, the terrain comes from the planet's chunks instead and the screen is a
+	// camera that follows the lander around it
+	bool planetMode = false;
+	ChunkWorld world;
+	Layer planetLayer;
+	int cameraX = 0;
+	int cameraY = 0;
+	// Set when the view has to be copied out of the chunks again, because the camera moved or some of it wasnt ready last time
+	bool planetViewStale = true;
+	Splash splash;
 	Player player;
+	PlayerInput playerInput;
 	Explosion explosion;
 	Fuel fuel;
+	// The pickups (and anything else there can be lots of) live here, in columns rather than one struct each
+	EntityStore entities;
+	SpriteHandle fuelSprite = 0;
+	// The thruster exhaust and explosion debris
+	ParticleSystem particles;
 	Menu menu;
 	RunTime gameSequence;
 };
@@ -9,6 +9,7 @@
 #define GAME_OBJECTS_H
 
 #include "Constants.h"
+#include "Sprite.h"
 
 // STRUCTS
 
@@ -24,9 +25,10 @@ struct Player
 	/// </summary>
 	void Reset()
 	{
-		xPos = SCREEN_WIDTH / 4;
+		xPos = LEVEL_WIDTH / 4;
 		yPos = 5;
-		isAccelerating = false;
+		previousXPos = xPos;
+		previousYPos = yPos;
 		acceleration = 0.0f;
 		hasLanded = false;
 		hasCrashed = false;
@@ -43,51 +45,79 @@ struct Player
 		fuel = 100;
 	}
 
+	/// <summary>
+	/// The position is in fractions of a cell, these get the cell that the lander is actually in
+	/// </summary>
+	int GetCellX() const { return (int)xPos; }
+	int GetCellY() const { return (int)yPos; }
+
+	/// <summary>
+	/// Gets the cell to draw the lander in, this blends between the position at the last physics step and the current one
+	/// </summary>
+	/// <param name="alpha"> How far through the current physics step we are, from 0 to 1 </param>
+	int GetDrawX(float alpha) const
+	{
+		// If the lander has wrapped around the level then dont blend, otherwise it would be drawn sliding across the whole screen
+		float distance = xPos - previousXPos;
+		if (distance > LEVEL_WIDTH / 2 || distance < -LEVEL_WIDTH / 2)
+		{
+			return GetCellX();
+		}
+		return (int)(previousXPos + distance * alpha);
+	}
+	int GetDrawY(float alpha) const
+	{
+		return (int)(previousYPos + (yPos - previousYPos) * alpha);
+	}
+
 	// Constants
 	// Height and width of player sprite
 	static const int WIDTH = 4;
 	static const int HEIGHT = 3;
 
 	// Default player sprite and colours
-	const char* CHARACTERS_DEFAULT = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_DEFAULT = {
 		R"(=__ )"
 		R"( || )"
-		R"( /\ )"
-	};
-	const int COLOURS_DEFAULT[WIDTH * HEIGHT] = {
-		0xA, 0xF, 0xF, 0xF,
-		0xF, 0xF, 0xF, 0xF,
-		0xF, 0xE, 0xE, 0xF,
+		R"( /\ )",
+		{
+			0xA, 0xF, 0xF, 0xF,
+			0xF, 0xF, 0xF, 0xF,
+			0xF, 0xE, 0xE, 0xF,
+		}
 	};
 
 	// Player sprite when moving left, and its colours
-	const char* CHARACTERS_LEFT = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_LEFT = {
 		R"(=__ )"
 		R"( ||<)"
-		R"( /\ )"
-	};
-	const int COLOURS_LEFT[WIDTH * HEIGHT] = {
-		0xA, 0xF, 0xF, 0xF,
-		0xF, 0xF, 0xF, 0xE,
-		0xF, 0xF, 0xF, 0xF,
+		R"( /\ )",
+		{
+			0xA, 0xF, 0xF, 0xF,
+			0xF, 0xF, 0xF, 0xE,
+			0xF, 0xF, 0xF, 0xF,
+		}
 	};
 
 	// Player sprite when moving right, and its colours
-	const char* CHARACTERS_RIGHT = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_RIGHT = {
 		R"(=__ )"
 		R"(>|| )"
-		R"( /\ )"
-	};
-	const int COLOURS_RIGHT[WIDTH * HEIGHT] = {
-		0xA, 0xF, 0xF, 0xF,
-		0xE, 0xF, 0xF, 0xF,
-		0xF, 0xF, 0xF, 0xF,
+		R"( /\ )",
+		{
+			0xA, 0xF, 0xF, 0xF,
+			0xE, 0xF, 0xF, 0xF,
+			0xF, 0xF, 0xF, 0xF,
+		}
 	};
 
 	// Variables: these are the variables used in the main game loop that relate to the player.
-	int xPos = SCREEN_WIDTH / 4;
-	int yPos = 5;
-	bool isAccelerating = false;
+	// Position in cells, these are floats so the lander can move by less than a whole cell each physics step
+	float xPos = LEVEL_WIDTH / 4;
+	float yPos = 5;
+	// Position at the start of the current physics step
+	float previousXPos = LEVEL_WIDTH / 4;
+	float previousYPos = 5;
 	float acceleration = 0.0f;
 	bool hasLanded = false;
 	bool hasCrashed = false;
@@ -95,10 +125,20 @@ struct Player
 	bool isMovingLeft = false;
 	bool isMovingRight = false;
 	int currentScore = 0;
-	float velocityY;
+	float velocityY = 0.0f;
 	bool fuelCollected = false;
 };
 
+/// <summary>
+/// This struct holds the controls that the player is pressing, they are read once a frame and then used by every physics step
+/// </summary>
+struct PlayerInput
+{
+	bool thrust = false;
+	bool left = false;
+	bool right = false;
+};
+
 /// <summary>
 /// This struct contains the frames for the explosion animation and the colours for the sprites in the animation
 /// </summary>
@@ -108,35 +148,44 @@ struct Explosion
 	static const int WIDTH = 7;
 	static const int HEIGHT = 5;
 
-	const char* EMPTY_CHARACTERS{
-		R"(       )"
+	// The colours are the same for every frame of the explosion
+	static constexpr uint8_t COLOURS[WIDTH * HEIGHT] = {
+		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+	};
+
+	// The frames of the explosion animation
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_EMPTY = {
 		R"(       )"
 		R"(       )"
 		R"(       )"
 		R"(       )"
+		R"(       )",
+		COLOURS
 	};
-	const char* CHARACTERS_SMALL = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_SMALL = {
 		R"(       )"
 		R"(  \|/  )"
 		R"(  - -  )"
 		R"(  /|\  )"
-		R"(       )"
+		R"(       )",
+		COLOURS
 	};
-	const char* CHARACTERS_BIG = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE_BIG = {
 		R"(\  |  /)"
 		R"(       )"
 		R"(-     -)"
 		R"(       )"
-		R"(/  |  \)"
-	};
-	const int COLOURS[WIDTH * HEIGHT] = {
-		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
-		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
-		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
-		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
-		0xE, 0xE, 0xE, 0xE, 0xE, 0xE, 0xE,
+		R"(/  |  \)",
+		COLOURS
 	};
 
+	// Variables
+	// Timer for which frame of the animation to show
+	float flashTimer = 0.0f;
 };
 
 /// <summary>
@@ -145,7 +194,7 @@ struct Explosion
 struct Background
 {
 	// Constants
-	const char* CHARACTERS = {
+	static constexpr const char* CHARACTERS = {
 		R"(                                                                                                                                                      )"
 		R"( *               .   *               .             *   .          .            .                                                                      )"
 		R"(        *                           *                                                  *          .               .              .                    )"
@@ -201,21 +250,21 @@ struct Splash
 	static const int HEIGHT = 6;
 	
 	// The sprite to be dispalyed as the splash screen and its colours
-	const char* CHARACTERS = {
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE = {
 		R"(  Lunar Lander  )"
 		R"(       __       )"
 		R"(       ||       )"
 		R"(       /\       )"
 		R"(       By       )"
-		R"( Joshua  Riches )"
-	};
-	const int COLOURS[WIDTH * HEIGHT] = {
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
-		0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+		R"( Joshua  Riches )",
+		{
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+			0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,0xF,
+		}
 	};
 
 	// Variables
@@ -232,16 +281,17 @@ struct Fuel
 	static const int WIDTH = 1;
 	static const int HEIGHT = 1;
 	// SPrite for fuel and its colours
-	const char* CHARACTERS = {
-	R"(F)"
-	};
-	const int COLOURS[WIDTH * HEIGHT] = {
-		4,
+	static constexpr Sprite<WIDTH, HEIGHT> SPRITE = {
+		R"(F)",
+		{
+			4,
+		}
 	};
 
-	// Variables for the fuel pickup
-	int fuelX = 0;
-	int fuelY = 0;
+	// How much fuel a pickup gives the lander
+	static constexpr float FUEL_AMOUNT = 25.0f;
+
+	// Variables for the fuel pickup, where it is on screen is kept in the entity store
 	bool fuelExists = false;
 };
 
@@ -251,7 +301,7 @@ struct Fuel
 struct Menu
 {
 	//Main menu screen
-	const char* CHARACTERS = {
+	static constexpr const char* CHARACTERS = {
 		R"(                                                                                                                                                      )"
 		R"(                         ____            ___________     ___      ___     __________      __________     __________      ____                         )"
 		R"(                        |    |          |    ___    |   |   |\   |   |   |   ____   \    |   _______|   |    ____  |    |    |                        )"
@@ -295,7 +345,7 @@ struct Menu
 	};
 
 	//options page screen
-	const char* CHARACTERS_OPTIONS = {
+	static constexpr const char* CHARACTERS_OPTIONS = {
 		R"(                                                                                                                                                      )"
 		R"(                         ____            ___________     ___      ___     __________      __________     __________      ____                         )"
 		R"(                        |    |          |    ___    |   |   |\   |   |   |   ____   \    |   _______|   |    ____  |    |    |                        )"
@@ -342,6 +392,9 @@ struct Menu
 
 	int menuSelection = 0;
 	int optionsSelection = 0;
+	int highScore = 0;
+	// this is a variable that will enable the highscore text to blink (in proper retro fashion)
+	float blinkTimer = 0.0f;
 };
 
 /// <summary>
@@ -353,6 +406,8 @@ struct RunTime
 	bool exitGame = false;
 	float runTime = 0.0f;
 	bool playAgain = false;
+	// Time that has built up but not been simulated yet, it is always less than one physics step after an update
+	float simulationTime = 0.0f;
 };
 
 #endif // !GAME_OBJECTS_H
@@ -0,0 +1,144 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: HudText.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the HUD text fields, they format numbers straight in to a small fixed size array instead of building
+// strings, and they only reformat when the number they are showing actually changes
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HUD_TEXT_H
+#define HUD_TEXT_H
+
+// Includes
+#include <string.h>
+
+/// <summary>
+/// Writes a whole number as text
+/// </summary>
+/// <param name="output"> Where the digits are written, it needs room for at least 11 characters </param>
+/// <param name="value"> The number to write </param>
+/// <returns> How many characters were written </returns>
+static int FormatInt(char* output, long long value)
+{
+	int length = 0;
+	if (value < 0)
+	{
+		output[length++] = '-';
+		value = -value;
+	}
+
+	// The digits come out backwards, so write them to a scratch array first
+	char digits[20];
+	int digitCount = 0;
+	do
+	{
+		digits[digitCount++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	while (digitCount > 0)
+	{
+		output[length++] = digits[--digitCount];
+	}
+	return length;
+}
+
+/// <summary>
+/// Writes a number as text with a fixed number of decimal places, the last place is rounded
+/// </summary>
+/// <param name="output"> Where the text is written </param>
+/// <param name="value"> The number to write </param>
+/// <param name="precision"> How many decimal places to show, up to 6 </param>
+/// <returns> How many characters were written </returns>
+static int FormatFixed(char* output, float value, int precision)
+{
+	long long scale = 1;
+	for (int i = 0; i < precision; i++)
+	{
+		scale *= 10;
+	}
+
+	// Work with the number as a whole number of the smallest decimal place so that there are no rounding surprises
+	bool negative = value < 0.0f;
+	long long scaled = (long long)((negative ? -value : value) * scale + 0.5f);
+
+	int length = 0;
+	if (negative && scaled != 0)
+	{
+		output[length++] = '-';
+	}
+	length += FormatInt(output + length, scaled / scale);
+
+	if (precision > 0)
+	{
+		output[length++] = '.';
+		// Fill the decimal places from the right so that leading zeros are kept
+		long long fraction = scaled % scale;
+		for (int i = precision - 1; i >= 0; i--)
+		{
+			output[length + i] = (char)('0' + fraction % 10);
+			fraction /= 10;
+		}
+		length += precision;
+	}
+	return length;
+}
+
+/// <summary>
+/// A label followed by a number, like "FUEL: 97.50". The text is kept between frames and only rebuilt when the number changes
+/// </summary>
+struct HudField
+{
+	/// <summary>
+	/// Sets up the field, the label and suffix are expected to be string literals as they are not copied
+	/// </summary>
+	/// <param name="fieldLabel"> Text shown before the number </param>
+	/// <param name="fieldPrecision"> How many decimal places to show, 0 for a whole number </param>
+	/// <param name="fieldSuffix"> Text shown after the number, such as a unit </param>
+	HudField(const char* fieldLabel, int fieldPrecision, const char* fieldSuffix = "")
+		: label(fieldLabel), suffix(fieldSuffix), precision(fieldPrecision)
+	{
+	}
+
+	/// <summary>
+	/// Changes the number shown, if it is the same as last time then nothing needs doing
+	/// </summary>
+	void SetValue(float value)
+	{
+		if (hasValue && value == lastValue)
+		{
+			return;
+		}
+		hasValue = true;
+		lastValue = value;
+
+		// Build the text, everything is cut short if it would go over the size of the array
+		length = 0;
+		Append(label, (int)strlen(label));
+		char number[32];
+		Append(number, precision > 0 ? FormatFixed(number, value, precision) : FormatInt(number, (long long)value));
+		Append(suffix, (int)strlen(suffix));
+	}
+
+	const char* label;
+	const char* suffix;
+	int precision;
+
+	// The text that is drawn, it isnt null terminated
+	static const int MAX_LENGTH = 48;
+	char text[MAX_LENGTH];
+	int length = 0;
+
+private:
+	void Append(const char* characters, int count)
+	{
+		count = length + count > MAX_LENGTH ? MAX_LENGTH - length : count;
+		memcpy(text + length, characters, count);
+		length += count;
+	}
+
+	float lastValue = 0.0f;
+	bool hasValue = false;
+};
+
+#endif // !HUD_TEXT_H
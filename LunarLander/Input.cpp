@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Input.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the input system
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Input.h"
+
+void Input::Initialise(Platform* inputPlatform, const int* keys, int keyCount)
+{
+	platform = inputPlatform;
+
+	watchedKeyCount = 0;
+	for (int i = 0; i < keyCount && watchedKeyCount < MAX_WATCHED_KEYS; i++)
+	{
+		if (keys[i] >= 0 && keys[i] < KEY_CODE_COUNT)
+		{
+			watchedKeys[watchedKeyCount++] = keys[i];
+		}
+	}
+
+	keysDown.reset();
+	previousKeysDown.reset();
+	firstEvent = 0;
+	eventCount = 0;
+	droppedEvents = 0;
+}
+
+void Input::Sample()
+{
+	previousKeysDown = keysDown;
+	if (playback)
+	{
+		keysDown.reset();
+		for (int i = 0; i < watchedKeyCount; i++)
+		{
+			if (playbackMask & (1u << i))
+			{
+				keysDown.set(watchedKeys[i]);
+			}
+		}
+	}
+	else
+	{
+		platform->PollKeys(watchedKeys, watchedKeyCount, keysDown);
+	}
+	sampleTime = platform->GetTime();
+
+	// Only keys that changed need an event, most updates nothing has changed so this is skipped
+	KeySet changed = keysDown ^ previousKeysDown;
+	if (changed.none())
+	{
+		return;
+	}
+	for (int i = 0; i < watchedKeyCount; i++)
+	{
+		int key = watchedKeys[i];
+		if (changed.test(key))
+		{
+			PushEvent(key, keysDown.test(key) ? KEY_PRESSED : KEY_RELEASED);
+		}
+	}
+}
+
+uint16_t Input::GetKeyMask() const
+{
+	uint16_t mask = 0;
+	for (int i = 0; i < watchedKeyCount; i++)
+	{
+		if (keysDown.test(watchedKeys[i]))
+		{
+			mask |= (uint16_t)(1u << i);
+		}
+	}
+	return mask;
+}
+
+void Input::SetPlaybackMask(uint16_t keyMask)
+{
+	playback = true;
+	playbackMask = keyMask;
+}
+
+bool Input::PollEvent(InputEvent& event)
+{
+	if (eventCount == 0)
+	{
+		return false;
+	}
+	event = events[firstEvent];
+	firstEvent = (firstEvent + 1) % EVENT_QUEUE_SIZE;
+	eventCount--;
+	return true;
+}
+
+void Input::PushEvent(int key, INPUT_EVENT_TYPE type)
+{
+	if (eventCount == EVENT_QUEUE_SIZE)
+	{
+		firstEvent = (firstEvent + 1) % EVENT_QUEUE_SIZE;
+		eventCount--;
+		droppedEvents++;
+	}
+
+	InputEvent& event = events[(firstEvent + eventCount) % EVENT_QUEUE_SIZE];
+	event.key = key;
+	event.type = type;
+	event.time = sampleTime;
+	eventCount++;
+}
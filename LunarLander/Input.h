@@ -0,0 +1,114 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Input.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the input system, the keyboard is read once per update in to a set of bits and comparing it with the
+// previous update gives which keys were pressed or released. Every change is also put in a queue with the time it was seen.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INPUT_H
+#define INPUT_H
+
+// Includes
+#include "Platform.h"
+#include <stdint.h>
+
+/// <summary>
+/// The kinds of thing that can happen to a key
+/// </summary>
+enum INPUT_EVENT_TYPE
+{
+	KEY_PRESSED,
+	KEY_RELEASED,
+};
+
+/// <summary>
+/// A key going down or up, the time is when the update that noticed it read the keyboard
+/// </summary>
+struct InputEvent
+{
+	int key = 0;
+	INPUT_EVENT_TYPE type = KEY_PRESSED;
+	double time = 0.0;
+};
+
+/// <summary>
+/// This class keeps track of the keyboard between updates
+/// </summary>
+class Input
+{
+public:
+	/// <summary>
+	/// Sets up which keys are watched, only these keys are read from the platform
+	/// </summary>
+	/// <param name="inputPlatform"> The platform to read the keyboard from </param>
+	/// <param name="keys"> The key codes to watch </param>
+	/// <param name="keyCount"> How many key codes there are, anything past MAX_WATCHED_KEYS is ignored </param>
+	void Initialise(Platform* inputPlatform, const int* keys, int keyCount);
+
+	/// <summary>
+	/// Reads the keyboard, this should be called once at the start of every update and then everything else asks this class
+	/// </summary>
+	void Sample();
+
+	// The key is down right now
+	bool IsHeld(int key) const { return keysDown.test(key); }
+	// The key went down since the last update
+	bool WasPressed(int key) const { return keysDown.test(key) && !previousKeysDown.test(key); }
+	// The key went up since the last update
+	bool WasReleased(int key) const { return !keysDown.test(key) && previousKeysDown.test(key); }
+
+	/// <summary>
+	/// Gets which of the watched keys are down as one bit each, bit 0 is the first key that was passed to Initialise
+	/// </summary>
+	uint16_t GetKeyMask() const;
+
+	/// <summary>
+	/// From now on the keys come from here instead of the keyboard, this is used to play back a recording.
+	/// The mask is in the same format as GetKeyMask and is used by the next call to Sample.
+	/// </summary>
+	void SetPlaybackMask(uint16_t keyMask);
+
+	/// <summary>
+	/// Takes the oldest event out of the queue
+	/// </summary>
+	/// <param name="event"> Filled in with the event </param>
+	/// <returns> False if the queue was empty </returns>
+	bool PollEvent(InputEvent& event);
+
+	/// <summary>
+	/// The time that the keyboard was last read
+	/// </summary>
+	double GetSampleTime() const { return sampleTime; }
+
+	/// <summary>
+	/// How many events were thrown away because nothing took them out of the queue in time
+	/// </summary>
+	int GetDroppedEvents() const { return droppedEvents; }
+
+	// This matches the number of bits in a key mask
+	static const int MAX_WATCHED_KEYS = 16;
+	static const int EVENT_QUEUE_SIZE = 64;
+
+private:
+	void PushEvent(int key, INPUT_EVENT_TYPE type);
+
+	Platform* platform = nullptr;
+	int watchedKeys[MAX_WATCHED_KEYS] = {};
+	int watchedKeyCount = 0;
+
+	bool playback = false;
+	uint16_t playbackMask = 0;
+
+	KeySet keysDown;
+	KeySet previousKeysDown;
+	double sampleTime = 0.0;
+
+	// A ring buffer of events, when it is full the oldest event is thrown away to make room
+	InputEvent events[EVENT_QUEUE_SIZE];
+	int firstEvent = 0;
+	int eventCount = 0;
+	int droppedEvents = 0;
+};
+
+#endif // !INPUT_H
@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: LanderPhysics.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the lander physics
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "LanderPhysics.h"
+
+void MoveLander(Player& player, const PlayerInput& input, float step, const PhysicsTuning& tuning)
+{
+	StepLanderMotion(player.xPos, player.yPos, player.acceleration, player.velocityY, player.fuel, player.isMovingLeft, player.isMovingRight,
+		input, step, tuning);
+}
+
+LANDING_RESULT CheckLandingAt(int cellX, int cellY, float velocityY, const char* terrain)
+{
+	// Get the two characters under the landing gear
+	char bottomLeftChar = terrain[(cellX + (Player::WIDTH - 3)) + LEVEL_WIDTH * (cellY + (Player::HEIGHT - 1))];
+	char bottomRightChar = terrain[(cellX + (Player::WIDTH - 2)) + LEVEL_WIDTH * (cellY + (Player::HEIGHT - 1))];
+
+	// Landed?
+	if (bottomLeftChar == '_' && bottomRightChar == '_' && velocityY > -0.2f)
+	{
+		// if it is a platform under the lander and they arent going too fast then they have landed
+		return LANDING_LANDED;
+	}
+	else if ((bottomLeftChar != ' ' && bottomLeftChar != '*' && bottomLeftChar != '.') || (bottomRightChar != ' ' && bottomRightChar != '*' && bottomRightChar != '.'))
+	{
+		//otherwise they have crashed
+		return LANDING_CRASHED;
+	}
+	return LANDING_NONE;
+}
+
+int GetLandingScoreAt(int cellX, int cellY, const char* terrain)
+{
+	// Get all the characters for the left of the platform
+	char bottomLeftChar = terrain[cellX + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+	char bottomLeftChar1 = terrain[cellX + 1 + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+	char bottomLeftChar2 = terrain[cellX + 2 + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+	// Get all the characters for the right of the platform
+	char bottomRightChar = terrain[(cellX + (Player::WIDTH - 1)) + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+	char bottomRightChar1 = terrain[(cellX + (Player::WIDTH - 2)) + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+	char bottomRightChar2 = terrain[(cellX + (Player::WIDTH - 3)) + LEVEL_WIDTH * (cellY + (Player::HEIGHT))];
+
+	// If their is a '2' under the platform then the base score will be multiplied by 2
+	if (bottomLeftChar == '2' || bottomLeftChar1 == '2' || bottomLeftChar2 == '2' || bottomRightChar == '2' || bottomRightChar1 == '2' || bottomRightChar2 == '2')
+	{
+		return BASE_SCORE * 2;
+	}
+	// If their is a '4' under the platform then the base score will be multiplied by 4
+	else if (bottomLeftChar == '4' || bottomLeftChar1 == '4' || bottomLeftChar2 == '4' || bottomRightChar == '4' || bottomRightChar1 == '4' || bottomRightChar2 == '4')
+	{
+		return BASE_SCORE * 4;
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: LanderPhysics.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the lander physics on its own, it only uses the lander and the background characters so the game
+// and the batch simulator both run exactly the same steps
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LANDER_PHYSICS_H
+#define LANDER_PHYSICS_H
+
+// Includes
+#include "GameObjects.h"
+#include "Utility.h"
+
+/// <summary>
+/// The numbers that control how the lander handles, by default these are the values in Constants.h
+/// </summary>
+struct PhysicsTuning
+{
+	float accelerationRate = ACCELERATION_RATE;
+	float decelerationRate = DECELERATION_RATE;
+	float moveSpeed = MOVE_SPEED;
+	float fuelConsumptionRate = FUEL_CONSUMPTION_RATE;
+	// Where the lander wraps around going across and the lowest it can go, these are the screen unless it is flying over a planet
+	float wrapWidth = (float)(LEVEL_WIDTH - Player::WIDTH);
+	float lowestY = (float)(LEVEL_HEIGHT - Player::HEIGHT);
+};
+
+/// <summary>
+/// What the terrain under the lander says happened
+/// </summary>
+enum LANDING_RESULT
+{
+	LANDING_NONE,
+	LANDING_LANDED,
+	LANDING_CRASHED,
+};
+
+/// <summary>
+/// Wraps an x position around the sides of the screen, whatever distance went past the edge is carried over to the other side
+/// </summary>
+/// <param name="rightEdge"> Where it wraps, the screen by default or the width of the planet </param>
+inline void WrapLanderX(float& xPos, float rightEdge = (float)(LEVEL_WIDTH - Player::WIDTH))
+{
+	// if the lander moves off the right hand side, then they will appear on the left and vice versa. Both are worked out
+	// before picking so there are no branches
+	float wrappedLeft = xPos < 0.0f ? xPos + rightEdge : xPos;
+	xPos = xPos >= rightEdge ? xPos - rightEdge : wrappedLeft;
+}
+
+/// <summary>
+/// The lander physics for one step, it works on the values themselves so that a single Player and the columns in the
+/// entity store both run exactly the same maths. It is inline so the loops over the columns dont pay for a call.
+/// </summary>
+inline void StepLanderMotion(float& xPos, float& yPos, float& acceleration, float& velocityY, float& fuel, bool& isMovingLeft, bool& isMovingRight,
+	const PlayerInput& input, float step, const PhysicsTuning& tuning)
+{
+	// The controls change from one lander to the next when the entity store runs this over a column, so instead of branching on
+	// them (which would mostly be guessed wrong) every value is worked out and then picked. Taking away 0 doesnt change a float
+	// at all, so this gives exactly the same numbers as the old if statements and recordings still match.
+	const float fuelSpent = tuning.fuelConsumptionRate * step;
+	const float moveStep = tuning.moveSpeed * step;
+
+	// the lander will accelerate upwards if they have fuel, spend fuel
+	const bool isAccelerating = input.thrust & (fuel > 0.0f);
+	fuel -= SelectFloat(isAccelerating, fuelSpent, 0.0f);
+
+	//move left, use fuel, set moving left as true
+	isMovingLeft = input.left & (fuel > 0.0f);
+	xPos -= SelectFloat(isMovingLeft, moveStep, 0.0f);
+	fuel -= SelectFloat(isMovingLeft, fuelSpent, 0.0f);
+
+	// move right, use fuel, set moving right as true
+	isMovingRight = input.right & (fuel > 0.0f);
+	xPos += SelectFloat(isMovingRight, moveStep, 0.0f);
+	fuel -= SelectFloat(isMovingRight, fuelSpent, 0.0f);
+
+	// sets the landers acceleration, this is actually velocity as velocity is acceleration * time but i kept as this cos i didnt want to screw other things up
+	acceleration += SelectFloat(isAccelerating, tuning.accelerationRate * step, -(tuning.decelerationRate * step));
+
+	// Clamp our acceleration
+	acceleration = ClampFloat(acceleration, 0.0f, 1.5f);
+
+	// it starts at 0 at top so - is increasing height
+	yPos += SelectFloat(acceleration >= 0.5f, -moveStep, moveStep);
+
+	// -0.5f is the most the lander can go down by, so the velocity is the acceleration minus that. In real life the lander wouldnt
+	// move up or down if velocity is 0, so this puts that point in the middle of the range
+	velocityY = acceleration - 0.5f;
+
+	// Clamp the position of the lander so it cant go beyond the borders
+	WrapLanderX(xPos, tuning.wrapWidth);
+	yPos = ClampFloat(yPos, 0.0f, tuning.lowestY);
+}
+
+/// <summary>
+/// Moves the lander by one physics step, this spends fuel, changes the acceleration and velocity and wraps the lander around the sides
+/// </summary>
+/// <param name="player"> The lander, it shouldnt have landed or crashed </param>
+/// <param name="input"> The controls being pressed </param>
+/// <param name="step"> Length of the step in seconds </param>
+/// <param name="tuning"> How the lander handles </param>
+void MoveLander(Player& player, const PlayerInput& input, float step, const PhysicsTuning& tuning);
+
+/// <summary>
+/// Looks at the two characters under the landing gear of a lander in the given cell to see if it has touched down, the level
+/// uses this to find its platforms
+/// </summary>
+/// <param name="cellX"> The column the lander is in </param>
+/// <param name="cellY"> The row the lander is in </param>
+/// <param name="velocityY"> How fast the lander is going up or down </param>
+/// <param name="terrain"> The background characters, LEVEL_WIDTH by LEVEL_HEIGHT </param>
+/// <returns> Landed if both feet are on a platform and it was going slowly enough, crashed if it hit anything else </returns>
+LANDING_RESULT CheckLandingAt(int cellX, int cellY, float velocityY, const char* terrain);
+
+/// <summary>
+/// Checks for a number character under the platform that a lander in the given cell is on, the base score is multiplied by it
+/// </summary>
+/// <param name="cellX"> The column the lander is in </param>
+/// <param name="cellY"> The row the lander is in </param>
+/// <param name="terrain"> The background characters, LEVEL_WIDTH by LEVEL_HEIGHT </param>
+/// <returns> The score for landing here, 0 if the platform doesnt have a multiplier </returns>
+int GetLandingScoreAt(int cellX, int cellY, const char* terrain);
+
+#endif // !LANDER_PHYSICS_H
@@ -0,0 +1,224 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Level.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the level, including the converter that turns ascii art in to a level
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Level.h"
+
+// Includes
+#include "LanderPhysics.h"
+#include <stdio.h>
+#include <string.h>
+
+// The cells are stored exactly as they are in memory, a glyph byte then a colour byte
+static_assert(sizeof(Cell) == 2, "Level files store cells as 2 byte Cells");
+
+/// <summary>
+/// Rounds a size up to the next multiple of 4, so every section of the file starts lined up
+/// </summary>
+static uint32_t AlignSection(uint32_t size)
+{
+	return (size + 3) & ~3u;
+}
+
+Level::~Level()
+{
+	Unload();
+}
+
+bool Level::Load(Platform* platform, const char* path)
+{
+	Unload();
+
+	size_t size = 0;
+	const void* data = platform->MapFile(path, size);
+	if (!data)
+	{
+		return false;
+	}
+
+	mappedData = data;
+	mappedSize = size;
+	mappedBy = platform;
+	if (!Attach(data, size))
+	{
+		Unload();
+		return false;
+	}
+	return true;
+}
+
+void Level::BuildFromAscii(const char* asciiArt)
+{
+	Unload();
+
+	const int width = LEVEL_WIDTH;
+	const int height = LEVEL_HEIGHT;
+	const int cellCount = width * height;
+
+	// Find every position the lander could land at, not just the ones you can drop straight down to, and group the ones next
+	// to each other on the same row that give the same score in to platforms. This uses the same check as the physics so
+	// the platforms always agree with it.
+	std::vector<LevelPlatform> found;
+	for (int row = 0; row <= height - Player::HEIGHT; row++)
+	{
+		for (int column = 0; column < width - Player::WIDTH; column++)
+		{
+			if (CheckLandingAt(column, row, 0.0f, asciiArt) != LANDING_LANDED)
+			{
+				continue;
+			}
+
+			int16_t multiplier = (int16_t)(GetLandingScoreAt(column, row, asciiArt) / BASE_SCORE);
+			// The legs are the middle two columns of the lander and stand on the bottom row
+			int16_t legX = (int16_t)(column + (Player::WIDTH - 3));
+			int16_t legY = (int16_t)(row + (Player::HEIGHT - 1));
+
+			LevelPlatform* last = found.empty() ? nullptr : &found.back();
+			if (last && last->y == legY && last->multiplier == multiplier && last->x + last->width - 1 == legX)
+			{
+				last->width++;
+			}
+			else
+			{
+				found.push_back({ legX, legY, 2, multiplier });
+			}
+		}
+	}
+
+	// Lay the sections out the same way the file does
+	LevelFileHeader newHeader = {};
+	memcpy(newHeader.magic, "LLVL", 4);
+	newHeader.version = LEVEL_FILE_VERSION;
+	newHeader.width = (uint32_t)width;
+	newHeader.height = (uint32_t)height;
+	newHeader.platformCount = (uint32_t)found.size();
+	newHeader.charactersOffset = AlignSection(sizeof(LevelFileHeader));
+	newHeader.cellsOffset = newHeader.charactersOffset + AlignSection((uint32_t)cellCount);
+	newHeader.maskOffset = newHeader.cellsOffset + AlignSection((uint32_t)(cellCount * sizeof(Cell)));
+	newHeader.platformsOffset = newHeader.maskOffset + AlignSection((uint32_t)cellCount);
+	newHeader.fileSize = newHeader.platformsOffset + AlignSection((uint32_t)(found.size() * sizeof(LevelPlatform)));
+
+	// Kept as whole uint32s so that everything in it is lined up
+	ownedData.assign(newHeader.fileSize / 4, 0);
+	unsigned char* bytes = (unsigned char*)ownedData.data();
+	memcpy(bytes, &newHeader, sizeof(newHeader));
+	memcpy(bytes + newHeader.charactersOffset, asciiArt, cellCount);
+
+	Cell* newCells = (Cell*)(bytes + newHeader.cellsOffset);
+	uint8_t* newMask = bytes + newHeader.maskOffset;
+	for (int i = 0; i < cellCount; i++)
+	{
+		// White, the same as the background has always been drawn
+		newCells[i].glyph = asciiArt[i];
+		newCells[i].attributes = 7;
+
+		char character = asciiArt[i];
+		if (character == '_')
+		{
+			newMask[i] = TERRAIN_PAD;
+		}
+		else if (character == ' ' || character == '*' || character == '.')
+		{
+			newMask[i] = TERRAIN_EMPTY;
+		}
+		else
+		{
+			newMask[i] = TERRAIN_SOLID;
+		}
+	}
+	if (!found.empty())
+	{
+		memcpy(bytes + newHeader.platformsOffset, found.data(), found.size() * sizeof(LevelPlatform));
+	}
+
+	Attach(bytes, newHeader.fileSize);
+}
+
+bool Level::Save(const char* path) const
+{
+	if (!header)
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	bool written = fwrite(header, 1, header->fileSize, file) == header->fileSize;
+	return fclose(file) == 0 && written;
+}
+
+void Level::Unload()
+{
+	if (mappedData)
+	{
+		mappedBy->UnmapFile(mappedData, mappedSize);
+	}
+	mappedData = nullptr;
+	mappedSize = 0;
+	mappedBy = nullptr;
+	ownedData.clear();
+
+	header = nullptr;
+	characters = nullptr;
+	cells = nullptr;
+	mask = nullptr;
+	platforms = nullptr;
+}
+
+bool Level::Attach(const void* data, size_t size)
+{
+	if (size < sizeof(LevelFileHeader))
+	{
+		return false;
+	}
+
+	// Nothing is copied or converted, the header is checked and then the sections are used where they are
+	const LevelFileHeader* fileHeader = (const LevelFileHeader*)data;
+	const uint64_t cellCount = (uint64_t)fileHeader->width * fileHeader->height;
+	if (memcmp(fileHeader->magic, "LLVL", 4) != 0 || fileHeader->version != LEVEL_FILE_VERSION || fileHeader->fileSize > size)
+	{
+		return false;
+	}
+	// The rest of the game still works on a screen sized level
+	if (fileHeader->width != LEVEL_WIDTH || fileHeader->height != LEVEL_HEIGHT)
+	{
+		return false;
+	}
+	// Every section has to be lined up and fit inside the file
+	if ((fileHeader->cellsOffset | fileHeader->maskOffset | fileHeader->platformsOffset) & 3 ||
+		fileHeader->charactersOffset + cellCount > fileHeader->fileSize ||
+		fileHeader->cellsOffset + cellCount * sizeof(Cell) > fileHeader->fileSize ||
+		fileHeader->maskOffset + cellCount > fileHeader->fileSize ||
+		fileHeader->platformsOffset + (uint64_t)fileHeader->platformCount * sizeof(LevelPlatform) > fileHeader->fileSize)
+	{
+		return false;
+	}
+
+	const unsigned char* bytes = (const unsigned char*)data;
+	const LevelPlatform* filePlatforms = (const LevelPlatform*)(bytes + fileHeader->platformsOffset);
+	// The terrain index writes every platform in to a grid the size of the level, so one that is off the level or has no
+	// cells for a left leg to stand on would be written outside of it
+	for (uint32_t i = 0; i < fileHeader->platformCount; i++)
+	{
+		const LevelPlatform& platform = filePlatforms[i];
+		if (platform.x < 0 || platform.width < 2 || platform.x + platform.width > (int)fileHeader->width ||
+			platform.y < 0 || platform.y >= (int)fileHeader->height)
+		{
+			return false;
+		}
+	}
+
+	header = fileHeader;
+	characters = (const char*)(bytes + fileHeader->charactersOffset);
+	cells = (const Cell*)(bytes + fileHeader->cellsOffset);
+	mask = bytes + fileHeader->maskOffset;
+	platforms = filePlatforms;
+	return true;
+}
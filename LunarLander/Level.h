@@ -0,0 +1,122 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Level.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the level, a level file holds everything the game needs already worked out (the cells to draw, what
+// each cell is for collision and where the platforms are) so it can be mapped straight in to memory and used with no parsing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LEVEL_H
+#define LEVEL_H
+
+// Includes
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Changes whenever the layout of the file changes, files with a different version are refused
+const uint32_t LEVEL_FILE_VERSION = 2;
+
+/// <summary>
+/// What a cell of the level is for collision
+/// </summary>
+enum TERRAIN_TYPE
+{
+	TERRAIN_EMPTY, // Nothing there, or stars which are just decoration
+	TERRAIN_SOLID, // Crashes the lander
+	TERRAIN_PAD,   // Top of a platform, the lander can land on these
+};
+
+/// <summary>
+/// A platform that can be landed on, in cells. The span is the cells that both of the lander's legs have to be over.
+/// </summary>
+struct LevelPlatform
+{
+	int16_t x;
+	int16_t y;
+	int16_t width;
+	// What the landing score is multiplied by, 0 for a platform with no multiplier
+	int16_t multiplier;
+};
+
+/// <summary>
+/// The start of a level file, the offsets are from the start of the file and every section starts on a multiple of 4
+/// </summary>
+struct LevelFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t platformCount;
+	// Where each section starts: the ascii characters, the cells ready to copy to the screen, the TERRAIN_TYPE of each cell and the platforms
+	uint32_t charactersOffset;
+	uint32_t cellsOffset;
+	uint32_t maskOffset;
+	uint32_t platformsOffset;
+	uint32_t fileSize;
+};
+
+/// <summary>
+/// A level, it is either mapped from a file or built from ascii art in to memory laid out exactly like the file
+/// </summary>
+class Level
+{
+public:
+	~Level();
+
+	/// <summary>
+	/// Maps a level file in to memory, everything is used straight from the mapping
+	/// </summary>
+	/// <param name="platform"> Used to map the file, it has to live for as long as the level is loaded </param>
+	/// <param name="path"> The level file </param>
+	/// <returns> False if the file couldnt be mapped or isnt a level this version of the game can use </returns>
+	bool Load(Platform* platform, const char* path);
+
+	/// <summary>
+	/// Builds the level from ascii art, this is what the converter uses and what the game uses when no level file is given
+	/// </summary>
+	/// <param name="characters"> The ascii art, LEVEL_WIDTH by LEVEL_HEIGHT with the rows joined together </param>
+	void BuildFromAscii(const char* characters);
+
+	/// <summary>
+	/// Writes the level out as a level file
+	/// </summary>
+	/// <returns> True if the whole file was written </returns>
+	bool Save(const char* path) const;
+
+	/// <summary>
+	/// Lets go of the level, the mapping is closed if it came from a file
+	/// </summary>
+	void Unload();
+
+	int GetWidth() const { return header ? (int)header->width : 0; }
+	int GetHeight() const { return header ? (int)header->height : 0; }
+	const char* GetCharacters() const { return characters; }
+	const Cell* GetCells() const { return cells; }
+	const uint8_t* GetMask() const { return mask; }
+	const LevelPlatform* GetPlatforms() const { return platforms; }
+	int GetPlatformCount() const { return header ? (int)header->platformCount : 0; }
+
+private:
+	/// <summary>
+	/// Checks the header and the platforms and points the sections at the data, this is the same for a mapped file and a built level
+	/// </summary>
+	bool Attach(const void* data, size_t size);
+
+	// Where the level came from, either a mapping (and the platform that made it) or memory we own
+	const void* mappedData = nullptr;
+	size_t mappedSize = 0;
+	Platform* mappedBy = nullptr;
+	std::vector<uint32_t> ownedData;
+
+	// The sections, these point in to the mapping or in to ownedData
+	const LevelFileHeader* header = nullptr;
+	const char* characters = nullptr;
+	const Cell* cells = nullptr;
+	const uint8_t* mask = nullptr;
+	const LevelPlatform* platforms = nullptr;
+};
+
+#endif // !LEVEL_H
@@ -7,54 +7,292 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // INCLUDES
-#include <Windows.h>
-#include <chrono>
+#include "Platform.h"
+#include "FrameScheduler.h"
 #include "GameObjects.h"
 #include "Game.h"
+#include "Level.h"
+#include "Replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
 
-// TYPEDEFS: this defines new names for these values, making it easier to reference them
-typedef std::chrono::steady_clock::time_point Time;
-typedef std::chrono::high_resolution_clock HiResClock;
-typedef std::chrono::duration<float> TimeDiff;
+/// <summary>
+/// Plays a recording back through the game as fast as possible, nothing is drawn and no time is spent sleeping. The game is
+/// started the same way as the recording (on a planet or not) from the log's header.
+/// </summary>
+/// <param name="path"> The replay log to play </param>
+/// <param name="levelPath"> The level file the recording was played on, or null for the built in level </param>
+/// <returns> 0 if the game ended in the same state as the recording, 1 if it didnt and 2 if the log couldnt be read or was
+/// recorded on a different level </returns>
+static int RunReplay(const char* path, const char* levelPath)
+{
+	ReplayReader reader;
+	if (!reader.Open(path))
+	{
+		fprintf(stderr, "Couldnt read replay %s, it isnt a replay log or was recorded by a different version of the game\n", path);
+		return 2;
+	}
+
+	Platform* platform = CreateHeadlessPlatform();
+	Game gameInstance;
+	gameInstance.Initialise(platform, new NullAudioSink(), reader.GetSeed(), false, levelPath, (reader.GetFlags() & REPLAY_FLAG_PLANET) != 0);
+
+	// Playing it back on any other level would just end in a mismatch, so say why instead
+	if (gameInstance.GetLevelHash() != reader.GetLevelHash())
+	{
+		fprintf(stderr, "Replay %s was recorded on a different level, pass the level file it was recorded on with --level\n", path);
+		gameInstance.Shutdown();
+		delete platform;
+		return 2;
+	}
+
+	uint16_t keyMask;
+	float deltaTime;
+	uint32_t frames = 0;
+	while (!gameInstance.GetQuit() && reader.ReadFrame(keyMask, deltaTime))
+	{
+		// Move the clock on by the same amount the recording did, then run the update with the recorded keys
+		platform->SleepFor(deltaTime);
+		gameInstance.SetReplayInput(keyMask);
+		gameInstance.Update(deltaTime);
+		frames++;
+	}
+
+	uint64_t hash = gameInstance.GetStateHash();
+	bool matches = hash == reader.GetFinalHash();
+	printf("frames,%u\nhash,%016llx\nrecorded_hash,%016llx\n%s\n", frames, (unsigned long long)hash,
+		(unsigned long long)reader.GetFinalHash(), matches ? "MATCH" : "MISMATCH");
+
+	gameInstance.Shutdown();
+	delete platform;
+	return matches ? 0 : 1;
+}
+
+/// <summary>
+/// Converts ascii art in to a level file
+/// </summary>
+/// <param name="outputPath"> Where the level file is written </param>
+/// <param name="artPath"> A text file with one row of the level on each line, or null to convert the built in level </param>
+/// <returns> 0 if the level was written, 2 if it wasnt </returns>
+static int ConvertLevel(const char* outputPath, const char* artPath)
+{
+	Background background;
+	std::string art;
+	if (artPath)
+	{
+		FILE* file = fopen(artPath, "r");
+		if (!file)
+		{
+			fprintf(stderr, "Couldnt read %s\n", artPath);
+			return 2;
+		}
+
+		// Each line is one row, short rows are filled out with spaces and long ones are cut off
+		char line[1024];
+		int rows = 0;
+		while (rows < LEVEL_HEIGHT && fgets(line, sizeof(line), file))
+		{
+			std::string row(line, strcspn(line, "\r\n"));
+			row.resize(LEVEL_WIDTH, ' ');
+			art += row;
+			rows++;
+		}
+		fclose(file);
+		art.resize(LEVEL_WIDTH * LEVEL_HEIGHT, ' ');
+	}
+	else
+	{
+		art.assign(background.CHARACTERS, LEVEL_WIDTH * LEVEL_HEIGHT);
+	}
+
+	Level level;
+	level.BuildFromAscii(art.c_str());
+	if (!level.Save(outputPath))
+	{
+		fprintf(stderr, "Couldnt write %s\n", outputPath);
+		return 2;
+	}
+	printf("Wrote %s with %d platforms\n", outputPath, level.GetPlatformCount());
+	return 0;
+}
 
 /// <summary>
 /// This is the main class that will run when the program is started, it is what triggers everything else to execute at the right time.
 /// </summary>
-/// <returns> As there is no specific return needed from main, it will return 0 </returns>
-int main()
+/// <param name="argc"> Number of command line arguments </param>
+/// <param name="argv"> The command line arguments, --fps followed by a number changes the frame rate, --audio-file followed by a path
+/// saves the sound to a .wav file instead of playing it, --no-audio turns the sound output off and --seed followed by a number
+/// sets the seed for the random numbers. --record followed by a path saves the session to a replay log and --replay followed by a path
+/// plays one back as fast as possible and prints the final state hash (it is started on a planet or not the same as the recording, and
+/// needs the --level it was recorded on). --level followed by a path plays a level file instead of the
+/// built in level, --planet flies over a whole planet made from the seed instead of a level, and --convert-level followed by an output
+/// path (and optionally a text file of ascii art) writes a level file and exits. --profile shows the frame times along the bottom of
+/// the screen ('P' does the same while playing) and --trace followed by a path writes the time of every part of every frame to it,
+/// as a Chrome trace if it ends in .json or as csv otherwise. With either of those the frame jitter is printed on exit. --pacing
+/// last-frame times each frame from when the last one started instead of keeping to a fixed grid </param>
+/// <returns> 0 unless a replay didnt match its recording or couldnt be played, or a level couldnt be converted </returns>
+int main(int argc, char* argv[])
 {
+	// Read the command line options
+	float frameRate = FRAME_RATE;
+	// Left as null to use the platform's speakers
+	AudioSink* audioSink = nullptr;
+	bool hasSeed = false;
+	uint64_t seed = 0;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	const char* levelPath = nullptr;
+	const char* convertPath = nullptr;
+	const char* convertArtPath = nullptr;
+	bool planet = false;
+	bool showProfiler = false;
+	const char* tracePath = nullptr;
+	PACING_MODE pacingMode = PACING_FIXED;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			frameRate = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--audio-file") == 0 && i + 1 < argc)
+		{
+			delete audioSink;
+			audioSink = new WavFileAudioSink(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = strtoull(argv[++i], nullptr, 10);
+			hasSeed = true;
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			levelPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--convert-level") == 0 && i + 1 < argc)
+		{
+			convertPath = argv[++i];
+			// The art file is optional, anything that isnt another option is taken as it
+			if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+			{
+				convertArtPath = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--planet") == 0)
+		{
+			planet = true;
+		}
+		else if (strcmp(argv[i], "--profile") == 0)
+		{
+			showProfiler = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc)
+		{
+			// Anything that isnt "last-frame" keeps the fixed grid
+			pacingMode = strcmp(argv[++i], "last-frame") == 0 ? PACING_FROM_LAST_FRAME : PACING_FIXED;
+		}
+		else if (strcmp(argv[i], "--no-audio") == 0)
+		{
+			delete audioSink;
+			audioSink = new NullAudioSink();
+		}
+	}
+	if (frameRate <= 0.0f)
+	{
+		frameRate = FRAME_RATE;
+	}
+
+	if (convertPath)
+	{
+		delete audioSink;
+		return ConvertLevel(convertPath, convertArtPath);
+	}
+
+	if (replayPath)
+	{
+		delete audioSink;
+		return RunReplay(replayPath, levelPath);
+	}
+
+	// Create the platform for whichever operating system we are running on
+	Platform* platform = CreatePlatform();
+
 	Game gameInstance;
 
+	// If no seed was given then make one from the clocks, so each session is different
+	if (!hasSeed)
+	{
+		seed = ((uint64_t)time(NULL) << 32) ^ (uint64_t)(platform->GetTime() * 1000000.0);
+	}
+
+	// The trace file is opened before the console is set up so that the message can be seen if it cant be
+	if (!gameInstance.StartProfiler(showProfiler, tracePath))
+	{
+		fprintf(stderr, "Couldnt open trace file %s\n", tracePath);
+	}
+
 	// Initialise console window
-	gameInstance.Initialise();
+	gameInstance.Initialise(platform, audioSink, seed, true, levelPath, planet);
 
-	// Initialise variables
-	float deltaTime = 0.0f;
-	Time currentFrameTime = HiResClock::now();
-	Time previousFrameTime = HiResClock::now();
+	// Save the keys of every update so the session can be played back exactly
+	ReplayWriter recorder;
+	if (recordPath)
+	{
+		recorder.Open(recordPath, seed, planet ? REPLAY_FLAG_PLANET : 0, gameInstance.GetLevelHash());
+	}
+
+	// The scheduler sleeps until each frame is due so that the game isnt using a whole cpu core while it waits
+	FrameScheduler scheduler;
+	scheduler.Initialise(platform, frameRate, pacingMode);
 
 	bool exitGame = false;
 	// Main game loop
 	// This will repeat the game loop until the value of exit game changes
 	while (!exitGame)
 	{
-		// Calculate our delta time (time since last frame)
-		currentFrameTime = HiResClock::now();
-		TimeDiff diff = currentFrameTime - previousFrameTime;
-		deltaTime = diff.count();
+		// Wait for the next frame, this gives back our delta time (time since last frame)
+		float deltaTime = scheduler.WaitForNextFrame();
+		gameInstance.RecordFrameJitter(scheduler.GetStats().lastJitter);
 
-		if (deltaTime >= (1.0f / FRAME_RATE))
-		{
-			// Update our application
-			gameInstance.Update(deltaTime);
-			// Cache the timestamp of this frame
-			previousFrameTime = currentFrameTime;
-		}
+		// Update our application and put it on screen
+		gameInstance.Update(deltaTime);
 		gameInstance.Draw();
+		recorder.AddFrame(gameInstance.GetInputMask(), deltaTime);
 		
 		// This retrieves the value of exit game within the game class and sets it as the exit game variable here,
 		// this enable the game to be quit
 		exitGame = gameInstance.GetQuit();
 	}
+
+	// Finish the recording with the state that the replay has to match
+	recorder.Close(gameInstance.GetStateHash());
+
+	// Stop the sound and save anything that hasnt been written yet, this uses the platform so it has to happen first
+	gameInstance.Shutdown();
+
+	// Put the console back to how it was
+	delete platform;
+
+	// Once the console is back to normal, say how well the frames kept to time if the frames were being looked at
+	if (showProfiler || tracePath)
+	{
+		const FrameStats& frameStats = scheduler.GetStats();
+		printf("frames,%d\nmissed_frames,%d\njitter_mean_us,%.1f\njitter_deviation_us,%.1f\njitter_max_us,%.1f\n", frameStats.frameCount,
+			frameStats.missedFrames, frameStats.GetMeanJitter() * 1e6, frameStats.GetJitterDeviation() * 1e6, frameStats.maxJitter * 1e6);
+	}
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: ParticleSystem.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the particle system
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "ParticleSystem.h"
+
+// SSE2 is always there on 64 bit x86 and on 32 bit builds that ask for it, anything else uses the plain loop
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define PARTICLES_USE_SSE2 0
+#endif
+
+// How many steps each ramp has, a cell with this much heat or more is drawn with the last one
+const int RAMP_LENGTH = 8;
+
+// The glyphs and colours for each ramp, from a single dying particle up to a cell full of fresh ones
+static const char RAMP_GLYPHS[PARTICLE_RAMP_COUNT][RAMP_LENGTH] = {
+	{ '.', ',', ':', ';', '+', '*', '*', '#' },
+	{ '.', ',', ':', ';', '*', '#', '%', '@' },
+};
+static const uint8_t RAMP_COLOURS[PARTICLE_RAMP_COUNT][RAMP_LENGTH] = {
+	{ 0x8, 0x8, 0x7, 0x7, 0xE, 0xE, 0xF, 0xF },
+	{ 0x4, 0x4, 0xC, 0xC, 0x6, 0xE, 0xE, 0xF },
+};
+
+void ParticleSystem::Initialise(int particleCapacity, int screenWidth, int screenHeight)
+{
+	// Round up to a whole number of groups of 4
+	capacity = (particleCapacity + 3) & ~3;
+	count = 0;
+
+	xPos.assign(capacity, 0.0f);
+	yPos.assign(capacity, 0.0f);
+	velocityX.assign(capacity, 0.0f);
+	velocityY.assign(capacity, 0.0f);
+	life.assign(capacity, 0.0f);
+	inverseStartLife.assign(capacity, 0.0f);
+	ramp.assign(capacity, 0);
+
+	Resize(screenWidth, screenHeight);
+}
+
+void ParticleSystem::Resize(int screenWidth, int screenHeight)
+{
+	bufferWidth = screenWidth;
+	bufferHeight = screenHeight;
+	cellHeat.assign(screenWidth * screenHeight, 0);
+	cellRamp.assign(screenWidth * screenHeight, 0);
+	touchedCells.assign(screenWidth * screenHeight, 0);
+}
+
+bool ParticleSystem::Spawn(float x, float y, float particleVelocityX, float particleVelocityY, float particleLife, PARTICLE_RAMP particleRamp)
+{
+	if (count >= capacity || particleLife <= 0.0f)
+	{
+		return false;
+	}
+
+	xPos[count] = x;
+	yPos[count] = y;
+	velocityX[count] = particleVelocityX;
+	velocityY[count] = particleVelocityY;
+	life[count] = particleLife;
+	inverseStartLife[count] = 1.0f / particleLife;
+	ramp[count] = (uint8_t)particleRamp;
+	count++;
+	return true;
+}
+
+void ParticleSystem::Emit(const ParticleBurst& burst, int spawnCount, Random& random)
+{
+	// Random numbers between -1 and 1 and between 0 and 1, from the top 24 bits so they are exact as floats
+	const float toSigned = 2.0f / 16777216.0f;
+	const float toUnsigned = 1.0f / 16777216.0f;
+
+	for (int i = 0; i < spawnCount; i++)
+	{
+		float spreadX = (float)(random.Next() >> 8) * toSigned - 1.0f;
+		float spreadY = (float)(random.Next() >> 8) * toSigned - 1.0f;
+		float lifeAmount = (float)(random.Next() >> 8) * toUnsigned;
+		if (!Spawn(burst.x, burst.y, burst.velocityX + spreadX * burst.spread, burst.velocityY + spreadY * burst.spread,
+			burst.minLife + (burst.maxLife - burst.minLife) * lifeAmount, burst.ramp))
+		{
+			// The pool is full, no point trying the rest
+			return;
+		}
+	}
+}
+
+void ParticleSystem::Update(float deltaTime, float gravity, float drag)
+{
+	float keep = 1.0f - drag * deltaTime;
+	keep = keep < 0.0f ? 0.0f : keep;
+	const float fall = gravity * deltaTime;
+
+	float* x = xPos.data();
+	float* y = yPos.data();
+	float* moveX = velocityX.data();
+	float* moveY = velocityY.data();
+	float* remaining = life.data();
+
+	// The capacity is a multiple of 4, so rounding the count up only ever moves dead particles past the end which is harmless
+	const int groupedCount = (count + 3) & ~3;
+	int i = 0;
+
+#if PARTICLES_USE_SSE2
+	const __m128 step = _mm_set1_ps(deltaTime);
+	const __m128 keepSpeed = _mm_set1_ps(keep);
+	const __m128 fallSpeed = _mm_set1_ps(fall);
+	for (; i < groupedCount; i += 4)
+	{
+		__m128 newMoveX = _mm_mul_ps(_mm_loadu_ps(moveX + i), keepSpeed);
+		__m128 newMoveY = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(moveY + i), keepSpeed), fallSpeed);
+		_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(newMoveX, step)));
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(newMoveY, step)));
+		_mm_storeu_ps(moveX + i, newMoveX);
+		_mm_storeu_ps(moveY + i, newMoveY);
+		_mm_storeu_ps(remaining + i, _mm_sub_ps(_mm_loadu_ps(remaining + i), step));
+	}
+#endif
+
+	// Anything the SSE2 loop didnt do, which is everything when it isnt there
+	for (; i < groupedCount; i++)
+	{
+		moveX[i] *= keep;
+		moveY[i] = moveY[i] * keep + fall;
+		x[i] += moveX[i] * deltaTime;
+		y[i] += moveY[i] * deltaTime;
+		remaining[i] -= deltaTime;
+	}
+
+	// Take out the ones that have died, this goes backwards so the particle moved in to a gap has already been checked
+	for (int particle = count - 1; particle >= 0; particle--)
+	{
+		if (remaining[particle] <= 0.0f)
+		{
+			Remove(particle);
+		}
+	}
+}
+
+void ParticleSystem::Draw(Compositor& compositor, Cell* consoleBuffer, int offsetX, int offsetY, int wrapWidth, int scale)
+{
+	const float cellScale = (float)scale;
+	const float scaledWrapWidth = (float)(wrapWidth * scale);
+	int touchedCount = 0;
+	int left = bufferWidth;
+	int top = bufferHeight;
+	int right = -1;
+	int bottom = -1;
+
+	// Add up the heat in each cell, a fresh particle gives 4 and one that is nearly gone gives 1
+	for (int i = 0; i < count; i++)
+	{
+		float x = xPos[i] * cellScale - (float)offsetX;
+		float y = yPos[i] * cellScale - (float)offsetY;
+		if (wrapWidth > 0)
+		{
+			x = x < 0.0f ? x + scaledWrapWidth : (x >= scaledWrapWidth ? x - scaledWrapWidth : x);
+		}
+		int cellX = (int)x;
+		int cellY = (int)y;
+		if (x < 0.0f || y < 0.0f || cellX >= bufferWidth || cellY >= bufferHeight)
+		{
+			continue;
+		}
+
+		int cell = cellX + bufferWidth * cellY;
+		if (cellHeat[cell] == 0)
+		{
+			touchedCells[touchedCount++] = cell;
+			cellRamp[cell] = 0;
+			left = cellX < left ? cellX : left;
+			right = cellX > right ? cellX : right;
+			top = cellY < top ? cellY : top;
+			bottom = cellY > bottom ? cellY : bottom;
+		}
+
+		int heat = 1 + (int)(life[i] * inverseStartLife[i] * 3.0f);
+		int total = cellHeat[cell] + heat;
+		cellHeat[cell] = (uint16_t)(total < RAMP_LENGTH ? total : RAMP_LENGTH);
+		// Explosions are drawn over exhaust when they share a cell
+		cellRamp[cell] = ramp[i] > cellRamp[cell] ? ramp[i] : cellRamp[cell];
+	}
+
+	if (touchedCount == 0)
+	{
+		return;
+	}
+
+	// Write out the cells that had something in them, and clear the heat ready for next frame
+	for (int i = 0; i < touchedCount; i++)
+	{
+		int cell = touchedCells[i];
+		int step = cellHeat[cell] - 1;
+		consoleBuffer[cell].glyph = RAMP_GLYPHS[cellRamp[cell]][step];
+		consoleBuffer[cell].attributes = RAMP_COLOURS[cellRamp[cell]][step];
+		cellHeat[cell] = 0;
+	}
+
+	// One rectangle around all of them, the particles are usually bunched up so this is less work than one per cell
+	compositor.MarkDirty(left, top, right - left + 1, bottom - top + 1);
+}
+
+void ParticleSystem::Remove(int index)
+{
+	int last = --count;
+	xPos[index] = xPos[last];
+	yPos[index] = yPos[last];
+	velocityX[index] = velocityX[last];
+	velocityY[index] = velocityY[last];
+	life[index] = life[last];
+	inverseStartLife[index] = inverseStartLife[last];
+	ramp[index] = ramp[last];
+}
@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: ParticleSystem.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the particle system used for the thruster exhaust and explosions. The particles live in a fixed size
+// pool that is allocated once, with each value in its own array so the update can move four particles at a time
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+// Includes
+#include "Compositor.h"
+#include "Random.h"
+#include <stdint.h>
+#include <vector>
+
+/// <summary>
+/// Which glyphs and colours a particle is drawn with, each one goes from faint to bright as more life is in the cell
+/// </summary>
+enum PARTICLE_RAMP
+{
+	PARTICLE_RAMP_EXHAUST,
+	PARTICLE_RAMP_EXPLOSION,
+	PARTICLE_RAMP_COUNT,
+};
+
+/// <summary>
+/// How a burst of particles is thrown out
+/// </summary>
+struct ParticleBurst
+{
+	// Where the burst comes from, in cells
+	float x = 0.0f;
+	float y = 0.0f;
+	// The speed that every particle starts with, in cells per second
+	float velocityX = 0.0f;
+	float velocityY = 0.0f;
+	// Each particle gets a random extra speed up to this much in each direction
+	float spread = 1.0f;
+	// Each particle lives for somewhere between these, in seconds
+	float minLife = 0.5f;
+	float maxLife = 1.0f;
+	PARTICLE_RAMP ramp = PARTICLE_RAMP_EXHAUST;
+};
+
+/// <summary>
+/// A pool of particles, nothing is allocated after Initialise so spawning, updating and drawing are all allocation free
+/// </summary>
+class ParticleSystem
+{
+public:
+	// How many particles there can be at once, it is a multiple of 4 so the update never needs a partly filled group
+	static const int DEFAULT_CAPACITY = 32768;
+
+	/// <summary>
+	/// Allocates the pool and the scratch space for drawing, this is the only allocation the particle system makes
+	/// </summary>
+	/// <param name="particleCapacity"> The most particles there can be at once, anything spawned past this is dropped </param>
+	/// <param name="screenWidth"> Width of the buffer the particles are drawn in to </param>
+	/// <param name="screenHeight"> Height of the buffer the particles are drawn in to </param>
+	void Initialise(int particleCapacity, int screenWidth, int screenHeight);
+
+	/// <summary>
+	/// Resizes the scratch space for drawing when the screen changes size, the particles themselves are kept
+	/// </summary>
+	/// <param name="screenWidth"> Width of the buffer the particles are drawn in to </param>
+	/// <param name="screenHeight"> Height of the buffer the particles are drawn in to </param>
+	void Resize(int screenWidth, int screenHeight);
+
+	/// <summary>
+	/// Adds one particle
+	/// </summary>
+	/// <returns> False if the pool was full and the particle was dropped </returns>
+	bool Spawn(float x, float y, float velocityX, float velocityY, float life, PARTICLE_RAMP ramp);
+
+	/// <summary>
+	/// Throws out a number of particles with random speeds and lifetimes
+	/// </summary>
+	/// <param name="burst"> Where they come from and how they move </param>
+	/// <param name="count"> How many particles to spawn </param>
+	/// <param name="random"> Where the random speeds and lifetimes come from, this should be the effects stream </param>
+	void Emit(const ParticleBurst& burst, int count, Random& random);
+
+	/// <summary>
+	/// Moves every particle and ages it, the ones that have run out of life are removed
+	/// </summary>
+	/// <param name="deltaTime"> Time since the last update in seconds </param>
+	/// <param name="gravity"> How fast the particles fall, in cells per second per second </param>
+	/// <param name="drag"> How much of their speed the particles lose each second, 0 for none </param>
+	void Update(float deltaTime, float gravity, float drag);
+
+	/// <summary>
+	/// Draws the particles in to the buffer. The life of every particle in a cell is added up and that picks the glyph and colour
+	/// from the ramp, so busy cells look brighter than ones with a single dying particle in them
+	/// </summary>
+	/// <param name="compositor"> The compositor for the frame, the area that was drawn over is marked with it </param>
+	/// <param name="consoleBuffer"> The buffer the compositor is drawing in to </param>
+	/// <param name="offsetX"> Where the left of the buffer is, this is the camera when the particles are somewhere on a planet </param>
+	/// <param name="offsetY"> Where the top of the buffer is </param>
+	/// <param name="wrapWidth"> How wide the planet is so particles across the edge of it are still drawn, 0 if nothing wraps </param>
+	/// <param name="scale"> How many cells of the buffer each cell the particles move in covers, the offsets are in cells of the buffer </param>
+	void Draw(Compositor& compositor, Cell* consoleBuffer, int offsetX = 0, int offsetY = 0, int wrapWidth = 0, int scale = 1);
+
+	/// <summary>
+	/// Removes every particle
+	/// </summary>
+	void Clear() { count = 0; }
+
+	int GetCount() const { return count; }
+	int GetCapacity() const { return capacity; }
+
+private:
+	/// <summary>
+	/// Removes a particle by moving the last one in to its place
+	/// </summary>
+	void Remove(int index);
+
+	int capacity = 0;
+	int count = 0;
+
+	// The particles, the same index in each array is the same particle. Only the first count are alive.
+	std::vector<float> xPos;
+	std::vector<float> yPos;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> life;
+	// 1 / the life the particle started with, so the draw can work out how far through its life it is with a multiply
+	std::vector<float> inverseStartLife;
+	std::vector<uint8_t> ramp;
+
+	// Scratch space for drawing, how much life is in each cell and which ramp the brightest particle in it used
+	int bufferWidth = 0;
+	int bufferHeight = 0;
+	std::vector<uint16_t> cellHeat;
+	std::vector<uint8_t> cellRamp;
+	// The cells that have something in them this frame, so only those need looking at afterwards
+	std::vector<int> touchedCells;
+};
+
+#endif // !PARTICLE_SYSTEM_H
@@ -0,0 +1,149 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Platform.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the interface that the game uses to talk to the operating system (console, input, timer and audio output),
+// the Win32 and POSIX terminal implementations live in PlatformWin32.cpp and PlatformPosix.cpp and the headless one in PlatformHeadless.cpp
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+// Outside of windows we dont have the console types, so these are minimal stand ins with the same layout
+// so that the key codes, and the presenter's conversion to console cells, stay the same on every platform
+typedef unsigned short WORD;
+typedef unsigned short WCHAR;
+
+struct CHAR_INFO
+{
+	union
+	{
+		WCHAR UnicodeChar;
+		char AsciiChar;
+	} Char;
+	WORD Attributes;
+};
+
+#define VK_RETURN 0x0D
+#define VK_ESCAPE 0x1B
+#endif
+
+#include "AudioSink.h"
+#include "Cell.h"
+#include <bitset>
+#include <stddef.h>
+
+// Key codes go from 0 to 255, the same as the windows virtual key codes
+const int KEY_CODE_COUNT = 256;
+
+// One bit per key code, a bit is set if that key is down
+typedef std::bitset<KEY_CODE_COUNT> KeySet;
+
+/// <summary>
+/// How much was sent to the console for a frame
+/// </summary>
+struct PresentStats
+{
+	int bytesWritten = 0;
+	int cellsWritten = 0;
+};
+
+/// <summary>
+/// This is the interface for everything the game needs from the operating system, each platform provides its own version of it
+/// </summary>
+class Platform
+{
+public:
+	virtual ~Platform() {}
+
+	/// <summary>
+	/// Sets up the console/terminal so that it is ready to be drawn to
+	/// </summary>
+	/// <param name="title"> The title of the window </param>
+	/// <param name="width"> Width the screen should be in characters, if the console cant be sized it is whatever size it already is </param>
+	/// <param name="height"> Height the screen should be in characters </param>
+	virtual void Initialise(const char* title, int width, int height) = 0;
+
+	/// <summary>
+	/// Puts the contents of the buffer on to the screen, only the cells that changed since the last present are sent
+	/// </summary>
+	/// <param name="buffer"> The buffer that holds the frame </param>
+	/// <param name="width"> Width of the buffer </param>
+	/// <param name="height"> Height of the buffer </param>
+	/// <returns> How many bytes and cells were written to the console </returns>
+	virtual PresentStats Present(const Cell* buffer, int width, int height) = 0;
+
+	/// <summary>
+	/// Checks if the console has changed size, the first call after Initialise always gives the size. When it has changed the
+	/// screen is cleared, so the next present sends the whole frame.
+	/// </summary>
+	/// <param name="width"> Set to the width of the console in characters if it changed </param>
+	/// <param name="height"> Set to the height of the console in characters if it changed </param>
+	/// <returns> True if the size is different to last time </returns>
+	virtual bool PollResize(int& width, int& height) = 0;
+
+	/// <summary>
+	/// Reads the keyboard once and records which of the given keys are down, this is meant to be called once per update
+	/// </summary>
+	/// <param name="keys"> The key codes to check, these are the KEY_ constants in Constants.h </param>
+	/// <param name="keyCount"> How many key codes there are </param>
+	/// <param name="keysDown"> The bits for the keys that are down are set, the rest are cleared </param>
+	virtual void PollKeys(const int* keys, int keyCount, KeySet& keysDown) = 0;
+
+	/// <summary>
+	/// Gets the current time from a monotonic high resolution clock
+	/// </summary>
+	/// <returns> Time in seconds since some arbitrary starting point </returns>
+	virtual double GetTime() = 0;
+
+	/// <summary>
+	/// Puts the calling thread to sleep for roughly the given amount of time
+	/// </summary>
+	/// <param name="seconds"> How long to sleep for </param>
+	virtual void SleepFor(double seconds) = 0;
+
+	/// <summary>
+	/// Creates the sink that sends sound to the speakers, the audio engine mixes everything and writes it here from its own thread
+	/// </summary>
+	/// <returns> The sink, the caller owns it </returns>
+	virtual AudioSink* CreateAudioSink() = 0;
+
+	/// <summary>
+	/// Moves a file on top of another one in a single step, so anything reading the destination sees either the old file or the
+	/// new one and never a half written one. This is safe to call from any thread.
+	/// </summary>
+	/// <param name="sourcePath"> The file to move, this is normally a temporary file that has just been written </param>
+	/// <param name="destinationPath"> The file to replace, it is created if it doesnt exist </param>
+	/// <returns> True if the file was replaced </returns>
+	virtual bool ReplaceFileAtomic(const char* sourcePath, const char* destinationPath) = 0;
+
+	/// <summary>
+	/// Maps a whole file in to memory so it can be read without loading or copying it, the pages are only read from disk as they are used
+	/// </summary>
+	/// <param name="path"> The file to map </param>
+	/// <param name="size"> Set to the size of the file </param>
+	/// <returns> The start of the file in memory, read only, or nullptr if it couldnt be mapped. It stays valid until UnmapFile. </returns>
+	virtual const void* MapFile(const char* path, size_t& size) = 0;
+
+	/// <summary>
+	/// Closes a mapping made by MapFile
+	/// </summary>
+	virtual void UnmapFile(const void* data, size_t size) = 0;
+};
+
+/// <summary>
+/// Creates the platform implementation for the operating system the game was built for
+/// </summary>
+/// <returns> The platform, the caller owns it </returns>
+Platform* CreatePlatform();
+
+/// <summary>
+/// Creates a platform with no screen, keyboard or sound whose clock only moves when SleepFor is called, used for replays
+/// </summary>
+/// <returns> The platform, the caller owns it </returns>
+Platform* CreateHeadlessPlatform();
+
+#endif // !PLATFORM_H
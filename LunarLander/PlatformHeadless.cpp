@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: PlatformHeadless.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains a platform with no screen, keyboard or sound, used to run the game as fast as possible for replays.
+// Time only moves when something sleeps, so nothing it does depends on how fast the computer is.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Includes
+#include "Platform.h"
+#include <stdio.h>
+
+/// <summary>
+/// This is the platform used when nothing is shown on screen
+/// </summary>
+class PlatformHeadless : public Platform
+{
+public:
+	void Initialise(const char* title, int width, int height) override
+	{
+		// The pretend screen is whatever size the game asks for
+		(void)title;
+		screenWidth = width;
+		screenHeight = height;
+	}
+
+	PresentStats Present(const Cell* buffer, int width, int height) override
+	{
+		// Nothing is sent anywhere
+		(void)buffer;
+		(void)width;
+		(void)height;
+		return PresentStats();
+	}
+
+	bool PollResize(int& width, int& height) override
+	{
+		// The screen never changes size, it is only reported the first time
+		if (sizeReported)
+		{
+			return false;
+		}
+		sizeReported = true;
+		width = screenWidth;
+		height = screenHeight;
+		return true;
+	}
+
+	void PollKeys(const int* keys, int keyCount, KeySet& keysDown) override
+	{
+		// There is no keyboard, the keys come from a recording instead
+		(void)keys;
+		(void)keyCount;
+		keysDown.reset();
+	}
+
+	double GetTime() override
+	{
+		return time;
+	}
+
+	void SleepFor(double seconds) override
+	{
+		// Sleeping just moves the clock on straight away
+		if (seconds > 0.0)
+		{
+			time += seconds;
+		}
+	}
+
+	AudioSink* CreateAudioSink() override
+	{
+		return new NullAudioSink();
+	}
+
+	bool ReplaceFileAtomic(const char* sourcePath, const char* destinationPath) override
+	{
+		// Headless runs dont save anything
+		(void)sourcePath;
+		(void)destinationPath;
+		return false;
+	}
+
+	const void* MapFile(const char* path, size_t& size) override
+	{
+		// There is no operating system to map with, so the file is just read in to memory. It is only used for replays
+		// so how long that takes doesnt matter.
+		FILE* file = fopen(path, "rb");
+		if (!file)
+		{
+			return nullptr;
+		}
+
+		char* data = nullptr;
+		if (fseek(file, 0, SEEK_END) == 0)
+		{
+			long length = ftell(file);
+			if (length > 0 && fseek(file, 0, SEEK_SET) == 0)
+			{
+				data = new char[length];
+				if (fread(data, 1, (size_t)length, file) == (size_t)length)
+				{
+					size = (size_t)length;
+				}
+				else
+				{
+					delete[] data;
+					data = nullptr;
+				}
+			}
+		}
+		fclose(file);
+		return data;
+	}
+
+	void UnmapFile(const void* data, size_t size) override
+	{
+		(void)size;
+		delete[] (const char*)data;
+	}
+
+private:
+	double time = 0.0;
+	int screenWidth = 0;
+	int screenHeight = 0;
+	bool sizeReported = false;
+};
+
+Platform* CreateHeadlessPlatform()
+{
+	return new PlatformHeadless();
+}
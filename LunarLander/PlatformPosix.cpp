@@ -0,0 +1,343 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: PlatformPosix.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the linux/unix terminal implementation of the platform interface, it uses termios for raw
+// keyboard input and ANSI escape codes for drawing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+// Includes
+#include "Platform.h"
+#include "Presenter.h"
+#include <string>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The terminal settings from before the game started, these are put back when the game closes
+static struct termios originalTermios;
+static bool termiosChanged = false;
+// Set by the signal handler when the terminal changes size, it starts off set so that the first check reads the size
+static volatile sig_atomic_t terminalResized = 1;
+
+/// <summary>
+/// Puts the terminal back to how it was before the game changed it, this is also used by the signal handler
+/// </summary>
+static void RestoreTerminal()
+{
+	if (termiosChanged)
+	{
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &originalTermios);
+		termiosChanged = false;
+	}
+
+	// Reset the colours, show the cursor again, turn line wrapping back on and leave the alternate screen
+	const char reset[] = "\x1b[0m\x1b[?25h\x1b[?7h\x1b[?1049l";
+	ssize_t ignored = write(STDOUT_FILENO, reset, sizeof(reset) - 1);
+	(void)ignored;
+}
+
+/// <summary>
+/// If the game gets killed with ctrl+c then this makes sure the terminal isnt left in raw mode
+/// </summary>
+static void HandleSignal(int signalNumber)
+{
+	RestoreTerminal();
+	signal(signalNumber, SIG_DFL);
+	raise(signalNumber);
+}
+
+/// <summary>
+/// The terminal has changed size, the size is read the next time the game checks rather than in here
+/// </summary>
+static void HandleResize(int signalNumber)
+{
+	(void)signalNumber;
+	terminalResized = 1;
+}
+
+/// <summary>
+/// This is the platform for a unix terminal, it should work with anything that understands ANSI escape codes
+/// </summary>
+class PlatformPosix : public Platform
+{
+public:
+	PlatformPosix()
+	{
+		// No keys have been seen yet
+		for (int i = 0; i < KEY_COUNT; i++)
+		{
+			keyLastSeen[i] = -1.0;
+		}
+	}
+
+	~PlatformPosix() override
+	{
+		RestoreTerminal();
+	}
+
+	void Initialise(const char* title, int width, int height) override
+	{
+		// Switch the terminal into raw mode so that key presses arrive straight away and arent echoed
+		if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &originalTermios) == 0)
+		{
+			struct termios raw = originalTermios;
+			raw.c_iflag &= ~(IXON | ICRNL);
+			raw.c_lflag &= ~(ECHO | ICANON);
+			// Reads should never wait for input, the game polls every frame
+			raw.c_cc[VMIN] = 0;
+			raw.c_cc[VTIME] = 0;
+			tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+			termiosChanged = true;
+
+			signal(SIGINT, HandleSignal);
+			signal(SIGTERM, HandleSignal);
+		}
+
+		// A terminal cant be resized from in here, the game draws to whatever size it is and is told when that changes
+		signal(SIGWINCH, HandleResize);
+		fallbackWidth = width;
+		fallbackHeight = height;
+
+		// Set the title, use the alternate screen so the players terminal is left alone, hide the cursor, stop the terminal
+		// wrapping (so drawing in the bottom right corner doesnt scroll the screen) and clear the screen
+		std::string setup = "\x1b]0;";
+		setup += title;
+		setup += "\x07\x1b[?1049h\x1b[?25l\x1b[?7l\x1b[2J";
+		WriteAll(setup.data(), setup.size());
+
+		// The screen has just been cleared so the next frame has to be sent in full
+		presenter.Invalidate();
+	}
+
+	PresentStats Present(const Cell* buffer, int width, int height) override
+	{
+		// Work out what has changed since the last frame and turn just those cells into escape codes
+		presenter.Diff(buffer, width, height);
+		presenter.EncodeAnsi(buffer, width, frame);
+
+		WriteAll(frame.data(), frame.size());
+
+		PresentStats stats;
+		stats.bytesWritten = (int)frame.size();
+		stats.cellsWritten = presenter.GetChangedCells();
+		return stats;
+	}
+
+	bool PollResize(int& width, int& height) override
+	{
+		if (!terminalResized)
+		{
+			return false;
+		}
+		terminalResized = 0;
+
+		// If the output isnt a terminal then there is no size to read, so the size the game asked for is used
+		int newWidth = fallbackWidth;
+		int newHeight = fallbackHeight;
+		struct winsize size;
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0)
+		{
+			newWidth = size.ws_col;
+			newHeight = size.ws_row;
+		}
+		if (newWidth == screenWidth && newHeight == screenHeight)
+		{
+			return false;
+		}
+		screenWidth = newWidth;
+		screenHeight = newHeight;
+
+		// The terminal has moved or cut off whatever was on it, so start again from a clear screen
+		const char clear[] = "\x1b[2J";
+		WriteAll(clear, sizeof(clear) - 1);
+		presenter.Invalidate();
+
+		width = screenWidth;
+		height = screenHeight;
+		return true;
+	}
+
+	void PollKeys(const int* keys, int keyCount, KeySet& keysDown) override
+	{
+		// Everything that has been typed since the last poll is read in one go
+		PollInput();
+
+		double now = GetTime();
+		keysDown.reset();
+		for (int i = 0; i < keyCount; i++)
+		{
+			int key = keys[i];
+			if (key >= 0 && key < KEY_COUNT && keyLastSeen[key] >= 0.0 && (now - keyLastSeen[key]) < keyHoldTime[key])
+			{
+				keysDown.set(key);
+			}
+		}
+	}
+
+	double GetTime() override
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+	}
+
+	void SleepFor(double seconds) override
+	{
+		if (seconds > 0.0)
+		{
+			struct timespec duration;
+			duration.tv_sec = (time_t)seconds;
+			duration.tv_nsec = (long)((seconds - (double)duration.tv_sec) * 1e9);
+			nanosleep(&duration, nullptr);
+		}
+	}
+
+	AudioSink* CreateAudioSink() override
+	{
+		// There is no sound device that every unix has, so the sound is mixed and then thrown away.
+		// Use --audio-file to save it to a .wav file instead
+		return new NullAudioSink();
+	}
+
+	bool ReplaceFileAtomic(const char* sourcePath, const char* destinationPath) override
+	{
+		// rename already replaces the destination in one step as long as both are on the same file system
+		return rename(sourcePath, destinationPath) == 0;
+	}
+
+	const void* MapFile(const char* path, size_t& size) override
+	{
+		int file = open(path, O_RDONLY);
+		if (file < 0)
+		{
+			return nullptr;
+		}
+
+		// The mapping keeps the file open by itself, so the descriptor can be closed straight away
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			size = (size_t)status.st_size;
+			data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		}
+		close(file);
+		return data == MAP_FAILED ? nullptr : data;
+	}
+
+	void UnmapFile(const void* data, size_t size) override
+	{
+		munmap((void*)data, size);
+	}
+
+private:
+	/// <summary>
+	/// Reads everything that is waiting on stdin and records which keys were in it
+	/// </summary>
+	void PollInput()
+	{
+		char bytes[64];
+		ssize_t count;
+		while ((count = read(STDIN_FILENO, bytes, sizeof(bytes))) > 0)
+		{
+			double now = GetTime();
+			for (ssize_t i = 0; i < count; i++)
+			{
+				char byte = bytes[i];
+
+				if (byte == '\x1b')
+				{
+					// An escape followed by [ or O is the start of a sequence (arrow keys etc) rather than the escape key itself,
+					// these arent used by the game so skip to the final byte of the sequence
+					if (i + 1 < count && (bytes[i + 1] == '[' || bytes[i + 1] == 'O'))
+					{
+						i += 2;
+						while (i < count && (bytes[i] < 0x40 || bytes[i] > 0x7E))
+						{
+							i++;
+						}
+						continue;
+					}
+					KeySeen(VK_ESCAPE, now);
+				}
+				else if (byte == '\r' || byte == '\n')
+				{
+					KeySeen(VK_RETURN, now);
+				}
+				else if (byte >= 'a' && byte <= 'z')
+				{
+					// The key codes are the same as windows, which uses upper case letters
+					KeySeen(byte - 'a' + 'A', now);
+				}
+				else if (byte > 0)
+				{
+					KeySeen(byte, now);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// A terminal only tells us when a character is typed, not when a key goes up, so a key counts as held for a short time after it
+	/// was seen. The first press has to last until the keyboard starts repeating, after that it only has to cover the gap between repeats.
+	/// </summary>
+	void KeySeen(int key, double now)
+	{
+		bool isRepeat = keyLastSeen[key] >= 0.0 && (now - keyLastSeen[key]) < keyHoldTime[key];
+		keyHoldTime[key] = isRepeat ? REPEAT_HOLD_TIME : FIRST_HOLD_TIME;
+		keyLastSeen[key] = now;
+	}
+
+	/// <summary>
+	/// Writes all of the data to stdout, write() is allowed to only write part of it so this keeps going until it is done
+	/// </summary>
+	void WriteAll(const char* data, size_t size)
+	{
+		while (size > 0)
+		{
+			ssize_t written = write(STDOUT_FILENO, data, size);
+			if (written <= 0)
+			{
+				return;
+			}
+			data += written;
+			size -= (size_t)written;
+		}
+	}
+
+	// Constants
+	static const int KEY_COUNT = KEY_CODE_COUNT;
+	// Roughly the keyboard repeat delay and a bit more than the repeat interval of most terminals
+	static constexpr double FIRST_HOLD_TIME = 0.55;
+	static constexpr double REPEAT_HOLD_TIME = 0.1;
+
+	// Variables
+	double keyLastSeen[KEY_COUNT];
+	double keyHoldTime[KEY_COUNT] = {};
+	// The size of the terminal as of the last check, and the size to use if it cant be read
+	int screenWidth = 0;
+	int screenHeight = 0;
+	int fallbackWidth = 0;
+	int fallbackHeight = 0;
+	// Keeps track of what is on screen so only the changes are sent
+	Presenter presenter;
+	// The frame gets built up in here before it is written, it is kept around so that its memory is reused
+	std::string frame;
+};
+
+Platform* CreatePlatform()
+{
+	return new PlatformPosix();
+}
+
+#endif // !_WIN32
@@ -0,0 +1,291 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: PlatformWin32.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the windows console implementation of the platform interface
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+// Includes
+#include "Platform.h"
+#include "Presenter.h"
+#include <Windows.h>
+
+// waveOut and timeBeginPeriod live in the windows multimedia library
+#pragma comment(lib, "winmm.lib")
+
+/// <summary>
+/// Sends the mixed sound to the default sound device, a few blocks are queued up at a time so the device never runs dry
+/// </summary>
+class WaveOutAudioSink : public AudioSink
+{
+public:
+	bool Open(int sampleRate) override
+	{
+		// The device sets this event each time it finishes a block
+		blockDone = CreateEventA(NULL, FALSE, FALSE, NULL);
+
+		WAVEFORMATEX format = {};
+		format.wFormatTag = WAVE_FORMAT_PCM;
+		format.nChannels = 1;
+		format.nSamplesPerSec = (DWORD)sampleRate;
+		format.wBitsPerSample = 16;
+		format.nBlockAlign = 2;
+		format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+		if (!blockDone || waveOutOpen(&device, WAVE_MAPPER, &format, (DWORD_PTR)blockDone, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+		{
+			device = NULL;
+			return false;
+		}
+		return true;
+	}
+
+	void Write(const short* samples, int sampleCount) override
+	{
+		if (sampleCount > MAX_BLOCK_SIZE)
+		{
+			sampleCount = MAX_BLOCK_SIZE;
+		}
+
+		// Wait for the oldest block to finish playing so its memory can be reused
+		WAVEHDR& header = headers[nextBlock];
+		while (queued[nextBlock] && !(header.dwFlags & WHDR_DONE))
+		{
+			WaitForSingleObject(blockDone, 100);
+		}
+		if (header.dwFlags & WHDR_PREPARED)
+		{
+			waveOutUnprepareHeader(device, &header, sizeof(WAVEHDR));
+		}
+
+		memcpy(blocks[nextBlock], samples, sampleCount * sizeof(short));
+		header = {};
+		header.lpData = (LPSTR)blocks[nextBlock];
+		header.dwBufferLength = (DWORD)(sampleCount * sizeof(short));
+		waveOutPrepareHeader(device, &header, sizeof(WAVEHDR));
+		waveOutWrite(device, &header, sizeof(WAVEHDR));
+		queued[nextBlock] = true;
+
+		nextBlock = (nextBlock + 1) % BLOCK_COUNT;
+	}
+
+	void Close() override
+	{
+		if (device)
+		{
+			// Reset stops playback and marks every queued block as done
+			waveOutReset(device);
+			for (int i = 0; i < BLOCK_COUNT; i++)
+			{
+				if (headers[i].dwFlags & WHDR_PREPARED)
+				{
+					waveOutUnprepareHeader(device, &headers[i], sizeof(WAVEHDR));
+				}
+			}
+			waveOutClose(device);
+			device = NULL;
+		}
+		if (blockDone)
+		{
+			CloseHandle(blockDone);
+			blockDone = NULL;
+		}
+	}
+
+private:
+	static const int BLOCK_COUNT = 4;
+	static const int MAX_BLOCK_SIZE = 1024;
+
+	HWAVEOUT device = NULL;
+	HANDLE blockDone = NULL;
+	WAVEHDR headers[BLOCK_COUNT] = {};
+	short blocks[BLOCK_COUNT][MAX_BLOCK_SIZE];
+	bool queued[BLOCK_COUNT] = {};
+	int nextBlock = 0;
+};
+
+/// <summary>
+/// This is the platform for the windows console, it is what the game originally ran on
+/// </summary>
+class PlatformWin32 : public Platform
+{
+public:
+	PlatformWin32()
+	{
+		// Get the frequency of the performance counter so that ticks can be turned into seconds
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		secondsPerTick = 1.0 / (double)frequency.QuadPart;
+
+		// By default sleep is only accurate to about 15ms, this makes it accurate to 1ms so the frame scheduler can sleep properly
+		timeBeginPeriod(1);
+	}
+
+	~PlatformWin32() override
+	{
+		timeEndPeriod(1);
+	}
+
+	void Initialise(const char* title, int width, int height) override
+	{
+		// Set the console title
+		SetConsoleTitleA(title);
+
+		// Set screen buffer size
+		COORD bufferSize = { (SHORT)width, (SHORT)height };
+		SetConsoleScreenBufferSize(wHnd, bufferSize);
+		// Set the window size, be sure to start at zero
+		SMALL_RECT windowSize = { 0, 0, (SHORT)(width - 1), (SHORT)(height - 1) };
+		SetConsoleWindowInfo(wHnd, TRUE, &windowSize);
+	}
+
+	PresentStats Present(const Cell* buffer, int width, int height) override
+	{
+		PresentStats stats;
+
+		// Work out what has changed since the last frame, if nothing has then there is no need to write anything
+		presenter.Diff(buffer, width, height);
+		int left, top, right, bottom;
+		if (!presenter.GetChangedBounds(left, top, right, bottom))
+		{
+			return stats;
+		}
+
+		// Only the rectangle around the changes is converted to the console's cells and written
+		presenter.EncodeCharInfo(buffer, width, consoleCells);
+		COORD characterBufferSize = { (SHORT)(right - left + 1), (SHORT)(bottom - top + 1) };
+		COORD characterPosition = { 0, 0 };
+		SMALL_RECT consoleWriteArea = { (SHORT)left, (SHORT)top, (SHORT)right, (SHORT)bottom };
+
+		WriteConsoleOutputA(wHnd, consoleCells.data(), characterBufferSize, characterPosition, &consoleWriteArea);
+
+		stats.cellsWritten = (right - left + 1) * (bottom - top + 1);
+		stats.bytesWritten = stats.cellsWritten * (int)sizeof(CHAR_INFO);
+		return stats;
+	}
+
+	bool PollResize(int& width, int& height) override
+	{
+		// The window can be resized by dragging it at any time, so its size is checked every time
+		CONSOLE_SCREEN_BUFFER_INFO info;
+		if (!GetConsoleScreenBufferInfo(wHnd, &info))
+		{
+			return false;
+		}
+		int newWidth = info.srWindow.Right - info.srWindow.Left + 1;
+		int newHeight = info.srWindow.Bottom - info.srWindow.Top + 1;
+		if (newWidth == screenWidth && newHeight == screenHeight)
+		{
+			return false;
+		}
+		screenWidth = newWidth;
+		screenHeight = newHeight;
+
+		// Make the buffer the same size as the window so there are no scroll bars, then clear it so the next frame goes out in full
+		COORD bufferSize = { (SHORT)screenWidth, (SHORT)screenHeight };
+		SetConsoleScreenBufferSize(wHnd, bufferSize);
+		COORD topLeft = { 0, 0 };
+		DWORD written = 0;
+		FillConsoleOutputCharacterA(wHnd, ' ', (DWORD)(screenWidth * screenHeight), topLeft, &written);
+		FillConsoleOutputAttribute(wHnd, 0, (DWORD)(screenWidth * screenHeight), topLeft, &written);
+		presenter.Invalidate();
+
+		width = screenWidth;
+		height = screenHeight;
+		return true;
+	}
+
+	void PollKeys(const int* keys, int keyCount, KeySet& keysDown) override
+	{
+		keysDown.reset();
+		for (int i = 0; i < keyCount; i++)
+		{
+			// The most significant bit is set if the key is down, the least significant bit is set if it was pressed since the last check.
+			// Using both means a quick tap between two updates is still seen for one update
+			SHORT state = GetAsyncKeyState(keys[i]);
+			if ((state & 0x8001) != 0)
+			{
+				keysDown.set(keys[i]);
+			}
+		}
+	}
+
+	double GetTime() override
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return (double)counter.QuadPart * secondsPerTick;
+	}
+
+	void SleepFor(double seconds) override
+	{
+		if (seconds > 0.0)
+		{
+			Sleep((DWORD)(seconds * 1000.0));
+		}
+	}
+
+	AudioSink* CreateAudioSink() override
+	{
+		return new WaveOutAudioSink();
+	}
+
+	bool ReplaceFileAtomic(const char* sourcePath, const char* destinationPath) override
+	{
+		// Unlike rename, this is allowed to replace a file that already exists
+		return MoveFileExA(sourcePath, destinationPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+	}
+
+	const void* MapFile(const char* path, size_t& size) override
+	{
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+
+		// The view keeps the file and the mapping open by itself, so both handles can be closed straight away
+		const void* data = nullptr;
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping)
+			{
+				data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				size = (size_t)fileSize.QuadPart;
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+		return data;
+	}
+
+	void UnmapFile(const void* data, size_t size) override
+	{
+		(void)size;
+		UnmapViewOfFile(data);
+	}
+
+private:
+	// The size of the console window as of the last check
+	int screenWidth = 0;
+	int screenHeight = 0;
+	// Keeps track of what is on screen so only the changes are sent
+	Presenter presenter;
+	// The changed part of the frame in the console's own format, kept between frames so it isnt reallocated
+	std::vector<CHAR_INFO> consoleCells;
+	// Initialise handles
+	HANDLE wHnd = GetStdHandle(STD_OUTPUT_HANDLE);
+	HANDLE rHnd = GetStdHandle(STD_INPUT_HANDLE);
+	// Used to convert the performance counter into seconds
+	double secondsPerTick = 0.0;
+};
+
+Platform* CreatePlatform()
+{
+	return new PlatformWin32();
+}
+
+#endif // _WIN32
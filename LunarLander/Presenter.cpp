@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Presenter.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the presenter, which finds the changed parts of a frame and encodes them for the console
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Presenter.h"
+
+/// <summary>
+/// Adds a positive number on to the end of a string without creating a temporary string for it
+/// </summary>
+static void AppendNumber(std::string& output, int number)
+{
+	char digits[12];
+	int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + number % 10);
+		number /= 10;
+	} while (number > 0);
+
+	while (count > 0)
+	{
+		output += digits[--count];
+	}
+}
+
+/// <summary>
+/// Converts a console colour (the 4 bit windows one, 1 = blue, 2 = green, 4 = red, 8 = bright) into the ANSI colour index
+/// </summary>
+static int ToAnsiColour(int consoleColour)
+{
+	return ((consoleColour & 1) ? 4 : 0) | (consoleColour & 2) | ((consoleColour & 4) ? 1 : 0);
+}
+
+const std::vector<CellSpan>& Presenter::Diff(const Cell* buffer, int width, int height)
+{
+	spans.clear();
+	changedCells = 0;
+
+	// If the size has changed (or nothing has been presented yet) then the whole frame needs to go out
+	if (!hasPreviousFrame || width != previousWidth || height != previousHeight)
+	{
+		previousFrame.assign(buffer, buffer + width * height);
+		previousWidth = width;
+		previousHeight = height;
+		hasPreviousFrame = true;
+
+		for (int y = 0; y < height; y++)
+		{
+			spans.push_back({ y, 0, width });
+		}
+		changedCells = width * height;
+		return spans;
+	}
+
+	// Most of the frame is the same as last time, the kernel skips over those parts many cells at a time
+	for (int y = 0; y < height; y++)
+	{
+		changedCells += DiffCellRow(buffer + width * y, previousFrame.data() + width * y, width, y, MERGE_GAP, spans);
+	}
+
+	return spans;
+}
+
+void Presenter::EncodeAnsi(const Cell* buffer, int width, std::string& output) const
+{
+	output.clear();
+
+	int currentAttributes = -1;
+	for (const CellSpan& span : spans)
+	{
+		// Move the cursor to the start of the span, the escape code is 1 based
+		output += "\x1b[";
+		AppendNumber(output, span.y + 1);
+		output += ';';
+		AppendNumber(output, span.xStart + 1);
+		output += 'H';
+
+		const Cell* row = buffer + width * span.y;
+		for (int x = span.xStart; x < span.xEnd; x++)
+		{
+			// Only change the colour when it is different from the last cell as escape codes are expensive,
+			// the low 4 bits are the text colour and the next 4 are the background
+			if (row[x].attributes != currentAttributes)
+			{
+				currentAttributes = row[x].attributes;
+				int foreground = currentAttributes & 0xF;
+				int background = (currentAttributes >> 4) & 0xF;
+
+				output += "\x1b[";
+				AppendNumber(output, ((foreground & 8) ? 90 : 30) + ToAnsiColour(foreground));
+				output += ';';
+				AppendNumber(output, ((background & 8) ? 100 : 40) + ToAnsiColour(background));
+				output += 'm';
+			}
+
+			// A zero character is what ClearScreen leaves behind, that needs to be a space on a terminal
+			char character = row[x].glyph;
+			output += (character == 0) ? ' ' : character;
+		}
+	}
+
+	if (!spans.empty())
+	{
+		output += "\x1b[0m";
+	}
+}
+
+void Presenter::EncodeCharInfo(const Cell* buffer, int width, std::vector<CHAR_INFO>& output) const
+{
+	int left, top, right, bottom;
+	if (!GetChangedBounds(left, top, right, bottom))
+	{
+		output.clear();
+		return;
+	}
+
+	// Only the rectangle around the changes is converted, the console is told it is a buffer of just that size
+	int boundsWidth = right - left + 1;
+	output.resize(boundsWidth * (bottom - top + 1));
+	CHAR_INFO* outputCell = output.data();
+	for (int y = top; y <= bottom; y++)
+	{
+		const Cell* row = buffer + width * y;
+		for (int x = left; x <= right; x++)
+		{
+			// The high byte of the union is cleared too, WriteConsoleOutputA only reads the low one but it keeps the output the same every time
+			outputCell->Char.UnicodeChar = 0;
+			outputCell->Char.AsciiChar = row[x].glyph;
+			outputCell->Attributes = row[x].attributes;
+			outputCell++;
+		}
+	}
+}
+
+bool Presenter::GetChangedBounds(int& left, int& top, int& right, int& bottom) const
+{
+	if (spans.empty())
+	{
+		return false;
+	}
+
+	// The spans are in row order, so the first and last give the top and bottom
+	top = spans.front().y;
+	bottom = spans.back().y;
+	left = spans.front().xStart;
+	right = spans.front().xEnd - 1;
+	for (const CellSpan& span : spans)
+	{
+		left = span.xStart < left ? span.xStart : left;
+		right = span.xEnd - 1 > right ? span.xEnd - 1 : right;
+	}
+	return true;
+}
+
+void Presenter::Invalidate()
+{
+	hasPreviousFrame = false;
+}
@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Presenter.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the presenter, it remembers the last frame that was put on screen so that only the cells that have
+// changed since then need to be sent to the console
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PRESENTER_H
+#define PRESENTER_H
+
+// Includes
+#include "CellKernels.h"
+#include "Platform.h"
+#include <string>
+#include <vector>
+
+/// <summary>
+/// This class works out which parts of a frame have changed since the previous present and turns them into console output
+/// </summary>
+class Presenter
+{
+public:
+	/// <summary>
+	/// Compares the frame against the last presented one and builds the list of changed spans, the frame then becomes the last presented one
+	/// </summary>
+	/// <param name="buffer"> The frame that is about to be presented </param>
+	/// <param name="width"> Width of the frame </param>
+	/// <param name="height"> Height of the frame </param>
+	/// <returns> The spans of cells that need to be written </returns>
+	const std::vector<CellSpan>& Diff(const Cell* buffer, int width, int height);
+
+	/// <summary>
+	/// Turns the spans from the last Diff into ANSI escape codes, a cursor move followed by the text of each span
+	/// </summary>
+	/// <param name="buffer"> The frame that was passed to Diff </param>
+	/// <param name="width"> Width of the frame </param>
+	/// <param name="output"> The escape codes are written in to here, it is cleared first </param>
+	void EncodeAnsi(const Cell* buffer, int width, std::string& output) const;
+
+	/// <summary>
+	/// Turns the rectangle from GetChangedBounds into console cells for WriteConsoleOutput, the first cell is the top left of the rectangle
+	/// </summary>
+	/// <param name="buffer"> The frame that was passed to Diff </param>
+	/// <param name="width"> Width of the frame </param>
+	/// <param name="output"> The console cells, row by row, resized to fit the rectangle. Empty if nothing changed. </param>
+	void EncodeCharInfo(const Cell* buffer, int width, std::vector<CHAR_INFO>& output) const;
+
+	/// <summary>
+	/// Gets the smallest rectangle that holds every span from the last Diff, this is what gets passed to WriteConsoleOutput
+	/// </summary>
+	/// <returns> False if nothing changed </returns>
+	bool GetChangedBounds(int& left, int& top, int& right, int& bottom) const;
+
+	/// <summary>
+	/// Forgets the last presented frame, so that the next Diff returns the whole frame (used when the screen has been cleared)
+	/// </summary>
+	void Invalidate();
+
+	/// <summary>
+	/// Gets the spans from the last Diff
+	/// </summary>
+	const std::vector<CellSpan>& GetSpans() const { return spans; }
+
+	/// <summary>
+	/// Gets how many cells are in the spans from the last Diff
+	/// </summary>
+	int GetChangedCells() const { return changedCells; }
+
+private:
+	// Two spans on the same row are joined together if the gap between them is this many cells or less,
+	// because re-sending a few unchanged cells is cheaper than the cursor move needed to jump over them
+	static const int MERGE_GAP = 4;
+
+	// The last frame that was presented
+	std::vector<Cell> previousFrame;
+	int previousWidth = 0;
+	int previousHeight = 0;
+	bool hasPreviousFrame = false;
+
+	// The result of the last Diff
+	std::vector<CellSpan> spans;
+	int changedCells = 0;
+};
+
+#endif // !PRESENTER_H
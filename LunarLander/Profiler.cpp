@@ -0,0 +1,238 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Profiler.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the frame profiler
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Profiler.h"
+
+// Includes
+#include <algorithm>
+#include <string.h>
+
+// The names the parts are shown with, in the same order as PROFILE_PHASE
+static const char* PHASE_NAMES[PROFILE_PHASE_COUNT] = { "FRAME", "INPUT", "SIM", "AUDIO", "COMPOSE", "TEXT", "PRESENT" };
+// The same for the counters, along with what each one is multiplied by when it is shown or traced so times are in microseconds
+// like the phases are
+static const char* COUNTER_NAMES[PROFILE_COUNTER_COUNT] = { "BYTES", "CELLS", "JITTER", "LATENCY" };
+static const float COUNTER_SCALES[PROFILE_COUNTER_COUNT] = { 1.0f, 1.0f, 1e6f, 1e6f };
+
+/// <summary>
+/// Works out the p50 and p99 of some values, only the two values are needed so they are only sorted enough to find them
+/// </summary>
+/// <param name="values"> The values, these are left as they are </param>
+/// <param name="count"> How many values there are, up to HISTORY_FRAMES </param>
+static void FindPercentiles(const float* values, int count, float& percentile50, float& percentile99)
+{
+	if (count == 0)
+	{
+		percentile50 = 0.0f;
+		percentile99 = 0.0f;
+		return;
+	}
+
+	float sorted[Profiler::HISTORY_FRAMES];
+	memcpy(sorted, values, count * sizeof(float));
+	int middle = count / 2;
+	int top = (count * 99) / 100;
+	std::nth_element(sorted, sorted + middle, sorted + count);
+	percentile50 = sorted[middle];
+	std::nth_element(sorted, sorted + top, sorted + count);
+	percentile99 = sorted[top];
+}
+
+Profiler::Profiler()
+	: epoch(std::chrono::steady_clock::now())
+{
+	UpdateStats();
+}
+
+Profiler::~Profiler()
+{
+	Shutdown();
+}
+
+bool Profiler::StartTrace(const char* path)
+{
+	Shutdown();
+
+	traceFile = fopen(path, "w");
+	if (!traceFile)
+	{
+		return false;
+	}
+
+	size_t length = strlen(path);
+	traceIsJson = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+	if (traceIsJson)
+	{
+		fputs("{\"traceEvents\":[\n", traceFile);
+	}
+	else
+	{
+		fputs("frame,phase,start_us,duration_us,value\n", traceFile);
+	}
+
+	samples.reset(new SampleQueue());
+	droppedSamples = 0;
+	stopping = false;
+	traceWriter = std::thread(&Profiler::TraceLoop, this);
+	return true;
+}
+
+void Profiler::Shutdown()
+{
+	if (!traceWriter.joinable())
+	{
+		return;
+	}
+
+	// The trace thread empties the queue before it stops, then the file can be finished off
+	stopping = true;
+	traceWriter.join();
+	if (traceIsJson)
+	{
+		fprintf(traceFile, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_samples\":%lld}}\n", droppedSamples);
+	}
+	fclose(traceFile);
+	traceFile = nullptr;
+	samples.reset();
+}
+
+void Profiler::BeginFrame()
+{
+	frameStart = Now();
+}
+
+void Profiler::EndFrame()
+{
+	Record(PROFILE_FRAME, frameStart, Now());
+
+	for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+	{
+		history[phase][historyNext] = frameTotals[phase];
+		frameTotals[phase] = 0.0f;
+	}
+	historyNext = (historyNext + 1) % HISTORY_FRAMES;
+	historyCount = historyCount < HISTORY_FRAMES ? historyCount + 1 : HISTORY_FRAMES;
+
+	// Sorting the history every frame would cost more than some of the parts being timed, so it is only done now and then
+	frameNumber++;
+	if (frameNumber % STATS_INTERVAL == 0)
+	{
+		UpdateStats();
+	}
+}
+
+void Profiler::Record(PROFILE_PHASE phase, double start, double end)
+{
+	float duration = (float)(end - start);
+	frameTotals[phase] += duration;
+	PushSample({ start, duration, frameNumber, (uint8_t)phase, false });
+}
+
+void Profiler::RecordCounter(PROFILE_COUNTER counter, float value)
+{
+	counterHistory[counter][counterHistoryNext[counter]] = value;
+	counterHistoryNext[counter] = (counterHistoryNext[counter] + 1) % HISTORY_FRAMES;
+	counterHistoryCount[counter] = counterHistoryCount[counter] < HISTORY_FRAMES ? counterHistoryCount[counter] + 1 : HISTORY_FRAMES;
+	PushSample({ Now(), value, frameNumber, (uint8_t)counter, true });
+}
+
+/// <summary>
+/// Sends a sample to the trace thread, if there is a trace
+/// </summary>
+void Profiler::PushSample(const ProfileSample& sample)
+{
+	if (samples && !samples->Push(sample))
+	{
+		droppedSamples++;
+	}
+}
+
+void Profiler::UpdateStats()
+{
+	for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+	{
+		FindPercentiles(history[phase], historyCount, percentile50[phase], percentile99[phase]);
+	}
+	for (int counter = 0; counter < PROFILE_COUNTER_COUNT; counter++)
+	{
+		FindPercentiles(counterHistory[counter], counterHistoryCount[counter], counterPercentile50[counter], counterPercentile99[counter]);
+	}
+
+	// The overlay text is built here rather than every frame, it is only read when it is drawn
+	const int rowSize = (int)sizeof(overlayText[0]);
+	int length = snprintf(overlayText[0], rowSize, "us p50/p99");
+	for (int phase = 0; phase < PROFILE_PHASE_COUNT && length < rowSize; phase++)
+	{
+		length += snprintf(overlayText[0] + length, rowSize - length, "  %s %.0f/%.0f", PHASE_NAMES[phase],
+			percentile50[phase] * 1e6f, percentile99[phase] * 1e6f);
+	}
+	overlayLength[0] = length < rowSize ? length : rowSize - 1;
+
+	length = snprintf(overlayText[1], rowSize, "   p50/p99");
+	for (int counter = 0; counter < PROFILE_COUNTER_COUNT && length < rowSize; counter++)
+	{
+		length += snprintf(overlayText[1] + length, rowSize - length, "  %s %.0f/%.0f", COUNTER_NAMES[counter],
+			counterPercentile50[counter] * COUNTER_SCALES[counter], counterPercentile99[counter] * COUNTER_SCALES[counter]);
+	}
+	overlayLength[1] = length < rowSize ? length : rowSize - 1;
+}
+
+void Profiler::TraceLoop()
+{
+	bool first = true;
+	ProfileSample sample;
+	while (true)
+	{
+		// Read the flag before emptying the queue, so anything pushed before Shutdown set it is always written
+		bool finishing = stopping;
+		while (samples->Pop(sample))
+		{
+			WriteSample(sample, first);
+			first = false;
+		}
+		if (finishing)
+		{
+			break;
+		}
+
+		// The queue holds a few seconds of frames, so there is no need to check it any more often than this
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
+void Profiler::WriteSample(const ProfileSample& sample, bool first)
+{
+	double startMicroseconds = sample.start * 1e6;
+	if (sample.isCounter)
+	{
+		double value = (double)sample.duration * COUNTER_SCALES[sample.phase];
+		// A counter event, the trace viewers draw these as a graph under the timings
+		if (traceIsJson)
+		{
+			fprintf(traceFile, "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{\"value\":%.3f}}",
+				first ? "" : ",\n", COUNTER_NAMES[sample.phase], startMicroseconds, value);
+		}
+		else
+		{
+			fprintf(traceFile, "%u,%s,%.3f,,%.3f\n", sample.frame, COUNTER_NAMES[sample.phase], startMicroseconds, value);
+		}
+		return;
+	}
+
+	double durationMicroseconds = (double)sample.duration * 1e6;
+	if (traceIsJson)
+	{
+		// A complete event, the frame number goes in the args so it can be seen when the event is clicked on
+		fprintf(traceFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+			first ? "" : ",\n", PHASE_NAMES[sample.phase], startMicroseconds, durationMicroseconds, sample.frame);
+	}
+	else
+	{
+		fprintf(traceFile, "%u,%s,%.3f,%.3f,\n", sample.frame, PHASE_NAMES[sample.phase], startMicroseconds, durationMicroseconds);
+	}
+}
@@ -0,0 +1,220 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Profiler.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the frame profiler. Each part of a frame is timed with a scope, the times are added up for every frame
+// so the overlay can show the p50 and p99 of each part, and can be sent through a lock free queue to a thread that writes them
+// out as a Chrome trace or a csv file so a stutter can be looked at afterwards. Numbers that arent times of a part of the frame,
+// such as how much was sent to the console, are recorded as counters and shown the same way.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Includes
+#include "SpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+/// <summary>
+/// The parts of a frame that are timed
+/// </summary>
+enum PROFILE_PHASE
+{
+	PROFILE_FRAME,    // The whole of Update and Draw, this doesnt include the time spent waiting for the next frame
+	PROFILE_INPUT,    // Reading the keyboard
+	PROFILE_SIMULATE, // The physics steps and the particles
+	PROFILE_AUDIO,    // Telling the mixer what to play
+	PROFILE_COMPOSE,  // Building the frame from the layers, sprites and particles
+	PROFILE_TEXT,     // The HUD and any other text
+	PROFILE_PRESENT,  // Sending the frame to the console
+	PROFILE_PHASE_COUNT,
+};
+
+/// <summary>
+/// The numbers that are recorded alongside the times, each one has its own history so it can be recorded on some frames and not others
+/// </summary>
+enum PROFILE_COUNTER
+{
+	PROFILE_PRESENT_BYTES, // How many bytes the present sent to the console
+	PROFILE_PRESENT_CELLS, // How many cells the present sent to the console
+	PROFILE_FRAME_JITTER,  // How late the frame started compared to when the scheduler wanted it to, in seconds
+	PROFILE_INPUT_LATENCY, // How long a key press took to get on screen, in seconds, this is only recorded on frames that show one
+	PROFILE_COUNTER_COUNT,
+};
+
+/// <summary>
+/// One timed part of one frame, or one value of a counter, the times are in seconds from when the profiler was made
+/// </summary>
+struct ProfileSample
+{
+	double start;
+	// For a counter this is its value instead
+	float duration;
+	uint32_t frame;
+	// A PROFILE_PHASE, or a PROFILE_COUNTER if isCounter is set
+	uint8_t phase;
+	bool isCounter;
+};
+
+/// <summary>
+/// Times the parts of each frame. Everything is done on the game thread apart from writing the trace, which happens on its
+/// own thread so the file is never written in the middle of a frame.
+/// </summary>
+class Profiler
+{
+public:
+	// How many frames the percentiles are worked out over, and how often they are worked out again
+	static const int HISTORY_FRAMES = 256;
+	static const int STATS_INTERVAL = 15;
+	static const int OVERLAY_ROWS = 2;
+
+	Profiler();
+	~Profiler();
+
+	/// <summary>
+	/// Starts writing every sample to a trace file, it is a Chrome trace (for chrome://tracing or Perfetto) if the name ends in
+	/// .json and a csv file otherwise
+	/// </summary>
+	/// <returns> False if the file couldnt be opened </returns>
+	bool StartTrace(const char* path);
+
+	/// <summary>
+	/// Stops the trace thread and finishes off the file, it is fine to call this more than once
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	/// Marks the start of a frame, everything recorded until EndFrame is added to it
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Records the frame as a whole and adds its parts to the history the percentiles come from
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Records one timed part of the current frame, a part can be recorded more than once in a frame and the times are added together
+	/// </summary>
+	void Record(PROFILE_PHASE phase, double start, double end);
+
+	/// <summary>
+	/// Records a value of a counter, it goes in to that counter's history and the trace
+	/// </summary>
+	void RecordCounter(PROFILE_COUNTER counter, float value);
+
+	/// <summary>
+	/// The time in seconds since the profiler was made
+	/// </summary>
+	double Now() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count(); }
+
+	void SetOverlayVisible(bool visible) { overlayVisible = visible; }
+	void ToggleOverlay() { overlayVisible = !overlayVisible; }
+	bool IsOverlayVisible() const { return overlayVisible; }
+
+	/// <summary>
+	/// The overlay rows, the first has the p50 and p99 of every part in microseconds and the second has the counters. They are
+	/// only rebuilt every STATS_INTERVAL frames.
+	/// </summary>
+	const char* GetOverlayText(int row) const { return overlayText[row]; }
+	int GetOverlayLength(int row) const { return overlayLength[row]; }
+
+	/// <summary>
+	/// The p50 and p99 of a part over the last HISTORY_FRAMES frames in seconds, as of the last time the stats were worked out
+	/// </summary>
+	float GetPercentile50(PROFILE_PHASE phase) const { return percentile50[phase]; }
+	float GetPercentile99(PROFILE_PHASE phase) const { return percentile99[phase]; }
+
+	/// <summary>
+	/// The p50 and p99 of the last HISTORY_FRAMES values of a counter, as of the last time the stats were worked out
+	/// </summary>
+	float GetCounterPercentile50(PROFILE_COUNTER counter) const { return counterPercentile50[counter]; }
+	float GetCounterPercentile99(PROFILE_COUNTER counter) const { return counterPercentile99[counter]; }
+
+	/// <summary>
+	/// How many samples didnt make it in to the trace because the trace thread had fallen behind
+	/// </summary>
+	long long GetDroppedSamples() const { return droppedSamples; }
+
+private:
+	// The queue holds a few seconds of samples, the trace thread empties it far more often than that
+	typedef SpscQueue<ProfileSample, 8192> SampleQueue;
+
+	void UpdateStats();
+	void PushSample(const ProfileSample& sample);
+	void TraceLoop();
+	void WriteSample(const ProfileSample& sample, bool first);
+
+	std::chrono::steady_clock::time_point epoch;
+	uint32_t frameNumber = 0;
+	double frameStart = 0.0;
+
+	// What each part added up to this frame, and the last HISTORY_FRAMES frames of them
+	float frameTotals[PROFILE_PHASE_COUNT] = {};
+	float history[PROFILE_PHASE_COUNT][HISTORY_FRAMES] = {};
+	int historyCount = 0;
+	int historyNext = 0;
+	float percentile50[PROFILE_PHASE_COUNT] = {};
+	float percentile99[PROFILE_PHASE_COUNT] = {};
+
+	// The last HISTORY_FRAMES values of each counter, these only move on when the counter is recorded
+	float counterHistory[PROFILE_COUNTER_COUNT][HISTORY_FRAMES] = {};
+	int counterHistoryCount[PROFILE_COUNTER_COUNT] = {};
+	int counterHistoryNext[PROFILE_COUNTER_COUNT] = {};
+	float counterPercentile50[PROFILE_COUNTER_COUNT] = {};
+	float counterPercentile99[PROFILE_COUNTER_COUNT] = {};
+
+	bool overlayVisible = false;
+	char overlayText[OVERLAY_ROWS][256] = {};
+	int overlayLength[OVERLAY_ROWS] = {};
+
+	// The trace, the queue is only made when a trace is started so that it costs nothing otherwise
+	std::unique_ptr<SampleQueue> samples;
+	long long droppedSamples = 0;
+	FILE* traceFile = nullptr;
+	bool traceIsJson = false;
+	std::atomic<bool> stopping{ false };
+	std::thread traceWriter;
+};
+
+/// <summary>
+/// Times everything from where it is made to the end of the scope, or to End if that is called first
+/// </summary>
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler& scopeProfiler, PROFILE_PHASE scopePhase)
+		: profiler(scopeProfiler), phase(scopePhase), start(scopeProfiler.Now())
+	{
+	}
+
+	~ProfileScope()
+	{
+		End();
+	}
+
+	/// <summary>
+	/// Stops timing early, nothing else is recorded when the scope ends
+	/// </summary>
+	void End()
+	{
+		if (!ended)
+		{
+			profiler.Record(phase, start, profiler.Now());
+			ended = true;
+		}
+	}
+
+private:
+	Profiler& profiler;
+	PROFILE_PHASE phase;
+	double start;
+	bool ended = false;
+};
+
+#endif // !PROFILER_H
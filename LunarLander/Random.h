@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Random.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the random number generator, it is a PCG32 so it is small and fast, and every instance is its own
+// sequence so different parts of the game can each have one without affecting each other
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+// Includes
+#include <stdint.h>
+
+/// <summary>
+/// The parts of the game that have their own random numbers, a new stream can be added without changing any of the others
+/// </summary>
+enum RANDOM_STREAM
+{
+	RANDOM_STREAM_FUEL,
+	RANDOM_STREAM_EFFECTS,
+	RANDOM_STREAM_COUNT,
+};
+
+/// <summary>
+/// A PCG32 random number generator (https://www.pcg-random.org), the same seed and stream always give the same numbers
+/// </summary>
+class Random
+{
+public:
+	/// <summary>
+	/// Starts the generator from a seed
+	/// </summary>
+	/// <param name="seed"> Where in the sequence to start </param>
+	/// <param name="stream"> Which sequence to use, generators with the same seed but different streams dont overlap </param>
+	void Seed(uint64_t seed, uint64_t stream)
+	{
+		state = 0;
+		increment = (stream << 1) | 1;
+		Next();
+		state += seed;
+		Next();
+	}
+
+	/// <summary>
+	/// Gets the next random number
+	/// </summary>
+	/// <returns> A number between 0 and 2^32 - 1 </returns>
+	uint32_t Next()
+	{
+		uint64_t oldState = state;
+		state = oldState * 6364136223846793005ULL + increment;
+		uint32_t xorShifted = (uint32_t)(((oldState >> 18) ^ oldState) >> 27);
+		uint32_t rotation = (uint32_t)(oldState >> 59);
+		return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+	}
+
+	/// <summary>
+	/// Gets a random whole number below a limit, every number is equally likely
+	/// </summary>
+	/// <param name="limit"> One more than the biggest number that can come back </param>
+	/// <returns> A number between 0 and limit - 1 </returns>
+	int NextInt(int limit)
+	{
+		if (limit <= 1)
+		{
+			return 0;
+		}
+		// Throw away the few numbers at the bottom that would make some results more likely than others
+		uint32_t bound = (uint32_t)limit;
+		uint32_t threshold = (0u - bound) % bound;
+		uint32_t value;
+		do
+		{
+			value = Next();
+		} while (value < threshold);
+		return (int)(value % bound);
+	}
+
+	uint64_t GetState() const { return state; }
+
+private:
+	uint64_t state = 0x853c49e6748fea9bULL;
+	uint64_t increment = 0xda3e39cb94b95bdbULL;
+};
+
+#endif // !RANDOM_H
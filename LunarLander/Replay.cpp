@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Replay.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for reading and writing replay logs. Everything is written little endian a byte at
+// a time so the files work on any computer.
+//
+// Layout: "LLRP", version (4 bytes), seed (8 bytes), frame count (4 bytes), final hash (8 bytes), flags (4 bytes),
+// level hash (8 bytes), then for each frame: key mask (2 bytes), delta time as the raw bits of the float (4 bytes)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Replay.h"
+// Includes
+#include <stdlib.h>
+#include <string.h>
+
+// Constants
+static const char REPLAY_MAGIC[4] = { 'L', 'L', 'R', 'P' };
+static const uint32_t REPLAY_VERSION = 2;
+static const int REPLAY_HEADER_SIZE = 40;
+static const int REPLAY_FRAME_SIZE = 6;
+
+static void PutLittleEndian(unsigned char* output, uint64_t value, int byteCount)
+{
+	for (int i = 0; i < byteCount; i++)
+	{
+		output[i] = (unsigned char)(value >> (8 * i));
+	}
+}
+
+static uint64_t GetLittleEndian(const unsigned char* input, int byteCount)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < byteCount; i++)
+	{
+		value |= (uint64_t)input[i] << (8 * i);
+	}
+	return value;
+}
+
+ReplayWriter::~ReplayWriter()
+{
+	if (file)
+	{
+		Close(0);
+	}
+}
+
+bool ReplayWriter::Open(const char* path, uint64_t replaySeed, uint32_t replayFlags, uint64_t replayLevelHash)
+{
+	seed = replaySeed;
+	flags = replayFlags;
+	levelHash = replayLevelHash;
+	frameCount = 0;
+	file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	WriteHeader(0);
+	return true;
+}
+
+void ReplayWriter::AddFrame(uint16_t keyMask, float deltaTime)
+{
+	if (!file)
+	{
+		return;
+	}
+
+	// The float is stored as its exact bits, rounding it at all would make the replay drift
+	uint32_t deltaBits;
+	memcpy(&deltaBits, &deltaTime, sizeof(deltaBits));
+
+	unsigned char frame[REPLAY_FRAME_SIZE];
+	PutLittleEndian(frame, keyMask, 2);
+	PutLittleEndian(frame + 2, deltaBits, 4);
+	fwrite(frame, 1, sizeof(frame), file);
+	frameCount++;
+}
+
+void ReplayWriter::Close(uint64_t finalHash)
+{
+	if (!file)
+	{
+		return;
+	}
+	fseek(file, 0, SEEK_SET);
+	WriteHeader(finalHash);
+	fclose(file);
+	file = nullptr;
+}
+
+void ReplayWriter::WriteHeader(uint64_t finalHash)
+{
+	unsigned char header[REPLAY_HEADER_SIZE];
+	memcpy(header, REPLAY_MAGIC, 4);
+	PutLittleEndian(header + 4, REPLAY_VERSION, 4);
+	PutLittleEndian(header + 8, seed, 8);
+	PutLittleEndian(header + 16, frameCount, 4);
+	PutLittleEndian(header + 20, finalHash, 8);
+	PutLittleEndian(header + 28, flags, 4);
+	PutLittleEndian(header + 32, levelHash, 8);
+	fwrite(header, 1, sizeof(header), file);
+}
+
+ReplayReader::~ReplayReader()
+{
+	free(frames);
+}
+
+bool ReplayReader::Open(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	unsigned char header[REPLAY_HEADER_SIZE];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, REPLAY_MAGIC, 4) != 0 ||
+		GetLittleEndian(header + 4, 4) != REPLAY_VERSION)
+	{
+		fclose(file);
+		return false;
+	}
+	seed = GetLittleEndian(header + 8, 8);
+	frameCount = (uint32_t)GetLittleEndian(header + 16, 4);
+	finalHash = GetLittleEndian(header + 20, 8);
+	flags = (uint32_t)GetLittleEndian(header + 28, 4);
+	levelHash = GetLittleEndian(header + 32, 8);
+
+	// Read all of the frames in one go so that playing them back never touches the disk
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, REPLAY_HEADER_SIZE, SEEK_SET);
+	size_t frameBytes = fileSize > REPLAY_HEADER_SIZE ? (size_t)(fileSize - REPLAY_HEADER_SIZE) : 0;
+	free(frames);
+	frames = (unsigned char*)malloc(frameBytes + 1);
+	size_t bytesRead = frames ? fread(frames, 1, frameBytes, file) : 0;
+	fclose(file);
+
+	// A log that was never closed (the game was killed while recording) has no frame count, so it plays back as far as it goes
+	uint32_t framesInFile = (uint32_t)(bytesRead / REPLAY_FRAME_SIZE);
+	if (frameCount == 0 || frameCount > framesInFile)
+	{
+		frameCount = framesInFile;
+	}
+	nextFrame = 0;
+	return frames != nullptr;
+}
+
+bool ReplayReader::ReadFrame(uint16_t& keyMask, float& deltaTime)
+{
+	if (nextFrame >= frameCount)
+	{
+		return false;
+	}
+	const unsigned char* frame = frames + (size_t)nextFrame * REPLAY_FRAME_SIZE;
+	keyMask = (uint16_t)GetLittleEndian(frame, 2);
+	uint32_t deltaBits = (uint32_t)GetLittleEndian(frame + 2, 4);
+	memcpy(&deltaTime, &deltaBits, sizeof(deltaTime));
+	nextFrame++;
+	return true;
+}
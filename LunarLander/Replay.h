@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Replay.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the replay log, a recording is the random seed and how the game was started followed by the keys and delta
+// time of every update. Feeding it back through the game gives exactly the same session, which is checked with a hash of the game
+// state at the end
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Includes
+#include <stdint.h>
+#include <stdio.h>
+
+/// <summary>
+/// Builds up a 64 bit FNV-1a hash of some values, used to check that a replay ended up in the same state as the recording
+/// </summary>
+class StateHash
+{
+public:
+	void Add(const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+		}
+	}
+
+	template <typename T>
+	void Add(const T& value)
+	{
+		Add(&value, sizeof(value));
+	}
+
+	uint64_t Get() const { return hash; }
+
+private:
+	uint64_t hash = 0xcbf29ce484222325ULL;
+};
+
+/// <summary>
+/// How the game was started when it was recorded, these are or'ed together in to the header
+/// </summary>
+enum REPLAY_FLAGS
+{
+	REPLAY_FLAG_PLANET = 1, // Flying over a planet instead of a level
+};
+
+/// <summary>
+/// Writes a replay log, the header is filled in when the log is closed as the frame count and final hash arent known until then
+/// </summary>
+class ReplayWriter
+{
+public:
+	~ReplayWriter();
+
+	/// <summary>
+	/// Creates the log file
+	/// </summary>
+	/// <param name="path"> The file to write </param>
+	/// <param name="seed"> The seed the game was started with </param>
+	/// <param name="flags"> The REPLAY_FLAGS the game was started with </param>
+	/// <param name="levelHash"> The level being played, from Game::GetLevelHash </param>
+	/// <returns> False if the file couldnt be created </returns>
+	bool Open(const char* path, uint64_t seed, uint32_t flags, uint64_t levelHash);
+
+	/// <summary>
+	/// Adds one update to the log, this is 6 bytes
+	/// </summary>
+	/// <param name="keyMask"> The keys that were down, from Game::GetInputMask </param>
+	/// <param name="deltaTime"> The delta time that was passed to Update </param>
+	void AddFrame(uint16_t keyMask, float deltaTime);
+
+	/// <summary>
+	/// Finishes the log
+	/// </summary>
+	/// <param name="finalHash"> The state hash after the last update, a replay checks that it gets the same </param>
+	void Close(uint64_t finalHash);
+
+	bool IsOpen() const { return file != nullptr; }
+
+private:
+	void WriteHeader(uint64_t finalHash);
+
+	FILE* file = nullptr;
+	uint64_t seed = 0;
+	uint32_t flags = 0;
+	uint64_t levelHash = 0;
+	uint32_t frameCount = 0;
+};
+
+/// <summary>
+/// Reads a replay log back in, the whole file is read when it is opened
+/// </summary>
+class ReplayReader
+{
+public:
+	~ReplayReader();
+
+	/// <summary>
+	/// Reads the log
+	/// </summary>
+	/// <param name="path"> The file to read </param>
+	/// <returns> False if the file couldnt be read or isnt a replay log this version of the game can play </returns>
+	bool Open(const char* path);
+
+	/// <summary>
+	/// Gets the next update from the log
+	/// </summary>
+	/// <returns> False once every frame has been read </returns>
+	bool ReadFrame(uint16_t& keyMask, float& deltaTime);
+
+	uint64_t GetSeed() const { return seed; }
+	uint32_t GetFlags() const { return flags; }
+	uint64_t GetLevelHash() const { return levelHash; }
+	uint32_t GetFrameCount() const { return frameCount; }
+	uint64_t GetFinalHash() const { return finalHash; }
+
+private:
+	unsigned char* frames = nullptr;
+	uint64_t seed = 0;
+	uint32_t flags = 0;
+	uint64_t levelHash = 0;
+	uint32_t frameCount = 0;
+	uint32_t nextFrame = 0;
+	uint64_t finalHash = 0;
+};
+
+#endif // !REPLAY_H
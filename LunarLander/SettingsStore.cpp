@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: SettingsStore.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the settings store
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "SettingsStore.h"
+// Includes
+#include <fstream>
+#include <string>
+
+SettingsStore::~SettingsStore()
+{
+	Shutdown();
+}
+
+void SettingsStore::Initialise(Platform* storePlatform, bool useFiles)
+{
+	platform = storePlatform;
+	persistent = useFiles;
+	if (!persistent)
+	{
+		return;
+	}
+
+	// This is the only time the files are read, from now on the values in memory are the real ones
+	highScore = ReadValue(HIGH_SCORE_FILE, 0);
+	soundOn = ReadValue(SOUND_STATE_FILE, 1) == 1;
+
+	stopping = false;
+	writer = std::thread(&SettingsStore::WriterLoop, this);
+}
+
+void SettingsStore::Shutdown()
+{
+	if (!writer.joinable())
+	{
+		return;
+	}
+
+	// The writer finishes off anything that is still queued before it stops
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	writeQueued.notify_one();
+	writer.join();
+}
+
+void SettingsStore::Flush()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	writeFinished.wait(lock, [this] { return pendingWrites == 0 && !writing; });
+}
+
+bool SettingsStore::SubmitScore(int score)
+{
+	if (score <= highScore)
+	{
+		return false;
+	}
+	highScore = score;
+	QueueWrite(PENDING_HIGH_SCORE);
+	return true;
+}
+
+void SettingsStore::SetSoundOn(bool on)
+{
+	if (on == soundOn)
+	{
+		return;
+	}
+	soundOn = on;
+	QueueWrite(PENDING_SOUND_STATE);
+}
+
+/// <summary>
+/// Hands the current value of a setting to the writer thread, if it is already waiting to be written then only the newest value is written
+/// </summary>
+void SettingsStore::QueueWrite(unsigned int setting)
+{
+	if (!persistent)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingWrites |= setting;
+		pendingHighScore = highScore;
+		pendingSoundState = soundOn ? 1 : 0;
+	}
+	writeQueued.notify_one();
+}
+
+/// <summary>
+/// This runs on the writer thread, it sleeps until something is queued and then writes it out without holding the lock
+/// </summary>
+void SettingsStore::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		writeQueued.wait(lock, [this] { return pendingWrites != 0 || stopping; });
+		if (pendingWrites == 0)
+		{
+			// Only stopping is left, everything has been written
+			break;
+		}
+
+		// Take a copy of what needs writing so the game can carry on changing settings while the files are written
+		unsigned int writes = pendingWrites;
+		int scoreToWrite = pendingHighScore;
+		int soundStateToWrite = pendingSoundState;
+		pendingWrites = 0;
+		writing = true;
+		lock.unlock();
+
+		if (writes & PENDING_HIGH_SCORE)
+		{
+			WriteValue(HIGH_SCORE_FILE, scoreToWrite);
+		}
+		if (writes & PENDING_SOUND_STATE)
+		{
+			WriteValue(SOUND_STATE_FILE, soundStateToWrite);
+		}
+
+		lock.lock();
+		writing = false;
+		writeFinished.notify_all();
+	}
+	writing = false;
+	writeFinished.notify_all();
+}
+
+/// <summary>
+/// Writes a value to a temporary file next to the real one and then moves it over the top of the real one
+/// </summary>
+/// <param name="path"> The file to write </param>
+/// <param name="value"> The value to store in it </param>
+/// <returns> True if the file was replaced </returns>
+bool SettingsStore::WriteValue(const char* path, int value)
+{
+	std::string temporaryPath = std::string(path) + ".tmp";
+
+	std::ofstream file(temporaryPath, std::ios::out | std::ios::trunc);
+	file << value;
+	file.close();
+	if (file.fail())
+	{
+		return false;
+	}
+	return platform->ReplaceFileAtomic(temporaryPath.c_str(), path);
+}
+
+/// <summary>
+/// Reads a single number from a file
+/// </summary>
+/// <param name="path"> The file to read </param>
+/// <param name="defaultValue"> What to use if the file doesnt exist or doesnt start with a number </param>
+/// <returns> The number in the file </returns>
+int SettingsStore::ReadValue(const char* path, int defaultValue)
+{
+	int value = defaultValue;
+	std::ifstream file(path, std::ios::in);
+	if (!(file >> value))
+	{
+		value = defaultValue;
+	}
+	return value;
+}
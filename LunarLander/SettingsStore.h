@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: SettingsStore.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the settings store, it loads the high score and sound setting once at startup and keeps them in memory.
+// Changes are written out on a background thread to a temporary file which is then moved over the real one, so the game
+// never waits on the file system and a crash part way through a write cant leave a broken file behind
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+// Includes
+#include "Platform.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// The files that the settings are kept in, these are in the working directory
+#define HIGH_SCORE_FILE "HighScore.txt"
+#define SOUND_STATE_FILE "SoundState.txt"
+
+/// <summary>
+/// This class holds the settings that are kept between runs of the game
+/// </summary>
+class SettingsStore
+{
+public:
+	~SettingsStore();
+
+	/// <summary>
+	/// Reads the settings files and starts the thread that writes changes back out
+	/// </summary>
+	/// <param name="storePlatform"> The platform used to replace the files, it has to outlive the store or Shutdown has to be called first </param>
+	/// <param name="useFiles"> If false the files are never read or written and the settings only live in memory, this is used by replays </param>
+	void Initialise(Platform* storePlatform, bool useFiles = true);
+
+	/// <summary>
+	/// Writes out anything that hasnt been saved yet and stops the writer thread, it is fine to call this more than once
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	/// Waits until every change made so far has been written to disk
+	/// </summary>
+	void Flush();
+
+	int GetHighScore() const { return highScore; }
+	bool IsSoundOn() const { return soundOn; }
+
+	/// <summary>
+	/// Checks a score against the high score and saves it if it is higher
+	/// </summary>
+	/// <param name="score"> The score the player finished with </param>
+	/// <returns> True if it was a new high score </returns>
+	bool SubmitScore(int score);
+
+	/// <summary>
+	/// Turns the sound on or off, nothing is written if it is already set that way
+	/// </summary>
+	void SetSoundOn(bool on);
+
+private:
+	// Bits for which settings have changed and are waiting to be written
+	enum PENDING_WRITE
+	{
+		PENDING_HIGH_SCORE = 1 << 0,
+		PENDING_SOUND_STATE = 1 << 1,
+	};
+
+	void QueueWrite(unsigned int setting);
+	void WriterLoop();
+	bool WriteValue(const char* path, int value);
+	static int ReadValue(const char* path, int defaultValue);
+
+	Platform* platform = nullptr;
+	bool persistent = true;
+
+	// These are only touched by the game thread, so reading them doesnt need the lock
+	int highScore = 0;
+	bool soundOn = true;
+
+	// Everything below is shared with the writer thread and is protected by the mutex
+	std::mutex mutex;
+	// Wakes the writer thread when there is something to write or it needs to stop
+	std::condition_variable writeQueued;
+	// Wakes anything waiting in Flush when the writer has caught up
+	std::condition_variable writeFinished;
+	unsigned int pendingWrites = 0;
+	int pendingHighScore = 0;
+	int pendingSoundState = 1;
+	bool writing = false;
+	bool stopping = false;
+	std::thread writer;
+};
+
+#endif // !SETTINGS_STORE_H
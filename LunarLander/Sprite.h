@@ -0,0 +1,243 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Sprite.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the sprite type, sprites are built at compile time straight in to cells so that drawing them
+// is just copying whole rows in to the buffer
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPRITE_H
+#define SPRITE_H
+
+// Includes
+#include "Platform.h"
+#include "Utility.h"
+#include <string.h>
+#include <utility>
+
+// The character that is treated as see-through when a sprite is drawn with transparency
+const char TRANSPARENT_CHAR = ' ';
+
+/// <summary>
+/// An ascii sprite with its colours, it is built at compile time so the same cells are shared by everything that draws it
+/// </summary>
+/// <typeparam name="SPRITE_WIDTH"> Width of the sprite in characters </typeparam>
+/// <typeparam name="SPRITE_HEIGHT"> Height of the sprite in characters </typeparam>
+template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+struct Sprite
+{
+	static_assert(SPRITE_WIDTH > 0 && SPRITE_HEIGHT > 0, "A sprite needs at least one cell");
+	static_assert(SPRITE_WIDTH <= 32, "The transparency mask only has room for 32 columns");
+
+	static const int WIDTH = SPRITE_WIDTH;
+	static const int HEIGHT = SPRITE_HEIGHT;
+	static const int CELL_COUNT = SPRITE_WIDTH * SPRITE_HEIGHT;
+
+	/// <summary>
+	/// Builds the sprite from its ascii art and colours, if the art isnt exactly width * height characters then it wont compile
+	/// </summary>
+	/// <param name="charsToPrint"> The ascii art, rows are joined together with no separator </param>
+	/// <param name="coloursToPrint"> The colour of each character </param>
+	template <int LENGTH>
+	constexpr Sprite(const char (&charsToPrint)[LENGTH], const uint8_t (&coloursToPrint)[CELL_COUNT])
+		: Sprite(charsToPrint, coloursToPrint, std::make_integer_sequence<int, CELL_COUNT>(), std::make_integer_sequence<int, SPRITE_HEIGHT>())
+	{
+		static_assert(LENGTH == CELL_COUNT + 1, "The sprite's ascii art doesnt match its width and height");
+	}
+
+	// The cells of the sprite, ready to be copied straight in to the buffer
+	Cell cells[CELL_COUNT];
+	// One bit per column for each row, a bit is set if that cell isnt see-through
+	unsigned int opaqueMask[SPRITE_HEIGHT];
+
+private:
+	template <int... CELL, int... ROW>
+	constexpr Sprite(const char* charsToPrint, const uint8_t* coloursToPrint, std::integer_sequence<int, CELL...>, std::integer_sequence<int, ROW...>)
+		: cells{ MakeCell(charsToPrint[CELL], coloursToPrint[CELL])... }
+		, opaqueMask{ MakeRowMask(charsToPrint + ROW * SPRITE_WIDTH)... }
+	{
+	}
+
+	static constexpr Cell MakeCell(char character, uint8_t colour)
+	{
+		return Cell{ character, colour };
+	}
+
+	static constexpr unsigned int MakeRowMask(const char* row)
+	{
+		unsigned int mask = 0;
+		for (int x = 0; x < SPRITE_WIDTH; x++)
+		{
+			if (row[x] != TRANSPARENT_CHAR)
+			{
+				mask |= 1u << x;
+			}
+		}
+		return mask;
+	}
+};
+
+/// <summary>
+/// A sprite of any size, this lets sprites be kept in a table and referred to by a handle instead of by their type
+/// </summary>
+struct SpriteView
+{
+	const Cell* cells = nullptr;
+	const unsigned int* opaqueMask = nullptr;
+	int width = 0;
+	int height = 0;
+};
+
+/// <summary>
+/// Gets a view of a sprite, the sprite has to outlive the view which is always true for the constexpr sprites in GameObjects.h
+/// </summary>
+template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+static SpriteView MakeSpriteView(const Sprite<SPRITE_WIDTH, SPRITE_HEIGHT>& sprite)
+{
+	SpriteView view;
+	view.cells = sprite.cells;
+	view.opaqueMask = sprite.opaqueMask;
+	view.width = SPRITE_WIDTH;
+	view.height = SPRITE_HEIGHT;
+	return view;
+}
+
+/// <summary>
+/// Copies the rows of a sprite that is completely on screen in to the buffer, the general version loops over the rows
+/// and the sizes used by the game below are written out in full
+/// </summary>
+template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+struct SpriteBlitter
+{
+	static void Blit(Cell* destination, int bufferWidth, const Cell* cells)
+	{
+		for (int y = 0; y < SPRITE_HEIGHT; y++)
+		{
+			memcpy(destination + bufferWidth * y, cells + SPRITE_WIDTH * y, SPRITE_WIDTH * sizeof(Cell));
+		}
+	}
+};
+
+/// <summary>
+/// The 4x3 lander
+/// </summary>
+template <>
+struct SpriteBlitter<4, 3>
+{
+	static void Blit(Cell* destination, int bufferWidth, const Cell* cells)
+	{
+		memcpy(destination, cells, 4 * sizeof(Cell));
+		memcpy(destination + bufferWidth, cells + 4, 4 * sizeof(Cell));
+		memcpy(destination + bufferWidth * 2, cells + 8, 4 * sizeof(Cell));
+	}
+};
+
+/// <summary>
+/// The 7x5 explosion
+/// </summary>
+template <>
+struct SpriteBlitter<7, 5>
+{
+	static void Blit(Cell* destination, int bufferWidth, const Cell* cells)
+	{
+		memcpy(destination, cells, 7 * sizeof(Cell));
+		memcpy(destination + bufferWidth, cells + 7, 7 * sizeof(Cell));
+		memcpy(destination + bufferWidth * 2, cells + 14, 7 * sizeof(Cell));
+		memcpy(destination + bufferWidth * 3, cells + 21, 7 * sizeof(Cell));
+		memcpy(destination + bufferWidth * 4, cells + 28, 7 * sizeof(Cell));
+	}
+};
+
+/// <summary>
+/// Draws a sprite in to the buffer, the whole sprite is copied including any spaces in it. If part of the sprite is off the
+/// edge of the buffer then only the part that is on screen is drawn.
+/// </summary>
+/// <param name="consoleBuffer"> The buffer for the program </param>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+/// <param name="sprite"> The sprite to draw </param>
+/// <param name="spriteXPos"> Position on the x axis at which the sprite will be displayed </param>
+/// <param name="spriteYPos"> Position on the y axis at which the sprite will be displayed </param>
+template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+static void WriteSpriteToBuffer(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const Sprite<SPRITE_WIDTH, SPRITE_HEIGHT>& sprite, int spriteXPos, int spriteYPos)
+{
+	// The common case is that the sprite is all on screen, then the rows can be copied with no checks at all
+	if (spriteXPos >= 0 && spriteYPos >= 0 && spriteXPos + SPRITE_WIDTH <= bufferWidth && spriteYPos + SPRITE_HEIGHT <= bufferHeight)
+	{
+		SpriteBlitter<SPRITE_WIDTH, SPRITE_HEIGHT>::Blit(consoleBuffer + spriteXPos + bufferWidth * spriteYPos, bufferWidth, sprite.cells);
+		return;
+	}
+
+	// Work out which part of the sprite is on screen
+	ClipRect clip;
+	if (!ClipToBuffer(bufferWidth, bufferHeight, SPRITE_WIDTH, SPRITE_HEIGHT, spriteXPos, spriteYPos, clip))
+	{
+		return;
+	}
+
+	for (int y = clip.firstRow; y < clip.lastRow; y++)
+	{
+		memcpy(consoleBuffer + (spriteXPos + clip.firstColumn) + bufferWidth * (spriteYPos + y), sprite.cells + clip.firstColumn + SPRITE_WIDTH * y,
+			(clip.lastColumn - clip.firstColumn) * sizeof(Cell));
+	}
+}
+
+/// <summary>
+/// Draws a sprite in to the buffer, leaving whatever was already there behind the spaces in the sprite. If part of the sprite is off the
+/// edge of the buffer then only the part that is on screen is drawn.
+/// </summary>
+/// <param name="consoleBuffer"> The buffer for the program </param>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+/// <param name="sprite"> The sprite to draw </param>
+/// <param name="spriteXPos"> Position on the x axis at which the sprite will be displayed </param>
+/// <param name="spriteYPos"> Position on the y axis at which the sprite will be displayed </param>
+template <int SPRITE_WIDTH, int SPRITE_HEIGHT>
+static void WriteSpriteToBufferMasked(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const Sprite<SPRITE_WIDTH, SPRITE_HEIGHT>& sprite, int spriteXPos, int spriteYPos)
+{
+	// Work out which part of the sprite is on screen
+	ClipRect clip;
+	if (!ClipToBuffer(bufferWidth, bufferHeight, SPRITE_WIDTH, SPRITE_HEIGHT, spriteXPos, spriteYPos, clip))
+	{
+		return;
+	}
+
+	for (int y = clip.firstRow; y < clip.lastRow; y++)
+	{
+		// Rows that are completely see-through are skipped without looking at any cells
+		if (sprite.opaqueMask[y] == 0)
+		{
+			continue;
+		}
+		BlitCellsKeyed(consoleBuffer + (spriteXPos + clip.firstColumn) + bufferWidth * (spriteYPos + y), sprite.cells + clip.firstColumn + SPRITE_WIDTH * y,
+			clip.lastColumn - clip.firstColumn, TRANSPARENT_CHAR);
+	}
+}
+
+/// <summary>
+/// Draws a sprite view in to the buffer, the whole sprite is copied including any spaces in it. If part of the sprite is off the
+/// edge of the buffer then only the part that is on screen is drawn.
+/// </summary>
+/// <param name="consoleBuffer"> The buffer for the program </param>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+/// <param name="sprite"> The sprite to draw </param>
+/// <param name="spriteXPos"> Position on the x axis at which the sprite will be displayed </param>
+/// <param name="spriteYPos"> Position on the y axis at which the sprite will be displayed </param>
+static void WriteSpriteViewToBuffer(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const SpriteView& sprite, int spriteXPos, int spriteYPos)
+{
+	// Work out which part of the sprite is on screen
+	ClipRect clip;
+	if (!ClipToBuffer(bufferWidth, bufferHeight, sprite.width, sprite.height, spriteXPos, spriteYPos, clip))
+	{
+		return;
+	}
+
+	for (int y = clip.firstRow; y < clip.lastRow; y++)
+	{
+		memcpy(consoleBuffer + (spriteXPos + clip.firstColumn) + bufferWidth * (spriteYPos + y), sprite.cells + clip.firstColumn + sprite.width * y,
+			(clip.lastColumn - clip.firstColumn) * sizeof(Cell));
+	}
+}
+
+#endif // !SPRITE_H
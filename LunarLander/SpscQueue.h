@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: SpscQueue.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains a fixed size queue for passing things from one thread to another without a lock, it only works
+// when exactly one thread pushes and exactly one other thread pops
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+// Includes
+#include <atomic>
+
+/// <summary>
+/// A single producer, single consumer ring buffer. Neither side ever waits, a push onto a full queue just fails.
+/// </summary>
+/// <typeparam name="T"> The type of item in the queue </typeparam>
+/// <typeparam name="CAPACITY"> How many slots there are, this has to be a power of two </typeparam>
+template <typename T, unsigned int CAPACITY>
+class SpscQueue
+{
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "The capacity has to be a power of two");
+
+public:
+	/// <summary>
+	/// Adds an item to the back of the queue, this must only be called from the producer thread
+	/// </summary>
+	/// <returns> False if the queue was full and the item wasnt added </returns>
+	bool Push(const T& item)
+	{
+		unsigned int tail = writeIndex.load(std::memory_order_relaxed);
+		if (tail - readIndex.load(std::memory_order_acquire) == CAPACITY)
+		{
+			return false;
+		}
+		items[tail & (CAPACITY - 1)] = item;
+		// Release makes sure the item is written before the consumer can see the new index
+		writeIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// <summary>
+	/// Takes the item at the front of the queue, this must only be called from the consumer thread
+	/// </summary>
+	/// <returns> False if the queue was empty </returns>
+	bool Pop(T& item)
+	{
+		unsigned int head = readIndex.load(std::memory_order_relaxed);
+		if (head == writeIndex.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = items[head & (CAPACITY - 1)];
+		readIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T items[CAPACITY];
+	// These only ever count up, the slot is the index masked by the capacity so they can wrap around safely.
+	// They are kept on separate cache lines so the two threads arent fighting over the same one
+	alignas(64) std::atomic<unsigned int> writeIndex{ 0 };
+	alignas(64) std::atomic<unsigned int> readIndex{ 0 };
+};
+
+#endif // !SPSC_QUEUE_H
@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: TerrainIndex.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for building the terrain index
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "TerrainIndex.h"
+
+// Includes
+#include <algorithm>
+#include <assert.h>
+
+// The most the distance field holds, anything further away is stored as this
+const int MAX_DISTANCE = 255;
+
+void TerrainIndex::Build(const Level& level)
+{
+	width = level.GetWidth();
+	height = level.GetHeight();
+	const int cellCount = width * height;
+	mask.assign(level.GetMask(), level.GetMask() + cellCount);
+
+	// Go up each column from the bottom, so every cell already knows where the ground is under the cell below it
+	groundRow.assign(cellCount, (uint16_t)height);
+	surfaceHeight.assign(width, (int16_t)height);
+	for (int column = 0; column < width; column++)
+	{
+		int ground = height;
+		for (int row = height - 1; row >= 0; row--)
+		{
+			if (mask[column + width * row] != TERRAIN_EMPTY)
+			{
+				ground = row;
+			}
+			groundRow[column + width * row] = (uint16_t)ground;
+		}
+		surfaceHeight[column] = (int16_t)ground;
+	}
+
+	// The distance to the nearest cell that isnt empty, worked out in two passes. The first carries distances down and to the
+	// right from the cells already done above and to the left, and the second carries them back up and to the left.
+	distanceField.assign(cellCount, (uint8_t)MAX_DISTANCE);
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (mask[i] != TERRAIN_EMPTY)
+		{
+			distanceField[i] = 0;
+		}
+	}
+	auto carry = [&](int cell, int column, int row)
+	{
+		if (column >= 0 && column < width && row >= 0 && row < height)
+		{
+			int distance = distanceField[column + width * row] + 1;
+			distanceField[cell] = (uint8_t)(distance < distanceField[cell] ? distance : distanceField[cell]);
+		}
+	};
+	for (int row = 0; row < height; row++)
+	{
+		for (int column = 0; column < width; column++)
+		{
+			int cell = column + width * row;
+			carry(cell, column - 1, row);
+			carry(cell, column - 1, row - 1);
+			carry(cell, column, row - 1);
+			carry(cell, column + 1, row - 1);
+		}
+	}
+	for (int row = height - 1; row >= 0; row--)
+	{
+		for (int column = width - 1; column >= 0; column--)
+		{
+			int cell = column + width * row;
+			carry(cell, column + 1, row);
+			carry(cell, column + 1, row + 1);
+			carry(cell, column, row + 1);
+			carry(cell, column - 1, row + 1);
+		}
+	}
+
+	// Sorted so that anything looking for the nearest platform can stop as soon as it has gone past it
+	platforms.assign(level.GetPlatforms(), level.GetPlatforms() + level.GetPlatformCount());
+	std::sort(platforms.begin(), platforms.end(), [](const LevelPlatform& a, const LevelPlatform& b)
+	{
+		return a.x != b.x ? a.x < b.x : a.y < b.y;
+	});
+
+	// Every cell a left leg can stand on points at its platform, the right leg is the cell after so the last cell of a
+	// platform isnt one of them
+	platformAt.assign(cellCount, 0);
+	for (size_t i = 0; i < platforms.size(); i++)
+	{
+		const LevelPlatform& platform = platforms[i];
+		// Level::Attach turns away files with platforms like this, so this is only for levels made some other way
+		assert(platform.x >= 0 && platform.width >= 2 && platform.x + platform.width <= width && platform.y >= 0 && platform.y < height);
+		for (int column = platform.x; column < platform.x + platform.width - 1; column++)
+		{
+			platformAt[column + width * platform.y] = (uint16_t)(i + 1);
+		}
+	}
+}
+
+TerrainContact TerrainIndex::SweepAcrossCells(float fromX, float fromY, float toX, float toY, float velocityY) const
+{
+	TerrainContact contact = SweepCells(fromX, fromY, toX, toY, width - Player::WIDTH,
+		[this, velocityY](int cellX, int cellY) { return CheckLanding(cellX, cellY, velocityY); },
+		[this](int cellX, int cellY)
+		{
+			int leg = LegCell(cellX, cellY);
+			return distanceField[leg] < distanceField[leg + 1] ? (int)distanceField[leg] : (int)distanceField[leg + 1];
+		});
+	if (contact.result != LANDING_NONE)
+	{
+		contact.surface = GetSurface((int)contact.xPos, (int)contact.yPos);
+	}
+	return contact;
+}
@@ -0,0 +1,316 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: TerrainIndex.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the terrain index, it is built once for each level and answers the questions the game asks about the
+// terrain (has the lander touched down, what is the platform worth, how far is the ground) with a lookup instead of reading
+// characters out of the level
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TERRAIN_INDEX_H
+#define TERRAIN_INDEX_H
+
+// Includes
+#include "LanderPhysics.h"
+#include "Level.h"
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+/// <summary>
+/// Where a moving lander first touched the terrain
+/// </summary>
+struct TerrainContact
+{
+	// Landed or crashed, or none if the whole move was clear
+	LANDING_RESULT result = LANDING_NONE;
+	// How far through the move it touched, 0 is the start and 1 is the end
+	float time = 1.0f;
+	// What the legs touched, solid if either of them hit something that isnt a platform
+	TERRAIN_TYPE surface = TERRAIN_EMPTY;
+	// Where the lander was when it touched, this is always inside the cell it touched down in
+	float xPos = 0.0f;
+	float yPos = 0.0f;
+};
+
+/// <summary>
+/// Moves a position on to the given cell if rounding has left it just outside, so that the cell it is in is the one that was hit
+/// </summary>
+inline float MoveInsideCell(float position, int cell)
+{
+	float lowest = (float)cell;
+	float highest = nextafterf((float)(cell + 1), lowest);
+	return position < lowest ? lowest : (position > highest ? highest : position);
+}
+
+/// <summary>
+/// Moves a lander's legs along a straight line a cell at a time and finds the first cell on the way where it would land or
+/// crash. This is the walk for both the level's terrain index and the planet's chunks, they only differ in how a cell is looked
+/// up and how far the lander can jump.
+/// </summary>
+/// <param name="fromX"> Where the lander started, this cell isnt checked as the lander was already there </param>
+/// <param name="fromY"> Where the lander started </param>
+/// <param name="toX"> Where the lander ended up after wrapping, a move across the edge is followed the short way round </param>
+/// <param name="toY"> Where the lander ended up </param>
+/// <param name="wrapWidth"> The lander wraps around when its x position gets to this, a sweep is never longer than it </param>
+/// <param name="checkLanding"> Called as checkLanding(cellX, cellY) with the x already wrapped, gives the LANDING_RESULT there </param>
+/// <param name="clearance"> Called as clearance(cellX, cellY) with the x already wrapped, gives how many cells the legs are
+/// from anything, the walk jumps that far minus one when it is 2 or more. Give 0 to always go a cell at a time. </param>
+/// <returns> The first contact without its surface filled in, the cell it is in is the one that was hit. If there wasnt one
+/// the result is LANDING_NONE and the position is the end of the move. </returns>
+template <typename CheckLandingFunction, typename ClearanceFunction>
+TerrainContact SweepCells(float fromX, float fromY, float toX, float toY, int wrapWidth, CheckLandingFunction checkLanding,
+	ClearanceFunction clearance)
+{
+	// A sweep is never more than one wrap off, so adding or taking the width once is enough
+	auto wrapCellX = [wrapWidth](int cellX)
+	{
+		return cellX < 0 ? cellX + wrapWidth : (cellX >= wrapWidth ? cellX - wrapWidth : cellX);
+	};
+
+	// A move that wrapped around the edge is really a short move the other way, so take the wrap back off to get the line it
+	// followed. The cells along it are wrapped again when they are looked up.
+	float moveX = toX - fromX;
+	int endCellX = (int)toX;
+	if (moveX > wrapWidth * 0.5f)
+	{
+		moveX -= wrapWidth;
+		endCellX -= wrapWidth;
+	}
+	else if (moveX < -wrapWidth * 0.5f)
+	{
+		moveX += wrapWidth;
+		endCellX += wrapWidth;
+	}
+	const float moveY = toY - fromY;
+	const int endCellY = (int)toY;
+	const int stepX = moveX > 0.0f ? 1 : -1;
+	const int stepY = moveY > 0.0f ? 1 : -1;
+	const float longest = fabsf(moveX) > fabsf(moveY) ? fabsf(moveX) : fabsf(moveY);
+
+	int cellX = (int)fromX;
+	int cellY = (int)fromY;
+	float time = 0.0f;
+	LANDING_RESULT result = LANDING_NONE;
+	while (cellX != endCellX || cellY != endCellY)
+	{
+		// Nothing is closer to the legs than this, so the lander can move that far minus one cell without touching anything.
+		// It never jumps past the edge, whatever gives the clearance doesnt know the lander wraps.
+		int wrappedX = wrapCellX(cellX);
+		int clear = clearance(wrappedX, cellY) - 1;
+		int toEdge = moveX > 0.0f ? wrapWidth - 1 - wrappedX : (moveX < 0.0f ? wrappedX : clear);
+		clear = clear < toEdge ? clear : toEdge;
+		if (clear >= 1)
+		{
+			// A tiny bit short of the full distance, so rounding cant carry the jump in to a cell it hasnt checked
+			time += ((float)clear - 0.001f) / longest;
+			if (time >= 1.0f)
+			{
+				break;
+			}
+			int jumpedX = (int)floorf(fromX + moveX * time);
+			int jumpedY = (int)floorf(fromY + moveY * time);
+			cellX = stepX > 0 ? (jumpedX < endCellX ? jumpedX : endCellX) : (jumpedX > endCellX ? jumpedX : endCellX);
+			cellY = stepY > 0 ? (jumpedY < endCellY ? jumpedY : endCellY) : (jumpedY > endCellY ? jumpedY : endCellY);
+			continue;
+		}
+
+		// Close to the terrain, so go in to whichever cell the line reaches next. Each axis stops at the end cell, so the last
+		// cell looked at is always the one the move ended in.
+		float nextX = cellX != endCellX ? ((float)(stepX > 0 ? cellX + 1 : cellX) - fromX) / moveX : INFINITY;
+		float nextY = cellY != endCellY ? ((float)(stepY > 0 ? cellY + 1 : cellY) - fromY) / moveY : INFINITY;
+		if (nextX <= nextY)
+		{
+			cellX += stepX;
+			time = nextX > time ? nextX : time;
+		}
+		else
+		{
+			cellY += stepY;
+			time = nextY > time ? nextY : time;
+		}
+		time = time < 1.0f ? time : 1.0f;
+
+		result = checkLanding(wrapCellX(cellX), cellY);
+		if (result != LANDING_NONE)
+		{
+			break;
+		}
+	}
+
+	TerrainContact contact;
+	if (result == LANDING_NONE)
+	{
+		// Nothing on the way, the cell the move ended in is checked the same as it always was (even if the lander didnt leave
+		// the cell it started in)
+		contact.xPos = toX;
+		contact.yPos = toY;
+		contact.result = checkLanding((int)toX, (int)toY);
+		return contact;
+	}
+
+	// Where the line was when it went in to the cell, wrapped back on to the screen
+	contact.result = result;
+	contact.time = time;
+	int wrappedX = wrapCellX(cellX);
+	contact.xPos = MoveInsideCell(fromX + moveX * time + (float)(wrappedX - cellX), wrappedX);
+	contact.yPos = MoveInsideCell(fromY + moveY * time, cellY);
+	return contact;
+}
+
+/// <summary>
+/// Everything about a level's terrain that the physics, scoring, altimeter and autopilots need, worked out ahead of time
+/// </summary>
+class TerrainIndex
+{
+public:
+	/// <summary>
+	/// Builds the index from a level's collision mask and platforms, this only needs to be done when the level changes
+	/// </summary>
+	void Build(const Level& level);
+
+	/// <summary>
+	/// The same as CheckLanding in LanderPhysics.h, but from the mask instead of the characters
+	/// </summary>
+	/// <param name="cellX"> The lander's x position in cells </param>
+	/// <param name="cellY"> The lander's y position in cells </param>
+	/// <param name="velocityY"> The lander's vertical velocity </param>
+	/// <returns> Landed if both feet are on a platform and it was going slowly enough, crashed if it hit anything else </returns>
+	LANDING_RESULT CheckLanding(int cellX, int cellY, float velocityY) const
+	{
+		int leg = LegCell(cellX, cellY);
+		uint8_t left = mask[leg];
+		uint8_t right = mask[leg + 1];
+		if (left == TERRAIN_PAD && right == TERRAIN_PAD && velocityY > -0.2f)
+		{
+			return LANDING_LANDED;
+		}
+		return (left | right) != TERRAIN_EMPTY ? LANDING_CRASHED : LANDING_NONE;
+	}
+
+	/// <summary>
+	/// Moves the lander's legs along a straight line and finds the first cell on the way where it would land or crash, so a lander
+	/// moving more than a cell in one step cant pass through anything thin. The distance field lets it jump over open space and
+	/// it only goes a cell at a time near the terrain.
+	/// </summary>
+	/// <param name="fromX"> Where the lander started, this cell isnt checked as the lander was already there </param>
+	/// <param name="fromY"> Where the lander started </param>
+	/// <param name="toX"> Where the lander ended up after wrapping, a move across the edge of the screen is followed the short way round </param>
+	/// <param name="toY"> Where the lander ended up </param>
+	/// <param name="velocityY"> The lander's vertical velocity, this decides between landing and crashing </param>
+	/// <returns> The first contact, if there wasnt one the result is LANDING_NONE and the position is the end of the move </returns>
+	TerrainContact SweepLander(float fromX, float fromY, float toX, float toY, float velocityY) const
+	{
+		// Most steps dont leave the cell they started in, then there is only the one cell to look at
+		if ((int)fromX == (int)toX && (int)fromY == (int)toY)
+		{
+			TerrainContact contact;
+			contact.xPos = toX;
+			contact.yPos = toY;
+			contact.result = CheckLanding((int)toX, (int)toY, velocityY);
+			if (contact.result != LANDING_NONE)
+			{
+				contact.surface = GetSurface((int)toX, (int)toY);
+			}
+			return contact;
+		}
+		return SweepAcrossCells(fromX, fromY, toX, toY, velocityY);
+	}
+
+	/// <summary>
+	/// Finds the platform that a lander at this position has its legs on
+	/// </summary>
+	/// <returns> The platform, or nullptr if the lander isnt on one </returns>
+	const LevelPlatform* FindPlatform(int cellX, int cellY) const
+	{
+		uint16_t platform = platformAt[LegCell(cellX, cellY)];
+		return platform ? &platforms[platform - 1] : nullptr;
+	}
+
+	/// <summary>
+	/// The score for landing at this position, the base score times the platform's multiplier
+	/// </summary>
+	/// <returns> The score, 0 if the lander isnt on a platform or the platform doesnt have a multiplier </returns>
+	int GetLandingScore(int cellX, int cellY) const
+	{
+		const LevelPlatform* platform = FindPlatform(cellX, cellY);
+		return platform ? BASE_SCORE * platform->multiplier : 0;
+	}
+
+	/// <summary>
+	/// How far the lander's legs are above whatever is under them, this is what the altimeter shows
+	/// </summary>
+	/// <returns> The number of empty cells between the legs and the ground, 0 if they are touching it. If there is nothing under
+	/// either leg the distance to the bottom of the level is given </returns>
+	int GetAltitude(int cellX, int cellY) const
+	{
+		int leg = LegCell(cellX, cellY);
+		int left = groundRow[leg];
+		int right = groundRow[leg + 1];
+		return (left < right ? left : right) - (cellY + (Player::HEIGHT - 1));
+	}
+
+	/// <summary>
+	/// The highest row in a column that isnt empty
+	/// </summary>
+	/// <returns> The row, or the height of the level if the column is empty all the way down </returns>
+	int GetSurfaceHeight(int column) const { return surfaceHeight[column]; }
+
+	/// <summary>
+	/// The first row at or below this cell that isnt empty
+	/// </summary>
+	/// <returns> The row, or the height of the level if there is nothing below </returns>
+	int GetGroundRow(int column, int row) const { return groundRow[column + width * row]; }
+
+	/// <summary>
+	/// How many cells it is from this cell to the nearest one that isnt empty, counting diagonal steps as one
+	/// </summary>
+	int GetDistance(int column, int row) const { return distanceField[column + width * row]; }
+
+	/// <summary>
+	/// The platforms sorted from left to right, and from top to bottom where they start in the same column
+	/// </summary>
+	const std::vector<LevelPlatform>& GetPlatforms() const { return platforms; }
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+
+private:
+	/// <summary>
+	/// The rest of SweepLander, for moves that go in to at least one other cell
+	/// </summary>
+	TerrainContact SweepAcrossCells(float fromX, float fromY, float toX, float toY, float velocityY) const;
+
+	/// <summary>
+	/// What the legs of a lander in this cell are touching, solid if either of them is on something that isnt a platform
+	/// </summary>
+	TERRAIN_TYPE GetSurface(int cellX, int cellY) const
+	{
+		int leg = LegCell(cellX, cellY);
+		return (mask[leg] == TERRAIN_SOLID || mask[leg + 1] == TERRAIN_SOLID) ? TERRAIN_SOLID : TERRAIN_PAD;
+	}
+
+	/// <summary>
+	/// The cell under the lander's left leg, the right leg is the next one along
+	/// </summary>
+	int LegCell(int cellX, int cellY) const
+	{
+		return (cellX + (Player::WIDTH - 3)) + width * (cellY + (Player::HEIGHT - 1));
+	}
+
+	int width = 0;
+	int height = 0;
+	// The TERRAIN_TYPE of every cell
+	std::vector<uint8_t> mask;
+	// For every cell, the first row at or below it that isnt empty
+	std::vector<uint16_t> groundRow;
+	// For every cell a left leg can be on, 1 + the index of the platform it lands on, or 0 if there isnt one
+	std::vector<uint16_t> platformAt;
+	// The highest row in each column that isnt empty
+	std::vector<int16_t> surfaceHeight;
+	// For every cell, how far it is to the nearest cell that isnt empty (0 if it isnt empty itself), capped at 255
+	std::vector<uint8_t> distanceField;
+	std::vector<LevelPlatform> platforms;
+};
+
+#endif // !TERRAIN_INDEX_H
@@ -8,7 +8,10 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
-#include <Windows.h>
+#include "CellKernels.h"
+#include "Platform.h"
+#include <stdint.h>
+#include <string.h>
 #include <string>
 #include "Constants.h"
 
@@ -44,37 +47,105 @@ static int ClampInt(int intToClamp, int lowerLimit, int upperLimit)
 /// <returns></returns>
 static float ClampFloat(float floatToClamp, float lowerLimit, float upperLimit)
 {
-	return floatToClamp <= lowerLimit ? lowerLimit : floatToClamp >= upperLimit ? upperLimit : floatToClamp;
+	// Both limits are worked out before picking so the compiler can do this with no branches
+	float belowUpper = floatToClamp >= upperLimit ? upperLimit : floatToClamp;
+	return floatToClamp <= lowerLimit ? lowerLimit : belowUpper;
 }
 
 /// <summary>
-/// This will display an image made up of ascii characters to the buffer for the program
+/// Picks one of two floats without a branch, for loops where the choice changes every time round and would mostly be guessed wrong.
+/// It works on the bits so the value that comes out is exactly the one that went in.
+/// </summary>
+/// <param name="condition"> Which one to pick </param>
+/// <param name="ifTrue"> The value if the condition is true </param>
+/// <param name="ifFalse"> The value if the condition is false </param>
+static float SelectFloat(bool condition, float ifTrue, float ifFalse)
+{
+	uint32_t trueBits;
+	uint32_t falseBits;
+	memcpy(&trueBits, &ifTrue, sizeof(float));
+	memcpy(&falseBits, &ifFalse, sizeof(float));
+	uint32_t mask = 0u - (uint32_t)condition;
+	uint32_t resultBits = (trueBits & mask) | (falseBits & ~mask);
+	float result;
+	memcpy(&result, &resultBits, sizeof(float));
+	return result;
+}
+
+/// <summary>
+/// The part of an image that is actually inside the buffer, the columns and rows are relative to the image
+/// </summary>
+struct ClipRect
+{
+	int firstColumn;
+	int lastColumn;
+	int firstRow;
+	int lastRow;
+};
+
+/// <summary>
+/// Works out which part of an image lands inside the buffer, this is done once per image so the drawing loops dont need any checks
+/// </summary>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+/// <param name="imageWidth"> Width of the image </param>
+/// <param name="imageHeight"> Height of the image </param>
+/// <param name="imageXPos"> Position on the x axis of the image </param>
+/// <param name="imageYPos"> Position on the y axis of the image </param>
+/// <param name="clip"> Gets filled in with the visible columns and rows, the last ones are one past the end </param>
+/// <returns> False if none of the image is inside the buffer </returns>
+static bool ClipToBuffer(int bufferWidth, int bufferHeight, int imageWidth, int imageHeight, int imageXPos, int imageYPos, ClipRect& clip)
+{
+	clip.firstColumn = imageXPos < 0 ? -imageXPos : 0;
+	clip.lastColumn = imageXPos + imageWidth > bufferWidth ? bufferWidth - imageXPos : imageWidth;
+	clip.firstRow = imageYPos < 0 ? -imageYPos : 0;
+	clip.lastRow = imageYPos + imageHeight > bufferHeight ? bufferHeight - imageYPos : imageHeight;
+
+	return clip.firstColumn < clip.lastColumn && clip.firstRow < clip.lastRow;
+}
+
+/// <summary>
+/// This will display an image made up of ascii characters to the buffer, anything that would land outside of the buffer is cut off
 /// </summary>
 /// <param name="consoleBuffer"> The buffer for the program </param>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
 /// <param name="charsToPrint"> This is the ascii 'sprite' that is to be displayed </param>
 /// <param name="coloursToPrint"> This is the colours for the ascii characters in the 'sprite' </param>
 /// <param name="ImageHeight"> Height of the 'sprite' </param>
 /// <param name="imageWidth"> Width of the 'sprite' </param>
 /// <param name="imageXPos"> Position on the x axis at which the 'sprite' will be displayed </param>
 /// <param name="imageYPos"> Position on the x axis at which the 'sprite' will be displayed </param>
-static void WriteImageToBuffer(CHAR_INFO* consoleBuffer, const char* charsToPrint, const int coloursToPrint[], const int ImageHeight, const int imageWidth, int imageXPos, int imageYPos)
+static void WriteImageToBuffer(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const char* charsToPrint, const uint8_t coloursToPrint[], const int ImageHeight, const int imageWidth, int imageXPos, int imageYPos)
 {
-	for (int y = 0; y < ImageHeight; y++)
+	ClipRect clip;
+	if (!ClipToBuffer(bufferWidth, bufferHeight, imageWidth, ImageHeight, imageXPos, imageYPos, clip))
 	{
-		for (int x = 0; x < imageWidth; x++)
-		{
-			// Prints the characters of the 'sprite'
-			consoleBuffer[(imageXPos + x) + SCREEN_WIDTH * (imageYPos + y)].Char.AsciiChar = charsToPrint[x + imageWidth * y];
+		return;
+	}
+
+	for (int y = clip.firstRow; y < clip.lastRow; y++)
+	{
+		Cell* row = consoleBuffer + imageXPos + bufferWidth * (imageYPos + y);
+		const char* imageRow = charsToPrint + imageWidth * y;
 
-			if (coloursToPrint)
+		if (coloursToPrint)
+		{
+			// Prints the characters of the 'sprite' and sets their colours
+			const uint8_t* colourRow = coloursToPrint + imageWidth * y;
+			for (int x = clip.firstColumn; x < clip.lastColumn; x++)
 			{
-				// Sets the colours of the characters
-				consoleBuffer[(imageXPos + x) + SCREEN_WIDTH * (imageYPos + y)].Attributes = coloursToPrint[x + imageWidth * y];
+				row[x].glyph = imageRow[x];
+				row[x].attributes = colourRow[x];
 			}
-			else
+		}
+		else
+		{
+			// Defaults to colour of white if no colour was specified as a parameter
+			for (int x = clip.firstColumn; x < clip.lastColumn; x++)
 			{
-				// Defaults to colour of white if no colour was specified as a parameter
-				consoleBuffer[(imageXPos + x) + SCREEN_WIDTH * (imageYPos + y)].Attributes = 7;
+				row[x].glyph = imageRow[x];
+				row[x].attributes = 7;
 			}
 		}
 	}
@@ -84,32 +155,48 @@ static void WriteImageToBuffer(CHAR_INFO* consoleBuffer, const char* charsToPrin
 /// This function will remove any characters displayed on the screen so that previous frames are not getting shown as 'echoes'
 /// </summary>
 /// <param name="consoleBuffer"> Takes the buffer for the screen as a parameter </param>
-static void ClearScreen(CHAR_INFO* consoleBuffer)
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+static void ClearScreen(Cell* consoleBuffer, int bufferWidth, int bufferHeight)
 {
-	for (int i = 0; i < (SCREEN_WIDTH * SCREEN_HEIGHT); i++)
-	{
-		// Sets all the characters as being nothing
-		consoleBuffer[i].Char.AsciiChar = 0;
-		consoleBuffer[i].Attributes = 0;
-	}
+	// Sets all the characters as being nothing
+	FillCells(consoleBuffer, bufferWidth * bufferHeight, Cell{ 0, 0 });
 }
 
 /// <summary>
-/// This will print a string of text to a specified location within the buffer on the screen
+/// This will print text to a specified location within the buffer, any text that would go off the edge is cut off
+/// rather than running on to the next line. The text doesnt need to be null terminated so no string has to be built for it.
 /// </summary>
 /// <param name="consoleBuffer"> The buffer for the running program </param>
-/// <param name="stringToPrint"> The contents of what is to be displayed </param>
+/// <param name="bufferWidth"> Width of the buffer </param>
+/// <param name="bufferHeight"> Height of the buffer </param>
+/// <param name="textToPrint"> The characters that are to be displayed </param>
+/// <param name="textLength"> How many characters to display </param>
 /// <param name="textXPos"> Position on the x axis that the text will display </param>
 /// <param name="textYPos"> Position on the y axis that the text will display </param>
-static void WriteTextToBuffer(CHAR_INFO* consoleBuffer, std::string stringToPrint, int textXPos, int textYPos)
+static void WriteTextToBuffer(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const char* textToPrint, int textLength, int textXPos, int textYPos)
 {
-	for (int x = 0; x < stringToPrint.length(); x++)
+	ClipRect clip;
+	if (!ClipToBuffer(bufferWidth, bufferHeight, textLength, 1, textXPos, textYPos, clip))
 	{
-		consoleBuffer[(textXPos + x) + SCREEN_WIDTH * textYPos].Char.AsciiChar = stringToPrint[x]; // Prints the string
-		consoleBuffer[(textXPos + x) + SCREEN_WIDTH * textYPos].Attributes = 0xF; // Sets the colour as white
+		return;
+	}
+
+	Cell* row = consoleBuffer + textXPos + bufferWidth * textYPos;
+	for (int x = clip.firstColumn; x < clip.lastColumn; x++)
+	{
+		row[x].glyph = textToPrint[x]; // Prints the string
+		row[x].attributes = 0xF; // Sets the colour as white
 	}
 }
 
+/// <summary>
+/// This will print a string of text to a specified location within the buffer, any text that would go off the edge is cut off
+/// </summary>
+static void WriteTextToBuffer(Cell* consoleBuffer, int bufferWidth, int bufferHeight, const std::string& stringToPrint, int textXPos, int textYPos)
+{
+	WriteTextToBuffer(consoleBuffer, bufferWidth, bufferHeight, stringToPrint.data(), (int)stringToPrint.length(), textXPos, textYPos);
+}
 
 #endif // !UTILITY_H
 
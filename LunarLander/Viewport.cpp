@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Viewport.cpp
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the functions for the viewport, which fits the level and menus on to a screen of any size
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This classes header
+#include "Viewport.h"
+// Includes
+#include "Utility.h"
+#include <algorithm>
+#include <string.h>
+
+void Viewport::Resize(int newScreenWidth, int newScreenHeight, int newContentWidth, int newContentHeight, bool allowScaling)
+{
+	screenWidth = newScreenWidth;
+	screenHeight = newScreenHeight;
+	contentWidth = newContentWidth;
+	contentHeight = newContentHeight;
+
+	// Only whole numbers, so every cell of the content turns in to the same sized block and the ascii art keeps its shape
+	scale = 1;
+	if (allowScaling)
+	{
+		int scaleX = screenWidth / contentWidth;
+		int scaleY = screenHeight / contentHeight;
+		scale = scaleX < scaleY ? scaleX : scaleY;
+		scale = scale > 1 ? scale : 1;
+	}
+
+	// Until something is followed the middle of the content is shown
+	cameraX = (contentWidth - screenWidth) / 2;
+	cameraY = (contentHeight - screenHeight) / 2;
+	UpdateOffsets();
+}
+
+bool Viewport::Follow(int x, int y, int width, int height)
+{
+	int newCameraX = cameraX;
+	int newCameraY = cameraY;
+
+	// The same margins as the camera over a planet, so it only moves once the rectangle is getting near the edge
+	if (contentWidth * scale > screenWidth)
+	{
+		const int marginX = screenWidth / 3;
+		if (x - cameraX < marginX)
+		{
+			newCameraX = x - marginX;
+		}
+		else if (x - cameraX > screenWidth - width - marginX)
+		{
+			newCameraX = x - (screenWidth - width - marginX);
+		}
+	}
+	if (contentHeight * scale > screenHeight)
+	{
+		const int marginY = screenHeight / 3;
+		if (y - cameraY < marginY)
+		{
+			newCameraY = y - marginY;
+		}
+		else if (y - cameraY > screenHeight - height - marginY)
+		{
+			newCameraY = y - (screenHeight - height - marginY);
+		}
+	}
+
+	if (newCameraX == cameraX && newCameraY == cameraY)
+	{
+		return false;
+	}
+	cameraX = newCameraX;
+	cameraY = newCameraY;
+	int oldOffsetX = offsetX;
+	int oldOffsetY = offsetY;
+	UpdateOffsets();
+	// The camera can want to go past the edge of the content, in which case it is held there and nothing has really moved
+	return offsetX != oldOffsetX || offsetY != oldOffsetY;
+}
+
+void Viewport::MapLayer(const Layer& content, Layer& screenLayer) const
+{
+	if (screenLayer.width != screenWidth || screenLayer.height != screenHeight)
+	{
+		screenLayer.Build(nullptr, nullptr, screenHeight, screenWidth);
+	}
+
+	Cell blank = { 0, 0 };
+
+	// The columns of the screen the content covers, the same for every row
+	int firstColumn = ClampInt(-offsetX, 0, screenWidth);
+	int lastColumn = ClampInt(content.width * scale - offsetX, 0, screenWidth);
+
+	for (int y = 0; y < screenHeight; y++)
+	{
+		Cell* row = screenLayer.cells.data() + screenWidth * y;
+		int screenY = y + offsetY;
+		if (screenY < 0 || screenY / scale >= content.height || firstColumn >= lastColumn)
+		{
+			FillCells(row, screenWidth, blank);
+			continue;
+		}
+
+		// When scaled up the rows come in groups that are all the same, so only the first of each group is worked out
+		if (y > 0 && screenY % scale != 0)
+		{
+			memcpy(row, row - screenWidth, screenWidth * sizeof(Cell));
+			continue;
+		}
+
+		// The borders either side are narrow, usually nothing at all, so they arent worth a call in to the kernels
+		std::fill(row, row + firstColumn, blank);
+		std::fill(row + lastColumn, row + screenWidth, blank);
+		const Cell* contentRow = content.cells.data() + content.width * (screenY / scale);
+		if (scale == 1)
+		{
+			// Not scaled, so the row is just copied
+			memcpy(row + firstColumn, contentRow + firstColumn + offsetX, (lastColumn - firstColumn) * sizeof(Cell));
+			continue;
+		}
+
+		// Each cell of the content is repeated scale times, counting along rather than dividing for every cell
+		int contentX = (firstColumn + offsetX) / scale;
+		int repeat = (firstColumn + offsetX) % scale;
+		for (int x = firstColumn; x < lastColumn; x++)
+		{
+			row[x] = contentRow[contentX];
+			if (++repeat == scale)
+			{
+				repeat = 0;
+				contentX++;
+			}
+		}
+	}
+}
+
+void Viewport::UpdateOffsets()
+{
+	// Along an axis where the scaled content fits it is centred and the camera isnt used, otherwise the camera is kept inside it
+	int scaledWidth = contentWidth * scale;
+	int scaledHeight = contentHeight * scale;
+	if (scaledWidth <= screenWidth)
+	{
+		offsetX = -(screenWidth - scaledWidth) / 2;
+	}
+	else
+	{
+		cameraX = ClampInt(cameraX, 0, contentWidth - screenWidth);
+		offsetX = cameraX;
+	}
+
+	if (scaledHeight <= screenHeight)
+	{
+		offsetY = -(screenHeight - scaledHeight) / 2;
+	}
+	else
+	{
+		cameraY = ClampInt(cameraY, 0, contentHeight - screenHeight);
+		offsetY = cameraY;
+	}
+}
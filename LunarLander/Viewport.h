@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File: Viewport.h
+// Author: Joshua L Riches
+// Date Created: October 18th
+// Brief: this contains the viewport, it works out where something drawn on the level's grid (the level itself, the menus) goes
+// on a screen that can be any size. A bigger screen shows it scaled up by a whole number and centred, a smaller one shows the
+// part of it around a camera.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+// Includes
+#include "Compositor.h"
+
+/// <summary>
+/// Maps cells of some content, such as the level, on to the screen. Everything is worked out in Resize so that drawing only
+/// needs a multiply and a subtract per position.
+/// </summary>
+class Viewport
+{
+public:
+	/// <summary>
+	/// Works out how the content fits on a screen of the given size, this only needs calling when the screen changes size
+	/// </summary>
+	/// <param name="screenWidth"> Width of the screen in characters </param>
+	/// <param name="screenHeight"> Height of the screen in characters </param>
+	/// <param name="contentWidth"> Width of the content being shown </param>
+	/// <param name="contentHeight"> Height of the content being shown </param>
+	/// <param name="allowScaling"> If false the content is always shown at its own size, this is used for the menus as scaled up text is hard to read </param>
+	void Resize(int screenWidth, int screenHeight, int contentWidth, int contentHeight, bool allowScaling);
+
+	/// <summary>
+	/// Moves the camera so that a rectangle of the content stays at least a third of the screen in from the edges. This only does
+	/// anything along an axis where the content doesnt fit on the screen.
+	/// </summary>
+	/// <returns> True if the camera moved, anything mapped with MapLayer needs mapping again when it does </returns>
+	bool Follow(int x, int y, int width, int height);
+
+	/// <summary>
+	/// Fills a screen sized layer with a content sized one, scaled and moved the same way as everything else. The parts of the
+	/// screen the content doesnt cover are left blank.
+	/// </summary>
+	/// <param name="content"> The layer to show, it should be the content size given to Resize </param>
+	/// <param name="screenLayer"> The layer the screen is drawn from, it is resized to the screen if it isnt already </param>
+	void MapLayer(const Layer& content, Layer& screenLayer) const;
+
+	/// <summary>
+	/// Where a cell of the content is on the screen, this is the top left of the block of cells it covers when scaled up
+	/// </summary>
+	int ToScreenX(int contentX) const { return contentX * scale - offsetX; }
+	int ToScreenY(int contentY) const { return contentY * scale - offsetY; }
+
+	/// <summary>
+	/// Where to draw a sprite that stands on the content, sprites arent scaled so it goes in the middle of the cells it covers
+	/// along x and rests on the bottom of them along y, so the lander's legs still touch the scaled up ground
+	/// </summary>
+	int SpriteToScreenX(int contentX, int spriteWidth) const { return ToScreenX(contentX) + (spriteWidth * scale - spriteWidth) / 2; }
+	int SpriteToScreenY(int contentY, int spriteHeight) const { return ToScreenY(contentY) + spriteHeight * scale - spriteHeight; }
+
+	/// <summary>
+	/// How many screen cells wide and high each cell of the content is
+	/// </summary>
+	int GetScale() const { return scale; }
+
+	/// <summary>
+	/// The screen position of the content's top left after scaling, negated. This is what ParticleSystem::Draw takes as its offset.
+	/// </summary>
+	int GetOffsetX() const { return offsetX; }
+	int GetOffsetY() const { return offsetY; }
+
+private:
+	/// <summary>
+	/// Works out the offsets from the camera, or centres the content along an axis where it fits
+	/// </summary>
+	void UpdateOffsets();
+
+	int screenWidth = 0;
+	int screenHeight = 0;
+	int contentWidth = 0;
+	int contentHeight = 0;
+	int scale = 1;
+	// The top left of the part of the content that is on screen, only used along an axis where the content doesnt fit
+	int cameraX = 0;
+	int cameraY = 0;
+	int offsetX = 0;
+	int offsetY = 0;
+};
+
+#endif // !VIEWPORT_H